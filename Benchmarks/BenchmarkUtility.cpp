@@ -0,0 +1,217 @@
+#include "BenchmarkUtility.h"
+
+#ifdef __LINUX__
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
+
+namespace benchmarks
+{
+	int CountingNetwork::sendBytesImplementation(const char* data, int size, int flags)
+	{
+		sendCalls++;
+
+		return Network::sendBytesImplementation(data, size, flags);
+	}
+
+	int CountingNetwork::receiveBytesImplementation(char* data, int size, int flags)
+	{
+		receiveCalls++;
+
+		return Network::receiveBytesImplementation(data, size, flags);
+	}
+
+	int CountingNetwork::receiveBuffersImplementation(std::span<const std::span<char>> buffers, int flags)
+	{
+		receiveCalls++;
+
+		return Network::receiveBuffersImplementation(buffers, flags);
+	}
+
+	CountingNetwork::CountingNetwork(SOCKET clientSocket) :
+		Network(clientSocket),
+		sendCalls(0),
+		receiveCalls(0)
+	{
+
+	}
+
+	size_t CountingNetwork::getSystemCalls() const noexcept
+	{
+		return sendCalls + receiveCalls;
+	}
+
+	void CountingNetwork::resetSystemCalls() noexcept
+	{
+		sendCalls = 0;
+		receiveCalls = 0;
+	}
+
+	Peer::Peer(SOCKET peerSocket, const std::function<void(streams::IOSocketStream&)>& callback, const std::function<streams::IOSocketStream(SOCKET)>& createStream) :
+		thread
+		(
+			[peerSocket, callback, createStream]()
+			{
+				streams::IOSocketStream stream = createStream ? createStream(peerSocket) : streams::IOSocketStream::createStream<CountingNetwork>(peerSocket);
+
+				try
+				{
+					callback(stream);
+				}
+				catch (const web::exceptions::WebException&)
+				{
+
+				}
+			}
+		)
+	{
+
+	}
+
+	Peer::~Peer()
+	{
+		thread.join();
+	}
+
+	std::pair<SOCKET, SOCKET> createConnection(Transport transport)
+	{
+#ifdef __LINUX__
+		if (transport == Transport::socketPair)
+		{
+			int sockets[2] = {};
+
+			if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets))
+			{
+				THROW_WEB_EXCEPTION;
+			}
+
+			return { sockets[0], sockets[1] };
+		}
+#else
+		static WSADATA wsaData;
+		static int startup = WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+		sockaddr_in address = {};
+		socklen_t addressLength = sizeof(address);
+		SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		SOCKET client = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		int noDelay = 1;
+
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+			listen(listener, 1) == SOCKET_ERROR ||
+			getsockname(listener, reinterpret_cast<sockaddr*>(&address), &addressLength) == SOCKET_ERROR ||
+			connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+
+		SOCKET peer = accept(listener, nullptr, nullptr);
+
+		closesocket(listener);
+
+		// Frame header and body are separate sends, without TCP_NODELAY echo stalls on delayed ACK
+		setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+		setsockopt(peer, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+		return { client, peer };
+	}
+
+	void echoFrames(streams::IOSocketStream& stream)
+	{
+		std::string data;
+
+		while (true)
+		{
+			stream >> data;
+
+			if (stream.eof())
+			{
+				break;
+			}
+
+			stream << data;
+		}
+	}
+
+	void echoBytes(streams::IOSocketStream& stream, int chunkSize)
+	{
+		web::Network& network = stream.getNetwork();
+		std::string data(chunkSize, '\0');
+		bool endOfStream = false;
+
+		while (true)
+		{
+			network.receiveBytes(data.data(), chunkSize, endOfStream);
+
+			if (endOfStream)
+			{
+				break;
+			}
+
+			network.sendBytes(data.data(), chunkSize, endOfStream);
+		}
+	}
+
+	void sendFramesOnRequest(streams::IOSocketStream& stream, int64_t size)
+	{
+		web::Network& network = stream.getNetwork();
+		std::vector<char> data(static_cast<size_t>(size), 'a');
+		bool endOfStream = false;
+		char request = 0;
+
+		while (true)
+		{
+			network.receiveRawData(&request, sizeof(request), endOfStream);
+
+			if (endOfStream)
+			{
+				break;
+			}
+
+			network.sendLargeData(data.data(), size, endOfStream);
+		}
+	}
+
+	const char* getTransportName(Transport transport)
+	{
+		switch (transport)
+		{
+		case Transport::socketPair:
+			return "socketpair";
+
+		case Transport::loopback:
+			return "loopback";
+		}
+
+		return "";
+	}
+
+	void setSystemCallsCounter(benchmark::State& state, const CountingNetwork& network)
+	{
+		state.counters["syscalls/op"] = benchmark::Counter(static_cast<double>(network.getSystemCalls()), benchmark::Counter::kAvgIterations);
+	}
+
+	void registerForTransports(const std::string& name, const std::function<void(benchmark::State&, Transport)>& function, const std::function<void(benchmark::internal::Benchmark*)>& configure)
+	{
+#ifdef __LINUX__
+		constexpr Transport transports[] = { Transport::socketPair, Transport::loopback };
+#else
+		constexpr Transport transports[] = { Transport::loopback };
+#endif
+
+		for (Transport transport : transports)
+		{
+			std::string fullName = name + '/' + getTransportName(transport);
+			benchmark::internal::Benchmark* benchmark = benchmark::RegisterBenchmark(fullName.data(), function, transport);
+
+			if (configure)
+			{
+				configure(benchmark);
+			}
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <thread>
+#include <functional>
+#include <utility>
+
+#include <benchmark/benchmark.h>
+
+#include "IOSocketStream.h"
+
+namespace benchmarks
+{
+	enum class Transport
+	{
+		socketPair,
+		loopback
+	};
+
+	/// @brief Network that counts send/recv system calls
+	class CountingNetwork : public web::Network
+	{
+	private:
+		size_t sendCalls;
+		size_t receiveCalls;
+
+	protected:
+		int sendBytesImplementation(const char* data, int size, int flags = 0) override;
+
+		int receiveBytesImplementation(char* data, int size, int flags = 0) override;
+
+		int receiveBuffersImplementation(std::span<const std::span<char>> buffers, int flags = 0) override;
+
+	public:
+		CountingNetwork(SOCKET clientSocket);
+
+		size_t getSystemCalls() const noexcept;
+
+		void resetSystemCalls() noexcept;
+
+		~CountingNetwork() = default;
+	};
+
+	/// @brief Runs callback with peer side of connection in separate thread until it returns
+	class Peer
+	{
+	private:
+		std::thread thread;
+
+	public:
+		/// @param createStream Create peer stream from socket. By default stream uses CountingNetwork
+		Peer(SOCKET peerSocket, const std::function<void(streams::IOSocketStream&)>& callback, const std::function<streams::IOSocketStream(SOCKET)>& createStream = nullptr);
+
+		~Peer();
+	};
+
+	/// @brief Create connected pair of stream sockets
+	/// @return Client and peer sockets
+	std::pair<SOCKET, SOCKET> createConnection(Transport transport);
+
+	/// @brief Echo frames(sendData/receiveData) until connection closed
+	void echoFrames(streams::IOSocketStream& stream);
+
+	/// @brief Echo fixed size chunks(sendBytes/receiveBytes) until connection closed
+	void echoBytes(streams::IOSocketStream& stream, int chunkSize);
+
+	/// @brief Answer every 1 byte request frame with frame of size bytes until connection closed
+	void sendFramesOnRequest(streams::IOSocketStream& stream, int64_t size);
+
+	const char* getTransportName(Transport transport);
+
+	/// @brief Report system calls per iteration
+	void setSystemCallsCounter(benchmark::State& state, const CountingNetwork& network);
+
+	/// @brief Register benchmark for every available transport
+	void registerForTransports(const std::string& name, const std::function<void(benchmark::State&, Transport)>& function, const std::function<void(benchmark::internal::Benchmark*)>& configure = nullptr);
+}
@@ -0,0 +1,78 @@
+#include "BenchmarkUtility.h"
+
+#include "Crc32c.h"
+
+namespace benchmarks
+{
+	/// @brief Checksum of buffer with implementation selected for CPU and with portable one
+	static void crc32c(benchmark::State& state, bool software)
+	{
+		std::vector<char> data(static_cast<size_t>(state.range(0)), 'a');
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(software ? web::utility::crc32cSoftware(data.data(), data.size()) : web::utility::crc32c(data.data(), data.size()));
+		}
+
+		state.SetBytesProcessed(state.iterations() * data.size());
+		state.SetLabel(software ? "software" : std::string(web::utility::getCrc32cImplementation()));
+	}
+
+	static streams::IOSocketStream createChecksumStream(SOCKET socket)
+	{
+		streams::IOSocketStream result = streams::IOSocketStream::createStream<CountingNetwork>(socket);
+
+		result.getNetwork().enableFrameChecksum();
+
+		return result;
+	}
+
+	/// @brief Frame round trip with and without frame checksum
+	static void checksumRoundTrip(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		bool checksum = state.range(1);
+		Peer echo
+		(
+			peer,
+			echoFrames,
+			checksum ? createChecksumStream : std::function<streams::IOSocketStream(SOCKET)>()
+		);
+		streams::IOSocketStream stream = checksum ?
+			createChecksumStream(client) :
+			streams::IOSocketStream::createStream<CountingNetwork>(client);
+		std::string data(static_cast<size_t>(state.range(0)), 'a');
+		std::string result;
+
+		for (auto _ : state)
+		{
+			stream << data;
+			stream >> result;
+
+			benchmark::DoNotOptimize(result.data());
+		}
+
+		state.SetBytesProcessed(state.iterations() * data.size() * 2);
+	}
+
+	static const bool registered = []()
+		{
+			for (bool software : { false, true })
+			{
+				benchmark::RegisterBenchmark(software ? "Checksum/Crc32c/Software" : "Checksum/Crc32c/Dispatched", crc32c, software)->
+					ArgName("size")->RangeMultiplier(16)->Range(64, 4 << 20);
+			}
+
+			registerForTransports
+			(
+				"Checksum/RoundTrip",
+				checksumRoundTrip,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgNames({ "size", "checksum" })->ArgsProduct({ { 64, 4 << 10, 64 << 10, 1 << 20 }, { 0, 1 } });
+				}
+			);
+
+			return true;
+		}();
+}
@@ -0,0 +1,86 @@
+#ifdef SOCKET_STREAMS_COMPRESSION
+
+#include "BenchmarkUtility.h"
+
+#include <format>
+
+#include "CompressedNetwork.h"
+
+namespace benchmarks
+{
+	/// @brief JSON array of similar objects, typical compressible payload
+	static std::string createJson(size_t size)
+	{
+		std::string result = "[";
+
+		for (size_t i = 0; result.size() < size; i++)
+		{
+			result += std::format(R"({{"id":{},"name":"user {}","email":"user{}@example.com","active":{},"score":{:.2f},"tags":["alpha","beta"]}},)", i, i, i, i % 2 ? "true" : "false", i * 3.14);
+		}
+
+		result.resize(size - 1);
+
+		return result += ']';
+	}
+
+	static streams::IOSocketStream createCompressedStream(SOCKET socket, int level)
+	{
+		return streams::IOSocketStream::createStream<web::CompressedNetwork>(std::make_unique<CountingNetwork>(socket), 1024, level);
+	}
+
+	/// @brief Frame round trip of JSON payload. Level 0 means plain Network, ratio is compressed size / original size
+	static void compressedRoundTrip(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		int level = static_cast<int>(state.range(1));
+		Peer echo
+		(
+			peer,
+			echoFrames,
+			level ? [level](SOCKET socket) { return createCompressedStream(socket, level); } : std::function<streams::IOSocketStream(SOCKET)>()
+		);
+		streams::IOSocketStream stream = level ?
+			createCompressedStream(client, level) :
+			streams::IOSocketStream::createStream<CountingNetwork>(client);
+		std::string data = createJson(static_cast<size_t>(state.range(0)));
+		std::string result;
+
+		for (auto _ : state)
+		{
+			stream << data;
+			stream >> result;
+
+			benchmark::DoNotOptimize(result.data());
+		}
+
+		state.SetBytesProcessed(state.iterations() * data.size() * 2);
+
+		if (level)
+		{
+			const web::CompressedNetwork::CompressionStatistics& statistics = stream.getNetwork<web::CompressedNetwork>().getCompressionStatistics();
+
+			state.counters["ratio"] = statistics.inputBytes ? static_cast<double>(statistics.outputBytes) / statistics.inputBytes : 1.0;
+		}
+		else
+		{
+			state.counters["ratio"] = 1.0;
+		}
+	}
+
+	static const bool registered = []()
+		{
+			registerForTransports
+			(
+				"Compression/RoundTrip",
+				compressedRoundTrip,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgNames({ "size", "level" })->ArgsProduct({ { 1 << 10, 16 << 10, 256 << 10, 1 << 20 }, { 0, 1, 6, 9 } });
+				}
+			);
+
+			return true;
+		}();
+}
+
+#endif // SOCKET_STREAMS_COMPRESSION
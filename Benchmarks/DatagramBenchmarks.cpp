@@ -0,0 +1,112 @@
+#include "BenchmarkUtility.h"
+
+#include "DatagramNetwork.h"
+
+#ifdef __LINUX__
+#include <arpa/inet.h>
+#endif
+
+namespace benchmarks
+{
+	static constexpr size_t datagramsInBatch = 64;
+
+	/// @brief Connected sender and bound receiver on loopback
+	static std::pair<web::DatagramNetwork, web::DatagramNetwork> createDatagramPair()
+	{
+#ifndef __LINUX__
+		static WSADATA wsaData;
+		static int startup = WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+		sockaddr_in address = {};
+		socklen_t addressLength = sizeof(address);
+		SOCKET receiver = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		SOCKET sender = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		int bufferSize = 4 * 1024 * 1024;
+
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		setsockopt(receiver, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+
+		if (bind(receiver, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+			getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &addressLength) == SOCKET_ERROR ||
+			connect(sender, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+
+		return { web::DatagramNetwork(sender), web::DatagramNetwork(receiver) };
+	}
+
+	static void perDatagram(benchmark::State& state)
+	{
+		auto [sender, receiver] = createDatagramPair();
+		std::string datagram(static_cast<size_t>(state.range(0)), 'a');
+		std::string result;
+		bool endOfStream = false;
+
+		for (auto _ : state)
+		{
+			for (size_t i = 0; i < datagramsInBatch; i++)
+			{
+				sender.sendRawData(datagram.data(), static_cast<int>(datagram.size()), endOfStream);
+			}
+
+			for (size_t i = 0; i < datagramsInBatch; i++)
+			{
+				web::utility::ContainerWrapper container(result);
+
+				receiver.receiveData(container, endOfStream);
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * datagramsInBatch);
+	}
+
+	static void batch(benchmark::State& state, bool offload)
+	{
+		auto [sender, receiver] = createDatagramPair();
+		std::string datagram(static_cast<size_t>(state.range(0)), 'a');
+		std::vector<std::string_view> datagrams(datagramsInBatch, datagram);
+		std::vector<std::string> result;
+
+		if (offload)
+		{
+			try
+			{
+				sender.setSegmentationOffload(static_cast<uint16_t>(datagram.size()));
+				receiver.setReceiveOffload(true);
+			}
+			catch (const web::exceptions::WebException& e)
+			{
+				state.SkipWithError(e.what());
+
+				return;
+			}
+		}
+
+		for (auto _ : state)
+		{
+			sender.sendDatagrams(datagrams);
+
+			for (size_t received = 0; received < datagramsInBatch;)
+			{
+				received += receiver.receiveDatagrams(result, datagramsInBatch - received);
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * datagramsInBatch);
+	}
+
+	static const bool registered = []()
+		{
+			benchmark::RegisterBenchmark("DatagramNetwork/PerDatagram", perDatagram)->Arg(64)->Arg(1024);
+			benchmark::RegisterBenchmark("DatagramNetwork/Batch", batch, false)->Arg(64)->Arg(1024);
+#ifdef __LINUX__
+			benchmark::RegisterBenchmark("DatagramNetwork/BatchOffload", batch, true)->Arg(64)->Arg(1024);
+#endif
+
+			return true;
+		}();
+}
@@ -0,0 +1,481 @@
+#include "BenchmarkUtility.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "FixedFrameChannel.h"
+
+namespace benchmarks
+{
+	static void isDataAvailable(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		web::Network peerNetwork(peer);
+		web::Network network(client);
+		bool checkConnection = state.range(0);
+		bool endOfStream = false;
+		char data = 'a';
+
+		peerNetwork.sendBytes(&data, sizeof(data), endOfStream);
+
+		for (auto _ : state)
+		{
+			int availableBytes = 0;
+			bool hasConnection = false;
+
+			benchmark::DoNotOptimize(network.isDataAvailable(&availableBytes, checkConnection ? &hasConnection : nullptr));
+		}
+	}
+
+	/// @brief Send and receive same small chunk in one thread without observer, with per Network and with global ring buffer observer
+	static void observer(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		web::Network peerNetwork(peer);
+		web::Network network(client);
+		std::shared_ptr<web::utility::RingBufferNetworkObserver> ringBuffer = std::make_shared<web::utility::RingBufferNetworkObserver>();
+		char data[64] = {};
+		bool endOfStream = false;
+
+		switch (state.range(0))
+		{
+		case 1:
+			network.setObserver(ringBuffer);
+			peerNetwork.setObserver(ringBuffer);
+
+			break;
+
+		case 2:
+			web::utility::NetworkObserver::setGlobal(ringBuffer);
+
+			break;
+		}
+
+		for (auto _ : state)
+		{
+			network.sendBytes(data, sizeof(data), endOfStream);
+			peerNetwork.receiveBytes(data, sizeof(data), endOfStream);
+		}
+
+		web::utility::NetworkObserver::setGlobal(nullptr);
+
+		state.SetBytesProcessed(state.iterations() * sizeof(data));
+	}
+
+	/// @brief Send and receive small frame in one thread with fixed and varint size header. Reports bytes on wire per frame
+	static void frameHeader(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		CountingNetwork peerNetwork(peer);
+		CountingNetwork network(client);
+		web::FrameHeader header = static_cast<web::FrameHeader>(state.range(1));
+		std::vector<char> data(static_cast<size_t>(state.range(0)), 'a');
+		bool endOfStream = false;
+
+		network.setFrameHeader(header);
+		peerNetwork.setFrameHeader(header);
+
+		network.resetSystemCalls();
+		peerNetwork.resetSystemCalls();
+
+		for (auto _ : state)
+		{
+			network.sendRawData(data.data(), static_cast<int>(data.size()), endOfStream);
+			peerNetwork.receiveRawData(data.data(), static_cast<int>(data.size()), endOfStream);
+		}
+
+		char encoded[web::utility::maxVarint64Size];
+		size_t headerSize = header == web::FrameHeader::varint ? web::utility::encodeVarint(data.size(), encoded) : sizeof(int);
+
+		state.SetBytesProcessed(state.iterations() * data.size());
+		state.counters["wireBytes"] = static_cast<double>(data.size() + headerSize);
+
+		setSystemCallsCounter(state, peerNetwork);
+	}
+
+	/// @brief Peer answers every request with large frame. Frame is received into one container or in chunks, bufferBytes is receive memory per frame
+	static void chunkedReceive(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		int64_t size = state.range(0);
+		bool chunked = state.range(1);
+		Peer sender(peer, [size](streams::IOSocketStream& stream) { sendFramesOnRequest(stream, size); });
+		CountingNetwork network(client);
+		std::string data;
+		char request = 0;
+		bool endOfStream = false;
+
+		for (auto _ : state)
+		{
+			network.sendRawData(&request, sizeof(request), endOfStream);
+
+			if (chunked)
+			{
+				network.receiveChunkedData([](std::string_view chunk) { benchmark::DoNotOptimize(chunk.data()); }, endOfStream);
+			}
+			else
+			{
+				web::utility::ContainerWrapper wrapper(data);
+
+				network.receiveData(wrapper, endOfStream);
+			}
+		}
+
+		state.SetBytesProcessed(state.iterations() * size);
+		state.counters["bufferBytes"] = static_cast<double>(chunked ? (std::min)(size, web::Network::defaultChunkSize) : size);
+	}
+
+	/// @brief Receive every frame into new container like parse and discard consumer does, so growth of container is measured too
+	template<typename T>
+	void receiveNewContainer(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		int64_t size = state.range(0);
+		Peer sender(peer, [size](streams::IOSocketStream& stream) { sendFramesOnRequest(stream, size); });
+		CountingNetwork network(client);
+		char request = 0;
+		bool endOfStream = false;
+
+		for (auto _ : state)
+		{
+			T data;
+			web::utility::ContainerWrapper wrapper(data);
+
+			network.sendRawData(&request, sizeof(request), endOfStream);
+			network.receiveData(wrapper, endOfStream);
+
+			benchmark::DoNotOptimize(data.data());
+		}
+
+		state.SetBytesProcessed(state.iterations() * size);
+	}
+
+	/// @brief Peer answers every request with frame of fixed header and body. Frame is received into one buffer and split by copy or scattered into header and body
+	static void scatterReceive(benchmark::State& state, Transport transport)
+	{
+		struct Header
+		{
+			uint64_t id;
+			uint32_t type;
+			uint32_t flags;
+		};
+
+		auto [client, peer] = createConnection(transport);
+		int64_t size = state.range(0);
+		bool scattered = state.range(1);
+		Peer sender(peer, [size](streams::IOSocketStream& stream) { sendFramesOnRequest(stream, sizeof(Header) + size); });
+		CountingNetwork network(client);
+		web::utility::UninitializedBuffer frame;
+		web::utility::UninitializedBuffer body;
+		Header header = {};
+		char request = 0;
+		bool endOfStream = false;
+
+		network.resetSystemCalls();
+
+		for (auto _ : state)
+		{
+			web::utility::ContainerWrapper bodyWrapper(body);
+
+			network.sendRawData(&request, sizeof(request), endOfStream);
+
+			if (scattered)
+			{
+				network.receiveScatteredData(header, bodyWrapper, endOfStream);
+			}
+			else
+			{
+				web::utility::ContainerWrapper frameWrapper(frame);
+
+				network.receiveData(frameWrapper, endOfStream);
+
+				std::memcpy(&header, frame.data(), sizeof(Header));
+
+				bodyWrapper.resizeAndOverwrite
+				(
+					frame.size() - sizeof(Header),
+					[&frame](char* buffer) -> size_t
+					{
+						std::memcpy(buffer, frame.data() + sizeof(Header), frame.size() - sizeof(Header));
+
+						return frame.size() - sizeof(Header);
+					}
+				);
+			}
+
+			benchmark::DoNotOptimize(header);
+			benchmark::DoNotOptimize(body.data());
+		}
+
+		state.SetBytesProcessed(state.iterations() * (sizeof(Header) + size));
+
+		setSystemCallsCounter(state, network);
+	}
+
+	/// @brief Round trip of 32 byte message through echo peer as frame with size header and with fixed frame channel. Reports bytes on wire per message
+	static void fixedFrame(benchmark::State& state, Transport transport)
+	{
+		struct Message
+		{
+			uint64_t id;
+			uint64_t timestamp;
+			double price;
+			int64_t quantity;
+		};
+
+		auto [client, peer] = createConnection(transport);
+		bool fixed = state.range(0);
+		Peer echo
+		(
+			peer,
+			[fixed](streams::IOSocketStream& stream)
+			{
+				fixed ? echoBytes(stream, sizeof(Message)) : echoFrames(stream);
+			}
+		);
+		CountingNetwork network(client);
+		web::FixedFrameChannel<Message, 32> channel(network);
+		Message message = { 1, 2, 3.0, 4 };
+		bool endOfStream = false;
+
+		network.resetSystemCalls();
+
+		for (auto _ : state)
+		{
+			if (fixed)
+			{
+				channel.send(message, endOfStream);
+				channel.receive(message, endOfStream);
+			}
+			else
+			{
+				network.sendRawData(reinterpret_cast<const char*>(&message), sizeof(message), endOfStream);
+				network.receiveRawData(reinterpret_cast<char*>(&message), sizeof(message), endOfStream);
+			}
+		}
+
+		state.SetBytesProcessed(state.iterations() * sizeof(Message) * 2);
+		state.counters["wireBytes"] = static_cast<double>(fixed ? sizeof(Message) : sizeof(Message) + sizeof(int));
+
+		setSystemCallsCounter(state, network);
+	}
+
+	/// @brief Round trip of chunk through echo peer with exact size receive on both sides. syscalls/op counts client sends and receives
+	static void exactReceive(benchmark::State& state, Transport transport)
+	{
+		int chunkSize = static_cast<int>(state.range(0));
+		auto [client, peer] = createConnection(transport);
+		Peer peerThread(peer, [chunkSize](streams::IOSocketStream& stream) { echoBytes(stream, chunkSize); });
+		CountingNetwork network(client);
+		std::vector<char> data(static_cast<size_t>(chunkSize), 'a');
+		bool endOfStream = false;
+
+		for (auto _ : state)
+		{
+			network.sendBytes(data.data(), chunkSize, endOfStream);
+			network.receiveBytes(data.data(), chunkSize, endOfStream);
+		}
+
+		state.SetBytesProcessed(state.iterations() * chunkSize);
+
+		setSystemCallsCounter(state, network);
+	}
+
+	/// @brief Receive from non blocking connection without data, so every call fails with EAGAIN like expired timeout. Error is caught as WebException or returned by tryReceiveBytes
+	static void errorPath(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		web::Network peerNetwork(peer);
+		web::Network network(client);
+		bool nonThrowing = state.range(0);
+		char data[8] = {};
+		bool endOfStream = false;
+		int64_t errors = 0;
+
+#ifdef __LINUX__
+		fcntl(client, F_SETFL, fcntl(client, F_GETFL, 0) | O_NONBLOCK);
+#else
+		u_long nonBlocking = 1;
+
+		ioctlsocket(client, FIONBIO, &nonBlocking);
+#endif
+
+		for (auto _ : state)
+		{
+			if (nonThrowing)
+			{
+				web::NetworkError error = {};
+
+				errors += network.tryReceiveBytes(data, sizeof(data), endOfStream, error) == SOCKET_ERROR && error.isTimeout();
+			}
+			else
+			{
+				try
+				{
+					network.receiveBytes(data, sizeof(data), endOfStream);
+				}
+				catch (const web::exceptions::WebException&)
+				{
+					errors++;
+				}
+			}
+		}
+
+		if (errors != state.iterations())
+		{
+			state.SkipWithError("Receive didn't fail with timeout");
+		}
+	}
+
+	/// @brief Round trip of small chunk through echo peer. Both sides use same busy poll spin time, p50/p99 are reported per mode
+	static void pingPong(benchmark::State& state, Transport transport)
+	{
+		constexpr int chunkSize = 64;
+
+		auto [client, peer] = createConnection(transport);
+		std::chrono::microseconds busyPoll(state.range(0));
+		std::vector<int64_t> latencies;
+
+		latencies.reserve(1 << 20);
+
+		{
+			Peer peerThread
+			(
+				peer,
+				[busyPoll](streams::IOSocketStream& stream)
+				{
+					stream.getNetwork().setBusyPoll(busyPoll);
+
+					echoBytes(stream, chunkSize);
+				}
+			);
+			web::Network network(client);
+			char data[chunkSize] = {};
+			bool endOfStream = false;
+
+			network.setBusyPoll(busyPoll);
+
+			for (auto _ : state)
+			{
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+				network.sendBytes(data, chunkSize, endOfStream);
+				network.receiveBytes(data, chunkSize, endOfStream);
+
+				latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+			}
+		}
+
+		std::sort(latencies.begin(), latencies.end());
+
+		if (latencies.size())
+		{
+			state.counters["p50_ns"] = static_cast<double>(latencies[(latencies.size() - 1) * 50 / 100]);
+			state.counters["p99_ns"] = static_cast<double>(latencies[(latencies.size() - 1) * 99 / 100]);
+		}
+	}
+
+	static const bool registered = []()
+		{
+			registerForTransports
+			(
+				"Network/IsDataAvailable",
+				isDataAvailable,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgName("hasConnection")->Arg(0)->Arg(1);
+				}
+			);
+
+			registerForTransports
+			(
+				"Network/Observer",
+				observer,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgName("observer")->Arg(0)->Arg(1)->Arg(2);
+				}
+			);
+
+			registerForTransports
+			(
+				"Network/FrameHeader",
+				frameHeader,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgNames({ "size", "varint" })->ArgsProduct({ { 1, 8, 20, 200, 64 << 10 }, { 0, 1 } });
+				}
+			);
+
+			registerForTransports
+			(
+				"Network/ChunkedReceive",
+				chunkedReceive,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgNames({ "size", "chunked" })->ArgsProduct({ { 1 << 20, 64 << 20 }, { 0, 1 } })->UseRealTime();
+				}
+			);
+
+			auto configureReceiveSizes = [](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgName("size")->RangeMultiplier(8)->Range(64 << 10, 64 << 20)->UseRealTime();
+				};
+
+			registerForTransports("Network/ReceiveNewContainer/string", receiveNewContainer<std::string>, configureReceiveSizes);
+			registerForTransports("Network/ReceiveNewContainer/vector", receiveNewContainer<std::vector<char>>, configureReceiveSizes);
+			registerForTransports("Network/ReceiveNewContainer/UninitializedBuffer", receiveNewContainer<web::utility::UninitializedBuffer>, configureReceiveSizes);
+
+			registerForTransports
+			(
+				"Network/ScatterReceive",
+				scatterReceive,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgNames({ "size", "scattered" })->ArgsProduct({ { 64, 4 << 10, 1 << 20 }, { 0, 1 } })->UseRealTime();
+				}
+			);
+
+			registerForTransports
+			(
+				"Network/FixedFrame",
+				fixedFrame,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgName("fixed")->Arg(0)->Arg(1)->UseRealTime();
+				}
+			);
+
+			registerForTransports
+			(
+				"Network/ExactReceive",
+				exactReceive,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgName("size")->Arg(4)->Arg(8)->Arg(4 << 10)->Arg(1 << 20)->UseRealTime();
+				}
+			);
+
+			registerForTransports
+			(
+				"Network/ErrorPath",
+				errorPath,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgName("nonThrowing")->Arg(0)->Arg(1);
+				}
+			);
+
+			registerForTransports
+			(
+				"Network/PingPong",
+				pingPong,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgName("busyPollMicroseconds")->Arg(0)->Arg(50)->UseRealTime();
+				}
+			);
+
+			return true;
+		}();
+}
@@ -0,0 +1,437 @@
+#include "BenchmarkUtility.h"
+
+#include <vector>
+#include <string>
+
+#include "PageRegionPool.h"
+#include "ByteOrder.h"
+
+namespace benchmarks
+{
+	/// @brief Access to IOSocketBuffer receive buffer
+	class BufferArrayProbe : public buffers::IOSocketBuffer
+	{
+	private:
+		using BufferArray = decltype(std::declval<BufferArrayProbe&>().inputData);
+
+	public:
+		static void grow(benchmark::State& state)
+		{
+			size_t targetSize = static_cast<size_t>(state.range(0));
+
+			for (auto _ : state)
+			{
+				BufferArray bufferArray;
+
+				bufferArray.resize(1);
+
+				for (size_t size = bufferArray.size(); size < targetSize; size *= 2)
+				{
+					bufferArray.resize(size * 2);
+				}
+
+				benchmark::DoNotOptimize(bufferArray.data());
+			}
+
+			state.SetBytesProcessed(state.iterations() * targetSize);
+		}
+
+		/// @brief Buffer of every new connection with and without page region pool
+		static void churn(benchmark::State& state)
+		{
+			buffers::PageRegionPool& pool = buffers::PageRegionPool::get();
+			size_t maxRetainedBytes = pool.getMaxRetainedBytes();
+			size_t targetSize = static_cast<size_t>(state.range(0));
+			buffers::PageRegionPool::Statistics before = pool.getStatistics();
+
+			pool.setMaxRetainedBytes(state.range(1) ? maxRetainedBytes : 0);
+
+			for (auto _ : state)
+			{
+				BufferArray bufferArray;
+
+				bufferArray.resize(targetSize);
+
+				benchmark::DoNotOptimize(bufferArray.data());
+			}
+
+			buffers::PageRegionPool::Statistics after = pool.getStatistics();
+
+			pool.setMaxRetainedBytes(maxRetainedBytes);
+
+			state.counters["hits"] = benchmark::Counter(static_cast<double>(after.hits - before.hits), benchmark::Counter::kAvgIterations);
+			state.counters["misses"] = benchmark::Counter(static_cast<double>(after.misses - before.misses), benchmark::Counter::kAvgIterations);
+		}
+
+		/// @brief Large frame received into new buffer of connection, so page faults of first touch are measured. hugePages: 0 - disabled, 1 - enabled, 2 - enabled with prefault
+		static void largeReceive(benchmark::State& state, Transport transport)
+		{
+			auto [client, peer] = createConnection(transport);
+			int64_t size = state.range(0);
+			int64_t hugePages = state.range(1);
+			Peer sender(peer, [size](streams::IOSocketStream& stream) { sendFramesOnRequest(stream, size); });
+			CountingNetwork network(client);
+			buffers::PageRegionPool& pool = buffers::PageRegionPool::get();
+			size_t hugePageThreshold = pool.getHugePageThreshold();
+			buffers::PageRegionPool::Statistics before = pool.getStatistics();
+			char request = 0;
+			bool endOfStream = false;
+
+			pool.setHugePageThreshold(hugePages ? hugePageThreshold : 0);
+			pool.setPrefault(hugePages == 2);
+
+			for (auto _ : state)
+			{
+				BufferArray bufferArray;
+
+				bufferArray.resize(static_cast<size_t>(size));
+
+				network.sendRawData(&request, sizeof(request), endOfStream);
+				network.receiveRawData(bufferArray.data(), static_cast<int>(size), endOfStream);
+
+				benchmark::DoNotOptimize(bufferArray.data());
+			}
+
+			buffers::PageRegionPool::Statistics after = pool.getStatistics();
+
+			pool.setHugePageThreshold(hugePageThreshold);
+			pool.setPrefault(false);
+
+			state.SetBytesProcessed(state.iterations() * size);
+			state.counters["hugePageRegions"] = benchmark::Counter(static_cast<double>(after.hugePageRegions - before.hugePageRegions), benchmark::Counter::kAvgIterations);
+		}
+	};
+
+	template<typename T>
+	void fundamentalRoundTrip(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		Peer echo(peer, [](streams::IOSocketStream& peerStream) { echoBytes(peerStream, sizeof(T)); });
+		streams::IOSocketStream stream = streams::IOSocketStream::createStream<CountingNetwork>(client);
+		CountingNetwork& network = stream.getNetwork<CountingNetwork>();
+		T value = T(1);
+
+		network.resetSystemCalls();
+
+		for (auto _ : state)
+		{
+			stream << value;
+			stream >> value;
+
+			benchmark::DoNotOptimize(value);
+		}
+
+		state.SetBytesProcessed(state.iterations() * sizeof(T) * 2);
+
+		setSystemCallsCounter(state, network);
+	}
+
+	template<typename T>
+	void containerRoundTrip(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		Peer echo(peer, echoFrames);
+		streams::IOSocketStream stream = streams::IOSocketStream::createStream<CountingNetwork>(client);
+		CountingNetwork& network = stream.getNetwork<CountingNetwork>();
+		T data(static_cast<size_t>(state.range(0)), 'a');
+		T result;
+
+		network.resetSystemCalls();
+
+		for (auto _ : state)
+		{
+			stream << data;
+			stream >> result;
+
+			benchmark::DoNotOptimize(result.data());
+		}
+
+		state.SetBytesProcessed(state.iterations() * data.size() * 2);
+
+		setSystemCallsCounter(state, network);
+	}
+
+	/// @brief Array of doubles sent to peer that answers with acknowledgement. mode: 0 - operator << for every element, 1 - one frame, 2 - one frame in non native byte order
+	static void arrayTransfer(benchmark::State& state, Transport transport)
+	{
+		constexpr std::endian nonNative = std::endian::native == std::endian::little ? std::endian::big : std::endian::little;
+
+		auto [client, peer] = createConnection(transport);
+		size_t count = static_cast<size_t>(state.range(0));
+		int64_t mode = state.range(1);
+		Peer receiver
+		(
+			peer,
+			[count, mode](streams::IOSocketStream& peerStream)
+			{
+				std::vector<double, web::utility::DefaultInitAllocator<double>> data(count);
+
+				while (true)
+				{
+					if (mode)
+					{
+						mode == 1 ? peerStream.receiveArray(data) : peerStream.receiveArray<nonNative>(data);
+					}
+					else
+					{
+						for (double& value : data)
+						{
+							peerStream >> value;
+						}
+					}
+
+					if (peerStream.eof())
+					{
+						break;
+					}
+
+					peerStream << true;
+				}
+			}
+		);
+		streams::IOSocketStream stream = streams::IOSocketStream::createStream<CountingNetwork>(client);
+		CountingNetwork& network = stream.getNetwork<CountingNetwork>();
+		std::vector<double> data(count, 1.5);
+		bool acknowledgement = false;
+
+		network.resetSystemCalls();
+
+		for (auto _ : state)
+		{
+			switch (mode)
+			{
+			case 0:
+				for (double value : data)
+				{
+					stream << value;
+				}
+
+				break;
+
+			case 1:
+				stream << data;
+
+				break;
+
+			default:
+				stream.sendArray<nonNative>(data);
+
+				break;
+			}
+
+			stream >> acknowledgement;
+		}
+
+		state.SetBytesProcessed(state.iterations() * count * sizeof(double));
+
+		setSystemCallsCounter(state, network);
+	}
+
+	/// @brief Record with padding, 21 bytes packed
+	struct Quote
+	{
+		uint64_t id;
+		double price;
+		int32_t quantity;
+		bool buy;
+	};
+
+	/// @brief Quote sent to peer that answers with acknowledgement. record: 0 - operator << for every field, 1 - one packed frame
+	static void recordTransfer(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		bool record = state.range(0);
+		Peer receiver
+		(
+			peer,
+			[record](streams::IOSocketStream& peerStream)
+			{
+				Quote quote = {};
+
+				while (true)
+				{
+					if (record)
+					{
+						peerStream >> quote;
+					}
+					else
+					{
+						peerStream >> quote.id;
+						peerStream >> quote.price;
+						peerStream >> quote.quantity;
+						peerStream >> quote.buy;
+					}
+
+					if (peerStream.eof())
+					{
+						break;
+					}
+
+					peerStream << true;
+				}
+			}
+		);
+		streams::IOSocketStream stream = streams::IOSocketStream::createStream<CountingNetwork>(client);
+		CountingNetwork& network = stream.getNetwork<CountingNetwork>();
+		Quote quote = { 1, 1.5, 100, true };
+		bool acknowledgement = false;
+
+		network.resetSystemCalls();
+
+		for (auto _ : state)
+		{
+			if (record)
+			{
+				stream << quote;
+			}
+			else
+			{
+				stream << quote.id;
+				stream << quote.price;
+				stream << quote.quantity;
+				stream << quote.buy;
+			}
+
+			stream >> acknowledgement;
+		}
+
+		state.SetBytesProcessed(state.iterations() * web::utility::packedSize<Quote>);
+
+		setSystemCallsCounter(state, network);
+	}
+
+	/// @brief In place conversion of 8 byte elements with implementation selected for CPU and with portable one
+	static void byteSwap(benchmark::State& state, bool software)
+	{
+		std::vector<uint64_t> data(static_cast<size_t>(state.range(0)) / sizeof(uint64_t), 0x0102030405060708);
+
+		for (auto _ : state)
+		{
+			software ?
+				web::utility::byteSwapSoftware(data.data(), data.data(), data.size(), sizeof(uint64_t)) :
+				web::utility::byteSwap(data.data(), data.data(), data.size(), sizeof(uint64_t));
+
+			benchmark::DoNotOptimize(data.data());
+		}
+
+		state.SetBytesProcessed(state.iterations() * data.size() * sizeof(uint64_t));
+		state.SetLabel(software ? "software" : std::string(web::utility::getByteSwapImplementation()));
+	}
+
+	/// @brief Same round trip as containerRoundTrip, but response is read as view into stream buffer
+	static void receiveViewRoundTrip(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		Peer echo(peer, echoFrames);
+		streams::IOSocketStream stream = streams::IOSocketStream::createStream<CountingNetwork>(client);
+		CountingNetwork& network = stream.getNetwork<CountingNetwork>();
+		std::string data(static_cast<size_t>(state.range(0)), 'a');
+
+		network.resetSystemCalls();
+
+		for (auto _ : state)
+		{
+			stream << data;
+
+			benchmark::DoNotOptimize(stream.receiveView().data());
+		}
+
+		state.SetBytesProcessed(state.iterations() * data.size() * 2);
+
+		setSystemCallsCounter(state, network);
+	}
+
+#ifdef __LINUX__
+	/// @brief Stream for every accepted connection(duplicated socket) that is closed without receiving. embedded: 0 - network allocated separately from buffer, 1 - createStream<web::Network>
+	static void streamChurn(benchmark::State& state)
+	{
+		auto [client, peer] = createConnection(Transport::socketPair);
+		bool embedded = state.range(0);
+
+		for (auto _ : state)
+		{
+			SOCKET socket = dup(client);
+			streams::IOSocketStream stream = embedded ?
+				streams::IOSocketStream::createStream<web::Network>(socket) :
+				streams::IOSocketStream::createStream<buffers::IOSocketBuffer>(std::make_unique<web::Network>(socket));
+
+			benchmark::DoNotOptimize(&stream);
+		}
+
+		closesocket(client);
+		closesocket(peer);
+	}
+#endif
+
+	template<typename T>
+	void containerWrapperConstruction(benchmark::State& state)
+	{
+		T data(64, 'a');
+
+		for (auto _ : state)
+		{
+			web::utility::ContainerWrapper wrapper(data);
+
+			benchmark::DoNotOptimize(&wrapper);
+		}
+	}
+
+	static void configureSizes(benchmark::internal::Benchmark* benchmark)
+	{
+		benchmark->RangeMultiplier(8)->Range(8, 16 << 20);
+	}
+
+	static const bool registered = []()
+		{
+			registerForTransports("IOSocketStream/Fundamental/int", fundamentalRoundTrip<int>);
+			registerForTransports("IOSocketStream/Fundamental/int64", fundamentalRoundTrip<int64_t>);
+			registerForTransports("IOSocketStream/Fundamental/double", fundamentalRoundTrip<double>);
+			registerForTransports("IOSocketStream/Container/string", containerRoundTrip<std::string>, configureSizes);
+			registerForTransports("IOSocketStream/Container/vector", containerRoundTrip<std::vector<char>>, configureSizes);
+			registerForTransports("IOSocketStream/ReceiveView", receiveViewRoundTrip, configureSizes);
+			registerForTransports
+			(
+				"IOSocketStream/Array",
+				arrayTransfer,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgNames({ "count", "mode" })->ArgsProduct({ { 1 << 10, 16 << 10 }, { 0, 1, 2 } })->UseRealTime();
+				}
+			);
+
+			registerForTransports
+			(
+				"IOSocketStream/Record",
+				recordTransfer,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgName("record")->Arg(0)->Arg(1)->UseRealTime();
+				}
+			);
+
+			for (bool software : { false, true })
+			{
+				benchmark::RegisterBenchmark(software ? "ByteOrder/Swap/Software" : "ByteOrder/Swap/Dispatched", byteSwap, software)->
+					ArgName("size")->RangeMultiplier(16)->Range(64, 4 << 20);
+			}
+
+			benchmark::RegisterBenchmark("BufferArray/Resize", BufferArrayProbe::grow)->RangeMultiplier(8)->Range(4096, 16 << 20);
+			benchmark::RegisterBenchmark("BufferArray/Churn", BufferArrayProbe::churn)->ArgNames({ "size", "pooled" })->ArgsProduct({ { 4096, 64 << 10 }, { 0, 1 } });
+			registerForTransports
+			(
+				"BufferArray/LargeReceive",
+				BufferArrayProbe::largeReceive,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgNames({ "size", "hugePages" })->ArgsProduct({ { 8 << 20, 32 << 20, 64 << 20 }, { 0, 1, 2 } })->UseRealTime();
+				}
+			);
+#ifdef __LINUX__
+			benchmark::RegisterBenchmark("IOSocketStream/Churn", streamChurn)->ArgName("embedded")->Arg(0)->Arg(1);
+#endif
+			benchmark::RegisterBenchmark("ContainerWrapper/Construction/string", containerWrapperConstruction<std::string>);
+			benchmark::RegisterBenchmark("ContainerWrapper/Construction/vector", containerWrapperConstruction<std::vector<char>>);
+
+			return true;
+		}();
+}
@@ -0,0 +1,157 @@
+#include "BenchmarkUtility.h"
+
+#include <random>
+
+#include "Varint.h"
+
+namespace benchmarks
+{
+	/// @brief Signed values of up to bits magnitude, so varint size depends on bits. 0 bits mixes magnitudes of 1 - 40 bits
+	static std::vector<int64_t> createValues(size_t count, int64_t bits)
+	{
+		std::mt19937_64 random(1);
+		std::vector<int64_t> result(count);
+
+		for (int64_t& value : result)
+		{
+			value = static_cast<int64_t>(random() >> (64 - (bits ? bits : static_cast<int64_t>(random() % 40 + 1))));
+
+			if (random() & 1)
+			{
+				value = -value;
+			}
+		}
+
+		return result;
+	}
+
+	/// @brief Encode array with encodeVarint for every value and with batch encodeVarints
+	static void encode(benchmark::State& state)
+	{
+		std::vector<int64_t> values = createValues(16 << 10, state.range(0));
+		bool batch = state.range(1);
+		std::vector<char> data(values.size() * web::utility::maxVarint64Size);
+		size_t size = 0;
+
+		for (auto _ : state)
+		{
+			if (batch)
+			{
+				size = web::utility::encodeVarints(std::span<const int64_t>(values), data.data());
+			}
+			else
+			{
+				size = 0;
+
+				for (int64_t value : values)
+				{
+					size += web::utility::encodeVarint(web::utility::toVarint(value), data.data() + size);
+				}
+			}
+
+			benchmark::DoNotOptimize(data.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * values.size());
+		state.counters["bytesPerValue"] = static_cast<double>(size) / values.size();
+	}
+
+	/// @brief Decode array with decodeVarint for every value and with batch decodeVarints
+	static void decode(benchmark::State& state)
+	{
+		std::vector<int64_t> values = createValues(16 << 10, state.range(0));
+		bool batch = state.range(1);
+		std::vector<char> data(values.size() * web::utility::maxVarint64Size);
+		size_t size = web::utility::encodeVarints(std::span<const int64_t>(values), data.data());
+
+		for (auto _ : state)
+		{
+			if (batch)
+			{
+				web::utility::decodeVarints(data.data(), size, std::span<int64_t>(values));
+			}
+			else
+			{
+				size_t offset = 0;
+
+				for (int64_t& value : values)
+				{
+					uint64_t encoded = 0;
+
+					offset += web::utility::decodeVarint(data.data() + offset, size - offset, encoded);
+					value = web::utility::fromVarint<int64_t>(encoded);
+				}
+			}
+
+			benchmark::DoNotOptimize(values.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * values.size());
+	}
+
+	/// @brief Array of int64 sent to peer that answers with acknowledgement as fixed size values and as varints. Reports bytes on wire per value
+	static void integerArray(benchmark::State& state, Transport transport)
+	{
+		auto [client, peer] = createConnection(transport);
+		std::vector<int64_t> values = createValues(16 << 10, state.range(0));
+		bool varint = state.range(1);
+		Peer receiver
+		(
+			peer,
+			[varint](streams::IOSocketStream& peerStream)
+			{
+				std::vector<int64_t> data;
+
+				while (true)
+				{
+					varint ? peerStream.receiveVarints(data) : peerStream.receiveArray(data);
+
+					if (peerStream.eof())
+					{
+						break;
+					}
+
+					peerStream << true;
+				}
+			}
+		);
+		streams::IOSocketStream stream = streams::IOSocketStream::createStream<CountingNetwork>(client);
+		bool acknowledgement = false;
+
+		for (auto _ : state)
+		{
+			varint ? stream.sendVarints(values) : stream.sendArray(values);
+
+			stream >> acknowledgement;
+		}
+
+		std::vector<char> encoded(values.size() * web::utility::maxVarint64Size);
+		size_t wireSize = varint ? web::utility::encodeVarints(std::span<const int64_t>(values), encoded.data()) : values.size() * sizeof(int64_t);
+
+		state.SetItemsProcessed(state.iterations() * values.size());
+		state.counters["wireBytesPerValue"] = static_cast<double>(wireSize) / values.size();
+	}
+
+	static const bool registered = []()
+		{
+			auto configure = [](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgNames({ "bits", "batch" })->ArgsProduct({ { 0, 6, 13, 40 }, { 0, 1 } });
+				};
+
+			configure(benchmark::RegisterBenchmark("Varint/Encode", encode));
+			configure(benchmark::RegisterBenchmark("Varint/Decode", decode));
+
+			registerForTransports
+			(
+				"IOSocketStream/Integers",
+				integerArray,
+				[](benchmark::internal::Benchmark* benchmark)
+				{
+					benchmark->ArgNames({ "bits", "varint" })->ArgsProduct({ { 0, 6, 13, 40 }, { 0, 1 } })->UseRealTime();
+				}
+			);
+
+			return true;
+		}();
+}
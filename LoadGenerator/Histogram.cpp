@@ -0,0 +1,195 @@
+#include "Histogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+
+namespace load
+{
+	size_t Histogram::getIndex(int64_t value)
+	{
+		if (value < subBucketCount)
+		{
+			return static_cast<size_t>(value);
+		}
+
+		int shift = std::bit_width(static_cast<uint64_t>(value)) - subBucketBits;
+
+		return static_cast<size_t>(shift * subBucketHalfCount + (value >> shift));
+	}
+
+	int64_t Histogram::getLowestValue(size_t index)
+	{
+		if (index < static_cast<size_t>(subBucketCount))
+		{
+			return static_cast<int64_t>(index);
+		}
+
+		int64_t shift = static_cast<int64_t>(index) / subBucketHalfCount - 1;
+
+		return (static_cast<int64_t>(index) - shift * subBucketHalfCount) << shift;
+	}
+
+	int64_t Histogram::getHighestValue(size_t index)
+	{
+		if (index < static_cast<size_t>(subBucketCount))
+		{
+			return static_cast<int64_t>(index);
+		}
+
+		int64_t shift = static_cast<int64_t>(index) / subBucketHalfCount - 1;
+
+		return getLowestValue(index) + (int64_t(1) << shift) - 1;
+	}
+
+	Histogram::Histogram(int64_t highestTrackableValue) :
+		counts(Histogram::getIndex(highestTrackableValue) + 1),
+		totalCount(0),
+		minValue((std::numeric_limits<int64_t>::max)()),
+		maxValue(0)
+	{
+
+	}
+
+	void Histogram::record(int64_t value, uint64_t count)
+	{
+		value = std::max<int64_t>(value, 0);
+
+		counts[std::min(Histogram::getIndex(value), counts.size() - 1)] += count;
+		totalCount += count;
+		minValue = std::min(minValue, value);
+		maxValue = std::max(maxValue, value);
+	}
+
+	void Histogram::merge(const Histogram& other)
+	{
+		if (counts.size() < other.counts.size())
+		{
+			counts.resize(other.counts.size());
+		}
+
+		for (size_t i = 0; i < other.counts.size(); i++)
+		{
+			counts[i] += other.counts[i];
+		}
+
+		totalCount += other.totalCount;
+		minValue = std::min(minValue, other.minValue);
+		maxValue = std::max(maxValue, other.maxValue);
+	}
+
+	int64_t Histogram::getValueAtPercentile(double percentile) const
+	{
+		if (!totalCount)
+		{
+			return 0;
+		}
+
+		uint64_t countAtPercentile = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * totalCount)), 1);
+		uint64_t total = 0;
+
+		for (size_t i = 0; i < counts.size(); i++)
+		{
+			total += counts[i];
+
+			if (total >= countAtPercentile)
+			{
+				return std::min(Histogram::getHighestValue(i), maxValue);
+			}
+		}
+
+		return maxValue;
+	}
+
+	uint64_t Histogram::getTotalCount() const noexcept
+	{
+		return totalCount;
+	}
+
+	int64_t Histogram::getMin() const noexcept
+	{
+		return totalCount ? minValue : 0;
+	}
+
+	int64_t Histogram::getMax() const noexcept
+	{
+		return maxValue;
+	}
+
+	double Histogram::getMean() const
+	{
+		if (!totalCount)
+		{
+			return 0.0;
+		}
+
+		double total = 0.0;
+
+		for (size_t i = 0; i < counts.size(); i++)
+		{
+			if (counts[i])
+			{
+				total += static_cast<double>(counts[i]) * ((Histogram::getLowestValue(i) + Histogram::getHighestValue(i)) / 2.0);
+			}
+		}
+
+		return total / totalCount;
+	}
+
+	void Histogram::writePercentileDistribution(std::ostream& stream, double valueScale, int ticksPerHalfDistance) const
+	{
+		stream << std::format("{:>12} {:>14} {:>10} {:>14}\n\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+
+		if (totalCount)
+		{
+			uint64_t total = 0;
+			double nextPercentile = 0.0;
+			double halfDistance = 50.0;
+			int ticks = 0;
+
+			for (size_t i = 0; i < counts.size() && total < totalCount; i++)
+			{
+				if (!counts[i])
+				{
+					continue;
+				}
+
+				total += counts[i];
+
+				double percentile = 100.0 * total / totalCount;
+
+				if (percentile < nextPercentile && total != totalCount)
+				{
+					continue;
+				}
+
+				double fraction = percentile / 100.0;
+
+				if (total == totalCount)
+				{
+					stream << std::format("{:12.3f} {:2.12f} {:10} {:>14}\n", std::min(Histogram::getHighestValue(i), maxValue) / valueScale, fraction, total, "inf");
+				}
+				else
+				{
+					stream << std::format("{:12.3f} {:2.12f} {:10} {:14.2f}\n", Histogram::getHighestValue(i) / valueScale, fraction, total, 1.0 / (1.0 - fraction));
+				}
+
+				// Ticks get denser while approaching 100%: ticksPerHalfDistance reports for every halving of remaining distance
+				while (nextPercentile <= percentile)
+				{
+					nextPercentile += halfDistance / ticksPerHalfDistance;
+
+					if (++ticks == ticksPerHalfDistance)
+					{
+						ticks = 0;
+						halfDistance /= 2.0;
+					}
+				}
+			}
+		}
+
+		stream << std::format("#[Mean    = {:12.3f}, Max   = {:12.3f}]\n", this->getMean() / valueScale, maxValue / valueScale);
+		stream << std::format("#[Samples = {:12}, Min   = {:12.3f}]\n", totalCount, this->getMin() / valueScale);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <ostream>
+
+namespace load
+{
+	/// @brief High dynamic range histogram. Log-linear buckets with 2^(subBucketBits - 1) linear sub-buckets in each power of two
+	class Histogram
+	{
+	public:
+		static constexpr int subBucketBits = 11;
+		static constexpr int64_t subBucketCount = int64_t(1) << subBucketBits;
+		static constexpr int64_t subBucketHalfCount = subBucketCount / 2;
+
+	private:
+		std::vector<uint64_t> counts;
+		uint64_t totalCount;
+		int64_t minValue;
+		int64_t maxValue;
+
+	private:
+		static size_t getIndex(int64_t value);
+
+		static int64_t getLowestValue(size_t index);
+
+		static int64_t getHighestValue(size_t index);
+
+	public:
+		/// @param highestTrackableValue Larger values are clamped
+		Histogram(int64_t highestTrackableValue = int64_t(1) << 37);
+
+		void record(int64_t value, uint64_t count = 1);
+
+		void merge(const Histogram& other);
+
+		/// @param percentile In range [0, 100]
+		int64_t getValueAtPercentile(double percentile) const;
+
+		uint64_t getTotalCount() const noexcept;
+
+		int64_t getMin() const noexcept;
+
+		int64_t getMax() const noexcept;
+
+		double getMean() const;
+
+		/// @brief Write percentile distribution in HdrHistogram .hgrm format
+		/// @param valueScale Divider for values(1000 for nanoseconds to microseconds)
+		void writePercentileDistribution(std::ostream& stream, double valueScale = 1000.0, int ticksPerHalfDistance = 5) const;
+	};
+}
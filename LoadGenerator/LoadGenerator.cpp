@@ -0,0 +1,364 @@
+#include "LoadGenerator.h"
+
+#include <thread>
+#include <random>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+#include <charconv>
+
+#include "IOSocketStream.h"
+
+#ifdef __LINUX__
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
+
+namespace load
+{
+	static std::pair<SOCKET, SOCKET> createConnection(const Profile& profile)
+	{
+#ifdef __LINUX__
+		if (profile.transport == Transport::socketPair)
+		{
+			int sockets[2] = {};
+
+			if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets))
+			{
+				THROW_WEB_EXCEPTION;
+			}
+
+			return { sockets[0], sockets[1] };
+		}
+#else
+		static WSADATA wsaData;
+		static int startup = WSAStartup(MAKEWORD(2, 2), &wsaData);
+
+		if (profile.transport == Transport::socketPair)
+		{
+			throw std::invalid_argument("socketpair transport is not supported on this platform");
+		}
+#endif
+
+		sockaddr_in address = {};
+		socklen_t addressLength = sizeof(address);
+		SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		SOCKET client = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+			listen(listener, 1) == SOCKET_ERROR ||
+			getsockname(listener, reinterpret_cast<sockaddr*>(&address), &addressLength) == SOCKET_ERROR ||
+			connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+
+		SOCKET peer = accept(listener, nullptr, nullptr);
+
+		closesocket(listener);
+
+		return { client, peer };
+	}
+
+	static void applyOptions(web::Network& network, const Profile& profile)
+	{
+		network.setBusyPoll(profile.busyPoll);
+
+		if (profile.noDelay)
+		{
+			int value = 1;
+
+			setsockopt(network.getClientSocket(), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&value), sizeof(value));
+		}
+	}
+
+	static void echo(web::Network& network)
+	{
+		std::string data;
+		web::utility::ContainerWrapper container(data);
+		bool endOfStream = false;
+
+		try
+		{
+			while (true)
+			{
+				int size = network.receiveData(container, endOfStream);
+
+				if (endOfStream)
+				{
+					break;
+				}
+
+				network.sendRawData(data.data(), size, endOfStream);
+
+				if (endOfStream)
+				{
+					break;
+				}
+			}
+		}
+		catch (const web::exceptions::WebException&)
+		{
+
+		}
+	}
+
+	Profile getProfile(std::string_view name)
+	{
+		constexpr std::chrono::microseconds busyPoll(50);
+
+		if (name == "loopback")
+		{
+			return { std::string(name), Transport::loopback, false, std::chrono::microseconds(0) };
+		}
+		else if (name == "loopback-nodelay")
+		{
+			return { std::string(name), Transport::loopback, true, std::chrono::microseconds(0) };
+		}
+		else if (name == "loopback-busypoll")
+		{
+			return { std::string(name), Transport::loopback, true, busyPoll };
+		}
+		else if (name == "socketpair")
+		{
+			return { std::string(name), Transport::socketPair, false, std::chrono::microseconds(0) };
+		}
+		else if (name == "socketpair-busypoll")
+		{
+			return { std::string(name), Transport::socketPair, false, busyPoll };
+		}
+		else if (name == "remote")
+		{
+			return { std::string(name), Transport::remote, false, std::chrono::microseconds(0) };
+		}
+		else if (name == "remote-nodelay")
+		{
+			return { std::string(name), Transport::remote, true, std::chrono::microseconds(0) };
+		}
+		else if (name == "remote-busypoll")
+		{
+			return { std::string(name), Transport::remote, true, busyPoll };
+		}
+
+		throw std::invalid_argument("Unknown profile: " + std::string(name));
+	}
+
+	std::vector<MessageSize> parseMessageSizes(std::string_view description)
+	{
+		std::vector<MessageSize> result;
+
+		while (description.size())
+		{
+			size_t end = description.find(',');
+			std::string_view item = description.substr(0, end);
+			std::string_view weight;
+			MessageSize messageSize = { 0, 1.0 };
+
+			if (size_t separator = item.find(':'); separator != std::string_view::npos)
+			{
+				weight = item.substr(separator + 1);
+				item = item.substr(0, separator);
+			}
+
+			auto [sizeEnd, sizeError] = std::from_chars(item.data(), item.data() + item.size(), messageSize.size);
+
+			if (sizeError != std::errc())
+			{
+				throw std::invalid_argument("Wrong message size: " + std::string(item));
+			}
+
+			if (sizeEnd != item.data() + item.size())
+			{
+				switch (*sizeEnd)
+				{
+				case 'K':
+				case 'k':
+					messageSize.size *= 1024;
+
+					break;
+
+				case 'M':
+				case 'm':
+					messageSize.size *= 1024 * 1024;
+
+					break;
+
+				default:
+					throw std::invalid_argument("Wrong message size: " + std::string(item));
+				}
+			}
+
+			if (weight.size())
+			{
+				messageSize.weight = std::stod(std::string(weight));
+			}
+
+			result.push_back(messageSize);
+
+			description = end == std::string_view::npos ? std::string_view() : description.substr(end + 1);
+		}
+
+		if (result.empty())
+		{
+			throw std::invalid_argument("Empty message sizes");
+		}
+
+		return result;
+	}
+
+	Result run(const Settings& settings, const Profile& profile)
+	{
+		using clock = std::chrono::steady_clock;
+
+		std::vector<std::thread> servers;
+		std::vector<std::thread> clients;
+		std::vector<Result> results(settings.connections, Result{ Histogram(), profile.name, 0, 0, 0, 0.0 });
+		std::vector<std::string> payloads;
+		std::vector<double> weights;
+		std::vector<streams::IOSocketStream> streams;
+
+		for (const MessageSize& messageSize : settings.messageSizes)
+		{
+			payloads.emplace_back(messageSize.size, 'a');
+			weights.push_back(messageSize.weight);
+		}
+
+		for (size_t i = 0; i < settings.connections; i++)
+		{
+			if (profile.transport == Transport::remote)
+			{
+				streams.push_back(streams::IOSocketStream::createStream<web::Network>(settings.remoteIp, settings.remotePort, settings.timeout));
+			}
+			else
+			{
+				auto [client, peer] = createConnection(profile);
+
+				streams.push_back(streams::IOSocketStream::createStream<web::Network>(client, settings.timeout));
+
+				servers.emplace_back
+				(
+					[peer, profile, timeout = settings.timeout]()
+					{
+						web::Network network(peer, timeout);
+
+						applyOptions(network, profile);
+
+						echo(network);
+					}
+				);
+			}
+
+			applyOptions(streams.back().getNetwork(), profile);
+		}
+
+		// Each connection sends with period connections / rate, start times are spread so connections do not fire in bursts
+		clock::duration interval = settings.rate > 0.0 ?
+			std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(settings.connections / settings.rate)) :
+			clock::duration::zero();
+		clock::time_point start = clock::now() + std::chrono::milliseconds(100);
+		clock::time_point measureStart = start + settings.warmup;
+		clock::time_point end = measureStart + settings.duration;
+
+		for (size_t i = 0; i < settings.connections; i++)
+		{
+			clients.emplace_back
+			(
+				[&, i]()
+				{
+					streams::IOSocketStream& stream = streams[i];
+					Result& result = results[i];
+					std::mt19937_64 random(i);
+					std::discrete_distribution<size_t> sizes(weights.begin(), weights.end());
+					std::string response;
+					clock::time_point next = start + interval * i / settings.connections;
+
+					while (true)
+					{
+						if (interval != clock::duration::zero())
+						{
+							std::this_thread::sleep_until(next);
+						}
+
+						clock::time_point intended = interval != clock::duration::zero() ? next : clock::now();
+
+						if (intended >= end)
+						{
+							break;
+						}
+
+						if (clock::time_point now = clock::now(); now >= end)
+						{
+							// Requests that should have been sent are still waiting in client, count them with latency up to now
+							for (; next < end; next += interval)
+							{
+								if (next >= measureStart)
+								{
+									result.latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - next).count());
+								}
+							}
+
+							break;
+						}
+
+						const std::string& payload = payloads[sizes(random)];
+
+						try
+						{
+							stream << payload;
+							stream >> response;
+						}
+						catch (const web::exceptions::WebException&)
+						{
+							stream.clear();
+
+							result.errors++;
+						}
+
+						if (stream.eof())
+						{
+							result.errors++;
+
+							break;
+						}
+
+						if (intended >= measureStart)
+						{
+							result.latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - intended).count());
+							result.requests++;
+							result.bytes += payload.size() * 2;
+						}
+
+						next += interval;
+					}
+				}
+			);
+		}
+
+		for (std::thread& client : clients)
+		{
+			client.join();
+		}
+
+		streams.clear();
+
+		for (std::thread& server : servers)
+		{
+			server.join();
+		}
+
+		Result result = { Histogram(), profile.name, 0, 0, 0, std::chrono::duration<double>(settings.duration).count() };
+
+		for (const Result& connectionResult : results)
+		{
+			result.latency.merge(connectionResult.latency);
+			result.requests += connectionResult.requests;
+			result.bytes += connectionResult.bytes;
+			result.errors += connectionResult.errors;
+		}
+
+		return result;
+	}
+}
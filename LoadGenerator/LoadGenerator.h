@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "Histogram.h"
+
+namespace load
+{
+	enum class Transport
+	{
+		loopback,
+		socketPair,
+		remote
+	};
+
+	/// @brief Transport with socket options applied on both sides of every connection
+	struct Profile
+	{
+		std::string name;
+		Transport transport;
+		bool noDelay;
+		/// @brief Spin time of busy poll receive mode. 0 means blocking receive
+		std::chrono::microseconds busyPoll;
+	};
+
+	struct MessageSize
+	{
+		size_t size;
+		double weight;
+	};
+
+	struct Settings
+	{
+		std::vector<Profile> profiles;
+		std::vector<MessageSize> messageSizes;
+		std::string remoteIp;
+		std::string remotePort;
+		std::string histogramPrefix;
+		std::chrono::milliseconds timeout;
+		std::chrono::seconds duration;
+		std::chrono::seconds warmup;
+		size_t connections;
+		/// @brief Total requests per second over all connections. 0 means closed loop
+		double rate;
+	};
+
+	struct Result
+	{
+		Histogram latency;
+		std::string profileName;
+		uint64_t requests;
+		uint64_t bytes;
+		uint64_t errors;
+		double seconds;
+	};
+
+	/// @brief Get profile by name(loopback, loopback-nodelay, loopback-busypoll, socketpair, socketpair-busypoll, remote, remote-nodelay, remote-busypoll)
+	/// @exception std::invalid_argument
+	Profile getProfile(std::string_view name);
+
+	/// @brief Parse size mix in format size[:weight],... Sizes accept K and M suffixes
+	/// @exception std::invalid_argument
+	std::vector<MessageSize> parseMessageSizes(std::string_view description);
+
+	/// @brief Run echo load with open-loop pacing. Latency is measured from intended send time so stalls are not hidden(coordinated omission)
+	Result run(const Settings& settings, const Profile& profile);
+}
@@ -0,0 +1,152 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <map>
+
+#include "LoadGenerator.h"
+
+static void printUsage()
+{
+	std::cout << "SocketStreamsLoadGenerator [options]" << std::endl
+		<< "  --profiles <list>     Comma separated profiles: loopback, loopback-nodelay, loopback-busypoll, socketpair, socketpair-busypoll, remote, remote-nodelay, remote-busypoll(default: loopback,loopback-nodelay)" << std::endl
+		<< "  --connect <ip:port>   Echo server for remote profiles" << std::endl
+		<< "  --connections <n>     Concurrent IOSocketStream clients(default: 16)" << std::endl
+		<< "  --rate <n>            Total requests per second, 0 for closed loop(default: 10000)" << std::endl
+		<< "  --sizes <mix>         Message sizes with weights: 64:80,4K:15,64K:5(default: 64)" << std::endl
+		<< "  --duration <seconds>  Measured time(default: 10)" << std::endl
+		<< "  --warmup <seconds>    Not measured time before measurement(default: 2)" << std::endl
+		<< "  --timeout <ms>        Send/receive timeout(default: 30000)" << std::endl
+		<< "  --hgrm <prefix>       Write HdrHistogram percentile distribution to <prefix><profile>.hgrm" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	std::map<std::string, std::string> options =
+	{
+		{ "--profiles", "loopback,loopback-nodelay" },
+		{ "--connections", "16" },
+		{ "--rate", "10000" },
+		{ "--sizes", "64" },
+		{ "--duration", "10" },
+		{ "--warmup", "2" },
+		{ "--timeout", "30000" },
+		{ "--connect", "" },
+		{ "--hgrm", "" }
+	};
+	load::Settings settings;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string key = argv[i];
+
+		if (key == "--help" || key == "-h")
+		{
+			printUsage();
+
+			return 0;
+		}
+
+		if (!options.contains(key) || i + 1 == argc)
+		{
+			printUsage();
+
+			return 1;
+		}
+
+		options[key] = argv[++i];
+	}
+
+	try
+	{
+		std::string_view profiles = options["--profiles"];
+		std::string_view remote = options["--connect"];
+
+		while (profiles.size())
+		{
+			size_t end = profiles.find(',');
+
+			settings.profiles.push_back(load::getProfile(profiles.substr(0, end)));
+
+			profiles = end == std::string_view::npos ? std::string_view() : profiles.substr(end + 1);
+		}
+
+		if (size_t separator = remote.rfind(':'); separator != std::string_view::npos)
+		{
+			settings.remoteIp = remote.substr(0, separator);
+			settings.remotePort = remote.substr(separator + 1);
+		}
+
+		settings.messageSizes = load::parseMessageSizes(options["--sizes"]);
+		settings.histogramPrefix = options["--hgrm"];
+		settings.timeout = std::chrono::milliseconds(std::stoll(options["--timeout"]));
+		settings.duration = std::chrono::seconds(std::stoll(options["--duration"]));
+		settings.warmup = std::chrono::seconds(std::stoll(options["--warmup"]));
+		settings.connections = std::stoull(options["--connections"]);
+		settings.rate = std::stod(options["--rate"]);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+
+		printUsage();
+
+		return 1;
+	}
+
+	std::vector<load::Result> results;
+
+	for (const load::Profile& profile : settings.profiles)
+	{
+		if (profile.transport == load::Transport::remote && settings.remoteIp.empty())
+		{
+			std::cerr << "Profile " << profile.name << " requires --connect" << std::endl;
+
+			return 1;
+		}
+
+		std::cout << "Running " << profile.name << "..." << std::endl;
+
+		try
+		{
+			results.push_back(load::run(settings, profile));
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Profile " << profile.name << " failed: " << e.what() << std::endl;
+
+			continue;
+		}
+
+		if (settings.histogramPrefix.size())
+		{
+			std::ofstream histogram(settings.histogramPrefix + profile.name + ".hgrm");
+
+			results.back().latency.writePercentileDistribution(histogram);
+		}
+	}
+
+	std::cout << std::format
+	(
+		"\n{:<20} {:>12} {:>12} {:>8} {:>10} {:>10} {:>10} {:>10} {:>10}\n",
+		"Profile", "Requests/s", "MiB/s", "Errors", "p50(us)", "p99(us)", "p99.9(us)", "max(us)", "mean(us)"
+	);
+
+	for (const load::Result& result : results)
+	{
+		std::cout << std::format
+		(
+			"{:<20} {:>12.1f} {:>12.2f} {:>8} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}\n",
+			result.profileName,
+			result.requests / result.seconds,
+			result.bytes / result.seconds / (1024.0 * 1024.0),
+			result.errors,
+			result.latency.getValueAtPercentile(50.0) / 1000.0,
+			result.latency.getValueAtPercentile(99.0) / 1000.0,
+			result.latency.getValueAtPercentile(99.9) / 1000.0,
+			result.latency.getMax() / 1000.0,
+			result.latency.getMean() / 1000.0
+		);
+	}
+
+	return 0;
+}
@@ -4,9 +4,81 @@
 #include <gtest/gtest.h>
 
 #include "IOSocketStream.h"
+#include "DatagramNetwork.h"
+#include "CompressedNetwork.h"
+#include "PageRegionPool.h"
+#include "FixedFrameChannel.h"
+#include "TcpInfoSampler.h"
+
+#ifdef __LINUX__
+#include <arpa/inet.h>
+#endif
 
 extern void runServer(bool& isRunning);
 
+/// @brief Connected loopback pair of SOCK_STREAM or SOCK_DGRAM sockets
+static std::pair<SOCKET, SOCKET> createLoopbackPair(int type)
+{
+#ifndef __LINUX__
+	static WSADATA wsaData;
+	static int startup = WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+	int protocol = type == SOCK_STREAM ? IPPROTO_TCP : IPPROTO_UDP;
+	sockaddr_in address = {};
+	socklen_t addressLength = sizeof(address);
+	SOCKET first = socket(AF_INET, type, protocol);
+	SOCKET second = socket(AF_INET, type, protocol);
+
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (type == SOCK_STREAM)
+	{
+		if (bind(first, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+			listen(first, 1) == SOCKET_ERROR ||
+			getsockname(first, reinterpret_cast<sockaddr*>(&address), &addressLength) == SOCKET_ERROR ||
+			connect(second, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+
+		SOCKET peer = accept(first, nullptr, nullptr);
+
+		closesocket(first);
+
+		return { second, peer };
+	}
+
+	sockaddr_in secondAddress = address;
+
+	if (bind(first, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+		bind(second, reinterpret_cast<sockaddr*>(&secondAddress), sizeof(secondAddress)) == SOCKET_ERROR ||
+		getsockname(first, reinterpret_cast<sockaddr*>(&address), &addressLength) == SOCKET_ERROR ||
+		getsockname(second, reinterpret_cast<sockaddr*>(&secondAddress), &addressLength) == SOCKET_ERROR ||
+		connect(first, reinterpret_cast<sockaddr*>(&secondAddress), sizeof(secondAddress)) == SOCKET_ERROR ||
+		connect(second, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR)
+	{
+		THROW_WEB_EXCEPTION;
+	}
+
+	return { first, second };
+}
+
+/// @brief Receives frame into existing container memory without resizing it
+class LenientNetwork : public web::Network
+{
+public:
+	using web::Network::Network;
+
+	int receiveData(web::utility::ContainerWrapper& data, bool& endOfStream, int flags = 0) override
+	{
+		int size = static_cast<int>(this->receiveFrameSize(endOfStream, flags));
+
+		return this->receiveBytes(data.data(), size, endOfStream, flags);
+	}
+};
+
 TEST(Streams, DefaultNetwork)
 {
 	streams::IOSocketStream stream = streams::IOSocketStream::createStream<web::Network>("127.0.0.1", "8080");
@@ -35,6 +107,2064 @@ TEST(Streams, DefaultNetwork)
 	}
 }
 
+TEST(Datagram, Batching)
+{
+	auto [first, second] = createLoopbackPair(SOCK_DGRAM);
+	web::DatagramNetwork sender(first, std::chrono::seconds(5));
+	web::DatagramNetwork receiver(second, std::chrono::seconds(5));
+	std::vector<std::string_view> datagrams = { "first", "", "third datagram", std::string_view("\0\1\2", 3), "last" };
+	std::vector<std::string> result;
+
+	ASSERT_EQ(sender.sendDatagrams(datagrams), static_cast<int>(datagrams.size()));
+
+	while (result.size() < datagrams.size())
+	{
+		std::vector<std::string> batch;
+
+		receiver.receiveDatagrams(batch, 2);
+
+		ASSERT_LE(batch.size(), 2);
+
+		result.insert(result.end(), batch.begin(), batch.end());
+	}
+
+	ASSERT_EQ(result, std::vector<std::string>(datagrams.begin(), datagrams.end()));
+}
+
+TEST(Datagram, SegmentationOffloadKeepsSingleSend)
+{
+	auto [first, second] = createLoopbackPair(SOCK_DGRAM);
+	web::DatagramNetwork sender(first, std::chrono::seconds(5));
+	web::DatagramNetwork receiver(second, std::chrono::seconds(5));
+	std::string large(1000, 'a');
+	std::string result;
+	web::utility::ContainerWrapper wrapper(result);
+	bool endOfStream = false;
+
+	try
+	{
+		sender.setSegmentationOffload(100);
+	}
+	catch (const web::exceptions::WebException&)
+	{
+		GTEST_SKIP() << "UDP_SEGMENT is not supported";
+	}
+
+	sender.sendRawData(large.data(), static_cast<int>(large.size()), endOfStream);
+
+	ASSERT_EQ(receiver.receiveData(wrapper, endOfStream), static_cast<int>(large.size()));
+	ASSERT_EQ(result, large);
+
+	std::vector<std::string> segments = { std::string(100, 'b'), std::string(100, 'c'), std::string(40, 'd') };
+	std::vector<std::string_view> views(segments.begin(), segments.end());
+	std::vector<std::string> received;
+
+	ASSERT_EQ(sender.sendDatagrams(views), 3);
+
+	while (received.size() < segments.size())
+	{
+		std::vector<std::string> batch;
+
+		receiver.receiveDatagrams(batch);
+
+		received.insert(received.end(), batch.begin(), batch.end());
+	}
+
+	ASSERT_EQ(received, segments);
+}
+
+TEST(Datagram, ObservedReceive)
+{
+	auto [first, second] = createLoopbackPair(SOCK_DGRAM);
+	web::DatagramNetwork sender(first, std::chrono::seconds(5));
+	web::DatagramNetwork receiver(second, std::chrono::seconds(5));
+	std::shared_ptr<web::utility::RingBufferNetworkObserver> observer = std::make_shared<web::utility::RingBufferNetworkObserver>(16);
+	std::string data = "observed";
+	std::string result;
+	web::utility::ContainerWrapper wrapper(result);
+	bool endOfStream = true;
+
+	receiver.setObserver(observer);
+
+	sender.sendRawData(data.data(), static_cast<int>(data.size()), endOfStream);
+
+	ASSERT_EQ(receiver.receiveData(wrapper, endOfStream), static_cast<int>(data.size()));
+	ASSERT_FALSE(endOfStream);
+
+	std::vector<web::utility::RingBufferNetworkObserver::Record> records = observer->getRecords();
+
+	ASSERT_EQ(records.size(), 2);
+	ASSERT_EQ(records[1].event.operation, web::utility::NetworkOperation::receiveData);
+	ASSERT_FALSE(records[1].begin);
+	ASSERT_EQ(records[1].event.bytes, static_cast<int64_t>(data.size()));
+}
+
+TEST(Observer, RingBufferConcurrentRead)
+{
+	web::utility::RingBufferNetworkObserver observer(8);
+	std::atomic<bool> running = true;
+	std::atomic<int64_t> written = 0;
+	std::thread writer
+	(
+		[&observer, &running, &written]()
+		{
+			for (int64_t i = 0; running; i++)
+			{
+				observer.onBegin(web::utility::NetworkEvent{ web::utility::NetworkOperation::sendBytes, i, std::chrono::steady_clock::now(), i, 0, false });
+
+				written = i + 1;
+			}
+		}
+	);
+
+	for (int i = 0; i < 1000 || written < 1000; i++)
+	{
+		std::vector<web::utility::RingBufferNetworkObserver::Record> records = observer.getRecords();
+
+		ASSERT_LE(records.size(), 8);
+
+		for (const web::utility::RingBufferNetworkObserver::Record& record : records)
+		{
+			ASSERT_EQ(record.event.socket, record.event.bytes);
+			ASSERT_TRUE(record.begin);
+		}
+	}
+
+	running = false;
+
+	writer.join();
+
+	ASSERT_EQ(observer.getRecords().size(), 8);
+}
+
+TEST(Observer, RingBufferAlternatingObservers)
+{
+	web::utility::RingBufferNetworkObserver first(64);
+	web::utility::RingBufferNetworkObserver second(64);
+
+	for (int64_t i = 0; i < 20; i++)
+	{
+		web::utility::NetworkEvent event{ web::utility::NetworkOperation::receiveBytes, i, std::chrono::steady_clock::now(), i, 0, false };
+
+		first.onBegin(event);
+		second.onEnd(event);
+	}
+
+	std::vector<web::utility::RingBufferNetworkObserver::Record> firstRecords = first.getRecords();
+	std::vector<web::utility::RingBufferNetworkObserver::Record> secondRecords = second.getRecords();
+
+	ASSERT_EQ(firstRecords.size(), 20);
+	ASSERT_EQ(secondRecords.size(), 20);
+	ASSERT_TRUE(std::ranges::all_of(firstRecords, [](const auto& record) { return record.begin; }));
+	ASSERT_TRUE(std::ranges::none_of(secondRecords, [](const auto& record) { return record.begin; }));
+	ASSERT_EQ(firstRecords.back().event.bytes, 19);
+}
+
+TEST(Container, ResizeAndOverwrite)
+{
+	std::string value = "ab";
+	web::utility::ContainerWrapper wrapper(value);
+
+	wrapper.resizeAndOverwrite(19, [](char* buffer) { std::fill_n(buffer, 19, 'x'); return 19; });
+
+	ASSERT_EQ(value, std::string(19, 'x'));
+
+	value = "ab";
+
+	wrapper.resizeAndOverwrite(10, [](char* buffer) { std::fill_n(buffer, 5, 'y'); return 5; });
+
+	ASSERT_EQ(value, "yyyyy");
+
+	value = "ab";
+
+	ASSERT_THROW(wrapper.resizeAndOverwrite(100, [](char*) -> size_t { throw std::runtime_error("receive failed"); }), std::runtime_error);
+	ASSERT_EQ(value, "ab");
+
+	std::vector<char> bytes = { 'a', 'b', 'c' };
+	web::utility::ContainerWrapper bytesWrapper(bytes);
+
+	bytesWrapper.resizeAndOverwrite(2, [](char* buffer) { buffer[0] = 'z'; return 1; });
+
+	ASSERT_EQ(bytes, std::vector<char>({ 'z', 'b', 'c' }));
+}
+
+TEST(Container, ClosedDuringPayload)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network receiver(second, std::chrono::seconds(5));
+	std::string result;
+	web::utility::ContainerWrapper wrapper(result);
+	bool endOfStream = false;
+
+	{
+		web::Network sender(first, std::chrono::seconds(5));
+		int size = 100;
+
+		sender.sendBytes(&size, sizeof(size), endOfStream);
+		sender.sendBytes("partial", 7, endOfStream);
+	}
+
+	receiver.receiveData(wrapper, endOfStream);
+
+	ASSERT_TRUE(endOfStream);
+	ASSERT_TRUE(result.empty());
+}
+
+/// @brief Send frame in frame checksum format with given checksums
+static void sendChecksumFrame(web::Network& network, std::string_view payload, uint32_t checksum, bool validHeader)
+{
+	struct
+	{
+		int size;
+		uint32_t checksum;
+		uint32_t headerChecksum;
+	} header = { static_cast<int>(payload.size()), checksum, 0 };
+	bool endOfStream = false;
+
+	header.headerChecksum = web::utility::crc32c(&header, sizeof(header.size) + sizeof(header.checksum)) ^ (validHeader ? 0 : 1);
+
+	network.sendBytes(&header, sizeof(header), endOfStream);
+	network.sendBytes(payload.data(), static_cast<int>(payload.size()), endOfStream);
+}
+
+TEST(Checksum, KnownValue)
+{
+	std::string_view data = "123456789";
+
+	ASSERT_EQ(web::utility::crc32c(data.data(), data.size()), 0xE3069283);
+	ASSERT_EQ(web::utility::crc32cSoftware(data.data(), data.size()), 0xE3069283);
+	ASSERT_EQ(web::utility::crc32c(data.data() + 4, data.size() - 4, web::utility::crc32c(data.data(), 4)), 0xE3069283);
+}
+
+TEST(Checksum, FrameMismatch)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::seconds(5));
+	std::string_view payload = "checksummed payload";
+	bool endOfStream = false;
+
+	sender.enableFrameChecksum();
+	receiver.enableFrameChecksum();
+
+	sender.sendRawData(payload.data(), static_cast<int>(payload.size()), endOfStream);
+	sendChecksumFrame(sender, payload, web::utility::crc32c(payload.data(), payload.size()) + 1, true);
+
+	{
+		std::string result;
+		web::utility::ContainerWrapper wrapper(result);
+
+		ASSERT_EQ(receiver.receiveData(wrapper, endOfStream), static_cast<int>(payload.size()));
+		ASSERT_EQ(result, payload);
+	}
+
+	try
+	{
+		std::string result;
+		web::utility::ContainerWrapper wrapper(result);
+
+		receiver.receiveData(wrapper, endOfStream);
+
+		FAIL() << "Corrupted payload accepted";
+	}
+	catch (const web::exceptions::WebException& e)
+	{
+		ASSERT_EQ(e.getErrorCode(), EBADMSG);
+	}
+}
+
+TEST(Checksum, HeaderMismatch)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::seconds(5));
+	std::string_view payload = "payload";
+	std::string result;
+	web::utility::ContainerWrapper wrapper(result);
+	bool endOfStream = false;
+
+	receiver.enableFrameChecksum();
+
+	sendChecksumFrame(sender, payload, web::utility::crc32c(payload.data(), payload.size()), false);
+
+	try
+	{
+		receiver.receiveData(wrapper, endOfStream);
+
+		FAIL() << "Corrupted header accepted";
+	}
+	catch (const web::exceptions::WebException& e)
+	{
+		ASSERT_EQ(e.getErrorCode(), EBADMSG);
+		ASSERT_TRUE(result.empty());
+	}
+}
+
+/// @brief Negotiate frame header on both sides of new connection
+static std::pair<web::FrameHeader, web::FrameHeader> negotiate(web::FrameHeader firstPreferred, web::FrameHeader secondPreferred)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network firstNetwork(first, std::chrono::seconds(5));
+	web::Network secondNetwork(second, std::chrono::seconds(5));
+	web::FrameHeader secondResult;
+	std::thread peer([&]() { secondResult = secondNetwork.negotiateFrameHeader(secondPreferred); });
+	web::FrameHeader firstResult = firstNetwork.negotiateFrameHeader(firstPreferred);
+
+	peer.join();
+
+	return { firstResult, secondResult };
+}
+
+TEST(FrameHeader, VarintRoundTrip)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::seconds(5));
+	bool endOfStream = false;
+
+	sender.setFrameHeader(web::FrameHeader::varint);
+	receiver.setFrameHeader(web::FrameHeader::varint);
+
+	for (size_t size : { 0, 1, 127, 128, 16383, 16384, 100000 })
+	{
+		std::string data(size, static_cast<char>('a' + size % 26));
+		std::string result;
+		web::utility::ContainerWrapper wrapper(result);
+
+		std::thread writer([&sender, &data]() { bool endOfStream = false; sender.sendRawData(data.data(), static_cast<int>(data.size()), endOfStream); });
+
+		ASSERT_EQ(receiver.receiveData(wrapper, endOfStream), static_cast<int>(size));
+
+		writer.join();
+
+		ASSERT_EQ(result, data);
+	}
+}
+
+TEST(FrameHeader, Negotiation)
+{
+	using web::FrameHeader;
+
+	ASSERT_EQ(negotiate(FrameHeader::varint, FrameHeader::varint), std::make_pair(FrameHeader::varint, FrameHeader::varint));
+	ASSERT_EQ(negotiate(FrameHeader::fixed, FrameHeader::varint), std::make_pair(FrameHeader::fixed, FrameHeader::fixed));
+	ASSERT_EQ(negotiate(FrameHeader::large, FrameHeader::varint), std::make_pair(FrameHeader::large, FrameHeader::large));
+	ASSERT_EQ(negotiate(FrameHeader::fixed, FrameHeader::large), std::make_pair(FrameHeader::large, FrameHeader::large));
+}
+
+TEST(FrameHeader, NegotiationUnknownFormat)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network network(first, std::chrono::seconds(5));
+	web::Network peer(second, std::chrono::seconds(5));
+	char request[] = { 'S', 'S', 'F', 'H', 7 };
+	bool endOfStream = false;
+
+	peer.sendBytes(request, sizeof(request), endOfStream);
+
+	try
+	{
+		network.negotiateFrameHeader();
+
+		FAIL() << "Unknown format accepted";
+	}
+	catch (const web::exceptions::WebException& e)
+	{
+		ASSERT_EQ(e.getErrorCode(), EPROTO);
+	}
+}
+
+TEST(LargeFrame, ChunkedRoundTrip)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::seconds(5));
+	std::string data(300000, '\0');
+	bool endOfStream = false;
+
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		data[i] = static_cast<char>(i * 31);
+	}
+
+	sender.setFrameHeader(web::FrameHeader::large);
+	receiver.setFrameHeader(web::FrameHeader::large);
+
+	std::thread writer
+	(
+		[&sender, &data]()
+		{
+			bool endOfStream = false;
+
+			sender.sendLargeData(data.data(), static_cast<int64_t>(data.size()), endOfStream);
+
+			// Payload produced in pieces after size header
+			sender.sendFrameSize(static_cast<int64_t>(data.size()), endOfStream);
+
+			for (size_t offset = 0; offset < data.size(); offset += 65536)
+			{
+				sender.sendBytes(data.data() + offset, static_cast<int>(std::min<size_t>(65536, data.size() - offset)), endOfStream);
+			}
+
+			sender.sendRawData(data.data(), 1000, endOfStream);
+		}
+	);
+
+	{
+		std::string result;
+		size_t maxChunk = 0;
+
+		ASSERT_EQ(receiver.receiveChunkedData([&](std::string_view chunk) { result += chunk; maxChunk = std::max(maxChunk, chunk.size()); }, endOfStream, 4096), static_cast<int64_t>(data.size()));
+		ASSERT_EQ(result, data);
+		ASSERT_LE(maxChunk, 4096);
+	}
+
+	{
+		std::string result;
+
+		receiver.receiveChunkedData(std::back_inserter(result), endOfStream, 10000);
+
+		ASSERT_EQ(result, data);
+	}
+
+	{
+		std::string result;
+
+		ASSERT_EQ(receiver.receiveFrameSize(endOfStream), 1000);
+		ASSERT_EQ(receiver.receiveFrameChunks(1000, [&](std::string_view chunk) { result += chunk; }, endOfStream, 333), 1000);
+		ASSERT_EQ(result, data.substr(0, 1000));
+	}
+
+	writer.join();
+}
+
+TEST(LargeFrame, SizeLimitOfHeader)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::seconds(5));
+	int64_t size = static_cast<int64_t>(std::numeric_limits<int>::max()) + 1;
+	bool endOfStream = false;
+
+	for (web::FrameHeader header : { web::FrameHeader::fixed, web::FrameHeader::varint })
+	{
+		sender.setFrameHeader(header);
+
+		try
+		{
+			sender.sendFrameSize(size, endOfStream);
+
+			FAIL() << "Frame over 2 GiB accepted by " << static_cast<int>(header) << " header";
+		}
+		catch (const web::exceptions::WebException& e)
+		{
+			ASSERT_EQ(e.getErrorCode(), EMSGSIZE);
+		}
+	}
+
+	// 8 byte header carries sizes over 2 GiB, payload itself isn't sent
+	sender.setFrameHeader(web::FrameHeader::large);
+	receiver.setFrameHeader(web::FrameHeader::large);
+
+	sender.sendFrameSize(size, endOfStream);
+
+	ASSERT_EQ(receiver.receiveFrameSize(endOfStream), size);
+}
+
+TEST(ExactReceive, PartiallyConsumedPrefix)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::seconds(5));
+	char result[6] = {};
+	bool endOfStream = false;
+
+	receiver.addReceiveBuffer("abcdefgh");
+
+	ASSERT_EQ(receiver.receiveBytes(result, 4, endOfStream), 4);
+	ASSERT_EQ(std::string_view(result, 4), "abcd");
+
+	ASSERT_EQ(receiver.receiveBytes(result, 3, endOfStream), 3);
+	ASSERT_EQ(std::string_view(result, 3), "efg");
+
+	// Rest of prefix followed by socket data
+	sender.sendBytes("12345", 5, endOfStream);
+
+	ASSERT_EQ(receiver.receiveBytes(result, 6, endOfStream), 6);
+	ASSERT_EQ(std::string_view(result, 6), "h12345");
+}
+
+TEST(ExactReceive, SplitDelivery)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::seconds(5));
+	char result[6] = {};
+	bool endOfStream = false;
+
+	std::thread writer
+	(
+		[&sender]()
+		{
+			bool endOfStream = false;
+
+			sender.sendBytes("abc", 3, endOfStream);
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+			sender.sendBytes("def", 3, endOfStream);
+		}
+	);
+
+	ASSERT_EQ(receiver.receiveBytes(result, 6, endOfStream), 6);
+	ASSERT_EQ(std::string_view(result, 6), "abcdef");
+
+	writer.join();
+}
+
+TEST(ReceiveView, LifetimeAcrossNextReceive)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::seconds(5));
+	std::string large(64 * 1024, 'l');
+	int32_t reply = 0;
+
+	sender << std::string("first");
+	sender << large;
+	sender << std::string("third");
+
+	std::string_view view = receiver.receiveView();
+
+	ASSERT_EQ(view, "first");
+
+	// Sending doesn't touch receive buffer
+	receiver << int32_t(1);
+
+	sender >> reply;
+
+	ASSERT_EQ(reply, 1);
+	ASSERT_EQ(view, "first");
+
+	std::string_view largeView = receiver.receiveView();
+
+	ASSERT_EQ(largeView, large);
+
+	// Buffer is reused, so next receive overwrites memory of previous view
+	std::string_view thirdView = receiver.receiveView();
+
+	ASSERT_EQ(thirdView, "third");
+	ASSERT_EQ(thirdView.data(), largeView.data());
+	ASSERT_EQ(std::string_view(largeView.data(), thirdView.size()), "third");
+
+	// Closed connection returns empty view
+#ifdef __LINUX__
+	shutdown(first, SHUT_WR);
+#else
+	shutdown(first, SD_SEND);
+#endif
+
+	ASSERT_TRUE(receiver.receiveView().empty());
+	ASSERT_TRUE(receiver.eof());
+}
+
+TEST(SocketBuffer, UnreadFrameReceivedAgain)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	buffers::IOSocketBuffer buffer(std::make_unique<web::Network>(second, std::chrono::seconds(5)));
+	bool endOfStream = false;
+
+	// Dirty pooled region, so frame isn't followed by zero by chance
+	{
+		buffers::PageRegionPool& pool = buffers::PageRegionPool::get();
+		size_t size = pool.getRegionSize(1);
+		void* region = pool.allocate(size);
+
+		std::fill_n(static_cast<char*>(region), size, 'z');
+
+		pool.deallocate(region, size);
+	}
+
+	// Payload of outer frame is inner frame
+	std::string inner(sizeof(int), '\0');
+	int innerSize = 5;
+
+	std::copy_n(reinterpret_cast<const char*>(&innerSize), sizeof(innerSize), inner.data());
+
+	inner += "hello";
+
+	sender.sendRawData(inner.data(), static_cast<int>(inner.size()), endOfStream);
+	sender.sendRawData("next", 4, endOfStream);
+
+	ASSERT_EQ(buffer.sgetc(), inner.front());
+
+	char result[5] = {};
+
+	ASSERT_EQ(buffer.sgetn(result, sizeof(result)), 5);
+	ASSERT_EQ(std::string_view(result, sizeof(result)), "hello");
+	ASSERT_EQ(buffer.sgetn(result, 4), 4);
+	ASSERT_EQ(std::string_view(result, 4), "next");
+}
+
+TEST(SocketBuffer, EmbeddedNetworkReleased)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	bool endOfStream = false;
+
+	{
+		// Network lives inside buffer, destroying stream mustn't delete it separately
+		streams::IOSocketStream stream = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::seconds(5));
+		char result[5] = {};
+
+		sender.sendRawData("hello", 5, endOfStream);
+
+		stream.getNetwork().receiveRawData(result, sizeof(result), endOfStream);
+
+		ASSERT_EQ(std::string_view(result, sizeof(result)), "hello");
+	}
+
+	// Constructor failure after base is initialized
+	ASSERT_THROW(streams::IOSocketStream::createStream<web::Network>("127.0.0.1", "0"), web::exceptions::WebException);
+}
+
+TEST(ExactReceive, PrefixQueueReused)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network receiver(second, std::chrono::seconds(5));
+	bool endOfStream = false;
+
+	for (int i = 0; i < 1000; i++)
+	{
+		char result[3] = {};
+
+		receiver.addReceiveBuffer("ab");
+		receiver.addReceiveBuffer("c");
+
+		ASSERT_EQ(receiver.receiveBytes(result, 3, endOfStream), 3);
+		ASSERT_EQ(std::string_view(result, 3), "abc");
+	}
+
+	closesocket(first);
+}
+
+/// @brief Network over in memory byte queue instead of its socket
+class MemoryNetwork : public web::Network
+{
+public:
+	using web::Network::Network;
+
+	std::shared_ptr<std::string> wire = std::make_shared<std::string>();
+
+protected:
+	int sendBytesImplementation(const char* data, int size, int flags = 0) override
+	{
+		wire->append(data, size);
+
+		return size;
+	}
+
+	int receiveBytesImplementation(char* data, int size, int flags = 0) override
+	{
+		int result = (std::min)(size, static_cast<int>(wire->size()));
+
+		std::copy_n(wire->data(), result, data);
+
+		if (!(flags & MSG_PEEK))
+		{
+			wire->erase(0, result);
+		}
+
+		return result;
+	}
+};
+
+struct ScatterHeader
+{
+	uint32_t type;
+	uint32_t length;
+};
+
+TEST(ScatterReceive, HeaderAndBody)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::seconds(5));
+	ScatterHeader sentHeader = { 7, 5 };
+	std::string frame(reinterpret_cast<const char*>(&sentHeader), sizeof(sentHeader));
+	ScatterHeader header = {};
+	std::vector<char> body;
+	web::utility::ContainerWrapper wrapper(body);
+	bool endOfStream = false;
+
+	frame += "hello";
+
+	sender.sendData(frame, endOfStream);
+
+	ASSERT_EQ(receiver.receiveScatteredData(header, wrapper, endOfStream), static_cast<int>(frame.size()));
+	ASSERT_FALSE(endOfStream);
+	ASSERT_EQ(header.type, 7);
+	ASSERT_EQ(header.length, 5);
+	ASSERT_EQ(std::string_view(body.data(), body.size()), "hello");
+
+	// Frame smaller than header
+	frame = "abc";
+
+	sender.sendData(frame, endOfStream);
+
+	try
+	{
+		receiver.receiveScatteredData(header, wrapper, endOfStream);
+
+		FAIL() << "Frame smaller than header accepted";
+	}
+	catch (const web::exceptions::WebException& e)
+	{
+		ASSERT_EQ(e.getErrorCode(), EBADMSG);
+	}
+}
+
+TEST(ScatterReceive, OverriddenReceiveBytes)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	MemoryNetwork sender(first, std::chrono::seconds(5));
+	MemoryNetwork receiver(second, std::chrono::seconds(5));
+	ScatterHeader sentHeader = { 3, 4096 };
+	std::string frame(reinterpret_cast<const char*>(&sentHeader), sizeof(sentHeader));
+	ScatterHeader header = {};
+	std::string body;
+	web::utility::ContainerWrapper wrapper(body);
+	bool endOfStream = false;
+
+	frame.append(4096, 'x');
+
+	sender.sendData(frame, endOfStream);
+
+	// Frame is only in memory, receive from socket would time out
+	receiver.wire = sender.wire;
+
+	ASSERT_EQ(receiver.receiveScatteredData(header, wrapper, endOfStream), static_cast<int>(frame.size()));
+	ASSERT_EQ(header.type, 3);
+	ASSERT_EQ(header.length, 4096);
+	ASSERT_EQ(body, std::string(4096, 'x'));
+	ASSERT_TRUE(receiver.wire->empty());
+}
+
+TEST(Array, ShortFrameIntoSpan)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<LenientNetwork>(second, std::chrono::seconds(5));
+	std::array<int32_t, 4> values = {};
+	std::array<int32_t, 2> shortValues = { 1, 2 };
+
+	sender << std::span<const int32_t>(shortValues);
+	sender << std::span<const int32_t>(values);
+
+	try
+	{
+		receiver >> std::span<int32_t>(values);
+
+		FAIL() << "Short frame accepted";
+	}
+	catch (const web::exceptions::WebException& e)
+	{
+		ASSERT_EQ(e.getErrorCode(), EBADMSG);
+		ASSERT_TRUE(receiver.fail());
+	}
+
+	// Next frame is still readable
+	receiver.clear();
+
+	values.fill(7);
+
+	receiver >> std::span<int32_t>(values);
+
+	ASSERT_EQ(values, (std::array<int32_t, 4>{}));
+}
+
+TEST(Array, MismatchedFrameSkipped)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::seconds(5));
+	std::array<int32_t, 2> shortValues = { 1, 2 };
+	std::array<int32_t, 6> longValues = { 1, 2, 3, 4, 5, 6 };
+	std::array<int32_t, 4> expected = { 7, 8, 9, 10 };
+	std::array<int32_t, 4> values = {};
+	std::vector<int32_t> vectorValues;
+
+	sender << std::span<const int32_t>(shortValues);
+	sender << std::span<const int32_t>(longValues);
+	sender << std::string("12345");
+	sender << std::span<const int32_t>(expected);
+
+	auto expectBadMessage = [&receiver](const std::function<void()>& receive)
+		{
+			try
+			{
+				receive();
+
+				FAIL() << "Mismatched frame accepted";
+			}
+			catch (const web::exceptions::WebException& e)
+			{
+				ASSERT_EQ(e.getErrorCode(), EBADMSG);
+			}
+
+			receiver.clear();
+		};
+
+	expectBadMessage([&]() { receiver >> std::span<int32_t>(values); });
+	expectBadMessage([&]() { receiver >> std::span<int32_t>(values); });
+	expectBadMessage([&]() { receiver >> vectorValues; });
+
+	// Payloads of rejected frames were consumed
+	receiver >> std::span<int32_t>(values);
+
+	ASSERT_EQ(values, expected);
+}
+
+TEST(Array, BigEndianWire)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::seconds(5));
+	std::vector<uint32_t> values = { 0x01020304, 0x05060708 };
+	std::vector<uint32_t> fromVector;
+	std::array<uint32_t, 2> fromSpan = {};
+	std::string wire;
+
+	sender.sendArray<std::endian::big>(values);
+	sender.sendArray<std::endian::big>(values);
+	sender.sendArray<std::endian::big>(std::span<const uint32_t>(values));
+
+	receiver >> wire;
+
+	ASSERT_EQ(wire, std::string("\x01\x02\x03\x04\x05\x06\x07\x08", 8));
+
+	receiver.receiveArray<std::endian::big>(fromVector);
+
+	ASSERT_EQ(fromVector, values);
+
+	receiver.receiveArray<std::endian::big>(std::span<uint32_t>(fromSpan));
+
+	ASSERT_TRUE(std::ranges::equal(fromSpan, values));
+
+	// Sent values aren't converted in place
+	ASSERT_EQ(values[0], 0x01020304u);
+}
+
+TEST(ByteOrder, Swap)
+{
+	for (size_t elementSize : { 1, 2, 4, 8 })
+	{
+		// Odd count covers tail after vector blocks
+		std::vector<uint8_t> source(elementSize * 37);
+		std::vector<uint8_t> swapped(source.size());
+		std::vector<uint8_t> expected(source.size());
+
+		for (size_t i = 0; i < source.size(); i++)
+		{
+			source[i] = static_cast<uint8_t>(i);
+		}
+
+		for (size_t i = 0; i < source.size(); i += elementSize)
+		{
+			std::reverse_copy(source.begin() + i, source.begin() + i + elementSize, expected.begin() + i);
+		}
+
+		web::utility::byteSwap(source.data(), swapped.data(), 37, elementSize);
+
+		ASSERT_EQ(swapped, expected) << web::utility::getByteSwapImplementation() << ' ' << elementSize;
+
+		web::utility::byteSwapSoftware(source.data(), swapped.data(), 37, elementSize);
+
+		ASSERT_EQ(swapped, expected) << "software " << elementSize;
+
+		web::utility::byteSwap(source.data(), source.data(), 37, elementSize);
+
+		ASSERT_EQ(source, expected) << "in place " << elementSize;
+	}
+
+	std::array<uint16_t, 1> value = { 0x0102 };
+
+	web::utility::convertByteOrder<std::endian::native>(std::span<uint16_t>(value));
+
+	ASSERT_EQ(value[0], 0x0102);
+}
+
+TEST(Record, ShortFrame)
+{
+	struct Packed
+	{
+		int32_t first;
+		int32_t second;
+	};
+
+	struct Padded
+	{
+		int32_t first;
+		double second;
+	};
+
+	static_assert(web::utility::hasPackedLayout<Packed>);
+	static_assert(!web::utility::hasPackedLayout<Padded>);
+
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<LenientNetwork>(second, std::chrono::seconds(5));
+	int32_t shortRecord = 1;
+	Packed packed = {};
+	Padded padded = {};
+
+	sender << std::span<const int32_t>(&shortRecord, 1);
+	sender << std::span<const int32_t>(&shortRecord, 1);
+	sender << Padded{ 2, 3.5 };
+
+	for (auto receive : { std::function<void()>([&]() { receiver >> packed; }), std::function<void()>([&]() { receiver >> padded; }) })
+	{
+		try
+		{
+			receive();
+
+			FAIL() << "Short frame accepted";
+		}
+		catch (const web::exceptions::WebException& e)
+		{
+			ASSERT_EQ(e.getErrorCode(), EBADMSG);
+			ASSERT_TRUE(receiver.fail());
+		}
+
+		receiver.clear();
+	}
+
+	receiver >> padded;
+
+	ASSERT_EQ(padded.first, 2);
+	ASSERT_EQ(padded.second, 3.5);
+}
+
+TEST(FixedFrame, BatchReceive)
+{
+	struct Quote
+	{
+		uint32_t id;
+		uint32_t size;
+		double price;
+	};
+
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network senderNetwork(first, std::chrono::seconds(5));
+	web::Network receiverNetwork(second, std::chrono::seconds(5));
+	web::FixedFrameChannel<Quote> sender(senderNetwork);
+	web::FixedFrameChannel<Quote> receiver(receiverNetwork);
+	std::vector<Quote> quotes(1000);
+	std::vector<Quote> received(quotes.size() - 1);
+	Quote single = {};
+	bool endOfStream = false;
+
+	for (size_t i = 0; i < quotes.size(); i++)
+	{
+		quotes[i] = { static_cast<uint32_t>(i), static_cast<uint32_t>(i * 10), i * 0.5 };
+	}
+
+	// Batch on one side and single messages on other side use same wire format
+	ASSERT_EQ(sender.send(std::span<const Quote>(quotes), endOfStream), static_cast<int64_t>(quotes.size() * sizeof(Quote)));
+
+	ASSERT_EQ(receiver.receive(single, endOfStream), static_cast<int>(sizeof(Quote)));
+	ASSERT_EQ(single.id, 0);
+
+	ASSERT_EQ(receiver.receive(std::span<Quote>(received), endOfStream), static_cast<int64_t>(received.size() * sizeof(Quote)));
+	ASSERT_FALSE(endOfStream);
+
+	for (size_t i = 0; i < received.size(); i++)
+	{
+		ASSERT_EQ(received[i].id, i + 1);
+		ASSERT_EQ(received[i].size, (i + 1) * 10);
+		ASSERT_EQ(received[i].price, (i + 1) * 0.5);
+	}
+
+	for (size_t i = 0; i < 3; i++)
+	{
+		sender.send(quotes[i], endOfStream);
+	}
+
+	received.resize(3);
+
+	ASSERT_EQ(receiver.receive(std::span<Quote>(received), endOfStream), static_cast<int64_t>(3 * sizeof(Quote)));
+	ASSERT_EQ(received[2].id, 2);
+
+#ifdef __LINUX__
+	shutdown(first, SHUT_WR);
+#else
+	shutdown(first, SD_SEND);
+#endif
+
+	receiver.receive(std::span<Quote>(received), endOfStream);
+
+	ASSERT_TRUE(endOfStream);
+}
+
+TEST(Varint, Zigzag)
+{
+	constexpr std::array<std::pair<int64_t, uint64_t>, 7> expected =
+	{
+		std::pair<int64_t, uint64_t>{ 0, 0 },
+		{ -1, 1 },
+		{ 1, 2 },
+		{ -2, 3 },
+		{ 63, 126 },
+		{ -64, 127 },
+		{ (std::numeric_limits<int64_t>::min)(), (std::numeric_limits<uint64_t>::max)() }
+	};
+
+	for (auto [value, encoded] : expected)
+	{
+		ASSERT_EQ(web::utility::encodeZigzag(value), encoded);
+		ASSERT_EQ(web::utility::decodeZigzag(encoded), value);
+	}
+
+	ASSERT_EQ(web::utility::decodeZigzag(web::utility::encodeZigzag((std::numeric_limits<int64_t>::max)())), (std::numeric_limits<int64_t>::max)());
+
+	// Narrow signed types sign extend before zigzag, so they have same wire value as int64_t
+	ASSERT_EQ(web::utility::toVarint<int8_t>(-64), 127);
+	ASSERT_EQ(web::utility::fromVarint<int8_t>(127), -64);
+	ASSERT_EQ(web::utility::toVarint<uint8_t>(255), 255);
+}
+
+TEST(Varint, EncodedSize)
+{
+	constexpr std::array<std::pair<uint64_t, size_t>, 6> expected =
+	{
+		std::pair<uint64_t, size_t>{ 0, 1 },
+		{ 127, 1 },
+		{ 128, 2 },
+		{ 16383, 2 },
+		{ 16384, 3 },
+		{ (std::numeric_limits<uint64_t>::max)(), web::utility::maxVarint64Size }
+	};
+
+	for (auto [value, size] : expected)
+	{
+		char data[web::utility::maxVarint64Size] = {};
+		uint64_t decoded = 0;
+
+		ASSERT_EQ(web::utility::encodeVarint(value, data), size);
+		ASSERT_EQ(web::utility::decodeVarint(data, size, decoded), size);
+		ASSERT_EQ(decoded, value);
+
+		// Incomplete value
+		ASSERT_EQ(web::utility::decodeVarint(data, size - 1, decoded), 0);
+	}
+}
+
+TEST(Varint, BatchRoundTrip)
+{
+	std::vector<int64_t> values;
+
+	// Full groups of single byte values, then mixed sizes and tail shorter than group
+	for (int64_t i = -32; i < 32; i++)
+	{
+		values.push_back(i);
+	}
+
+	for (int shift = 0; shift < 63; shift += 5)
+	{
+		values.push_back(int64_t(1) << shift);
+		values.push_back(-(int64_t(1) << shift));
+	}
+
+	values.push_back((std::numeric_limits<int64_t>::min)());
+	values.push_back((std::numeric_limits<int64_t>::max)());
+	values.push_back(5);
+
+	std::string encoded(values.size() * web::utility::maxVarint64Size, '\0');
+
+	encoded.resize(web::utility::encodeVarints(std::span<const int64_t>(values), encoded.data()));
+
+	std::vector<int64_t> decoded(web::utility::countVarints(encoded.data(), encoded.size()));
+
+	ASSERT_EQ(decoded.size(), values.size());
+	ASSERT_EQ(web::utility::decodeVarints(encoded.data(), encoded.size(), std::span<int64_t>(decoded)), encoded.size());
+	ASSERT_EQ(decoded, values);
+
+	// Last value cut off
+	ASSERT_EQ(web::utility::decodeVarints(encoded.data(), encoded.size() - 1, std::span<int64_t>(decoded)), 0);
+}
+
+TEST(Varint, Stream)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::seconds(5));
+	int64_t negative = 0;
+	uint32_t positive = 0;
+	int16_t narrow = 0;
+	std::vector<int32_t> values;
+
+	sender.setIntegerEncoding(streams::IntegerEncoding::varint);
+	receiver.setIntegerEncoding(streams::IntegerEncoding::varint);
+
+	sender << int64_t(-1);
+	sender << uint32_t(300);
+	sender << int16_t(-64);
+	sender.sendVarints(std::vector<int32_t>{ 0, -1, 1, (std::numeric_limits<int32_t>::min)(), (std::numeric_limits<int32_t>::max)() });
+	sender << std::string("\x80\x80");
+
+	receiver >> negative;
+	receiver >> positive;
+	receiver >> narrow;
+
+	ASSERT_EQ(negative, -1);
+	ASSERT_EQ(positive, 300);
+	ASSERT_EQ(narrow, -64);
+
+	receiver.receiveVarints(values);
+
+	ASSERT_EQ(values, (std::vector<int32_t>{ 0, -1, 1, (std::numeric_limits<int32_t>::min)(), (std::numeric_limits<int32_t>::max)() }));
+
+	try
+	{
+		receiver.receiveVarints(values);
+
+		FAIL() << "Malformed varint frame accepted";
+	}
+	catch (const web::exceptions::WebException& e)
+	{
+		ASSERT_EQ(e.getErrorCode(), EBADMSG);
+	}
+}
+
+TEST(Record, MismatchedFrameSkipped)
+{
+	struct Quote
+	{
+		int32_t id;
+		double price;
+	};
+
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::seconds(5));
+	Quote quote = {};
+
+	sender << std::string("short");
+	sender << std::string(64, 'x');
+	sender << Quote{ 42, 1.25 };
+
+	for (int i = 0; i < 2; i++)
+	{
+		try
+		{
+			receiver >> quote;
+
+			FAIL() << "Mismatched frame accepted";
+		}
+		catch (const web::exceptions::WebException& e)
+		{
+			ASSERT_EQ(e.getErrorCode(), EBADMSG);
+		}
+
+		receiver.clear();
+	}
+
+	receiver >> quote;
+
+	ASSERT_EQ(quote.id, 42);
+	ASSERT_EQ(quote.price, 1.25);
+}
+
+TEST(PageRegionPool, DeallocateAfterThreadCacheDestroyed)
+{
+	struct LateRelease
+	{
+		void* region = nullptr;
+		size_t size = 0;
+
+		~LateRelease()
+		{
+			if (region)
+			{
+				buffers::PageRegionPool::get().deallocate(region, size);
+			}
+		}
+	};
+
+	buffers::PageRegionPool& pool = buffers::PageRegionPool::get();
+	uint64_t usedBytes = pool.getStatistics().usedBytes;
+
+	std::thread
+	(
+		[&pool]()
+		{
+			// Constructed before thread cache, so destroyed after it
+			thread_local LateRelease late;
+
+			late.size = pool.getRegionSize(1);
+			late.region = pool.allocate(late.size);
+		}
+	).join();
+
+	ASSERT_EQ(pool.getStatistics().usedBytes, usedBytes);
+}
+
+TEST(PageRegionPool, HugePageRegions)
+{
+	buffers::PageRegionPool& pool = buffers::PageRegionPool::get();
+	size_t hugePageSize = pool.getHugePageSize();
+	size_t hugePageThreshold = pool.getHugePageThreshold();
+	bool prefault = pool.getPrefault();
+	uint64_t usedBytes = pool.getStatistics().usedBytes;
+
+	if (!hugePageSize)
+	{
+		GTEST_SKIP() << "System doesn't support huge pages";
+	}
+
+	pool.setHugePageThreshold(hugePageSize);
+
+	ASSERT_EQ(pool.getHugePageThreshold(), hugePageSize);
+	ASSERT_EQ(pool.getRegionSize(hugePageSize + 1), 2 * hugePageSize);
+	ASSERT_EQ(pool.getRegionSize(hugePageSize - 1) % pool.getPageSize(), 0U);
+	ASSERT_LE(pool.getRegionSize(hugePageSize - 1), hugePageSize);
+
+	for (bool prefaultRegion : { false, true })
+	{
+		size_t size = pool.getRegionSize(hugePageSize + 1);
+		uint64_t hugePageRegions = pool.getStatistics().hugePageRegions;
+
+		pool.setPrefault(prefaultRegion);
+
+		char* region = static_cast<char*>(pool.allocate(size));
+
+		// Without reserved or transparent huge pages region is still mapped with regular pages and isn't counted
+		ASSERT_NE(region, nullptr);
+		ASSERT_LE(pool.getStatistics().hugePageRegions - hugePageRegions, 1U);
+		ASSERT_EQ(pool.getStatistics().usedBytes, usedBytes + size);
+		ASSERT_EQ(region[0], 0);
+		ASSERT_EQ(region[size - 1], 0);
+
+		region[0] = 'g';
+		region[size - 1] = 'g';
+
+		pool.deallocate(region, size);
+	}
+
+	// Disabled huge pages
+	{
+		pool.setHugePageThreshold(0);
+
+		size_t size = pool.getRegionSize(2 * hugePageSize + 1);
+		uint64_t hugePageRegions = pool.getStatistics().hugePageRegions;
+		char* region = static_cast<char*>(pool.allocate(size));
+
+		ASSERT_EQ(size % pool.getPageSize(), 0U);
+		ASSERT_EQ(pool.getStatistics().hugePageRegions, hugePageRegions);
+
+		region[size - 1] = 'g';
+
+		pool.deallocate(region, size);
+	}
+
+	pool.setHugePageThreshold(hugePageThreshold);
+	pool.setPrefault(prefault);
+
+	ASSERT_EQ(pool.getStatistics().usedBytes, usedBytes);
+}
+
+TEST(SocketBuffer, ReclaimAfterFrameConsumed)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::seconds(5));
+	size_t keepSize = buffers::PageRegionPool::get().getRegionSize(4096);
+	std::string frame(256 * 1024, 'a');
+	std::string text;
+
+	receiver.setBufferReclamation(keepSize, std::chrono::seconds(0));
+
+	sender << frame;
+
+	text += static_cast<char>(receiver.get());
+
+	ASSERT_GT(receiver.getBufferSize(), frame.size());
+
+	// Frame with terminating zero, then end of frame
+	for (int character = receiver.get(); character != std::char_traits<char>::eof(); character = receiver.get())
+	{
+		text += static_cast<char>(character);
+	}
+
+	ASSERT_EQ(text, frame + '\0');
+	ASSERT_EQ(receiver.getBufferSize(), keepSize);
+
+	receiver.clear();
+
+	sender << std::string("next");
+
+	ASSERT_EQ(receiver.receiveView(), "next");
+}
+
+TEST(SocketBuffer, ReclaimFromTimer)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::seconds(5));
+	size_t keepSize = buffers::PageRegionPool::get().getRegionSize(4096);
+	std::string frame(256 * 1024, 'a');
+
+	ASSERT_FALSE(receiver.reclaimBuffer());
+
+	receiver.setBufferReclamation(keepSize, std::chrono::hours(1));
+
+	sender << frame;
+
+	ASSERT_EQ(receiver.receiveView(), frame);
+
+	// Large frame was received less than period ago
+	ASSERT_FALSE(receiver.reclaimBuffer());
+	ASSERT_GE(receiver.getBufferSize(), frame.size());
+
+	receiver.setBufferReclamation(keepSize, std::chrono::seconds(0));
+
+	ASSERT_TRUE(receiver.reclaimBuffer());
+	ASSERT_EQ(receiver.getBufferSize(), keepSize);
+	ASSERT_FALSE(receiver.reclaimBuffer());
+}
+
+TEST(PageRegionPool, UsedBytesBudget)
+{
+	buffers::PageRegionPool& pool = buffers::PageRegionPool::get();
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::seconds(5));
+	size_t maxUsedBytes = pool.getMaxUsedBytes();
+	int errorCode = 0;
+
+	sender << std::string(1024 * 1024, 'b');
+
+	pool.setMaxUsedBytes(pool.getStatistics().usedBytes + pool.getRegionSize(64 * 1024));
+
+	try
+	{
+		receiver.receiveView();
+	}
+	catch (const web::exceptions::WebException& e)
+	{
+		errorCode = e.getErrorCode();
+	}
+
+	pool.setMaxUsedBytes(maxUsedBytes);
+
+	ASSERT_EQ(errorCode, ENOBUFS);
+	// Buffer isn't grown over budget
+	ASSERT_LT(receiver.getBufferSize(), 64 * 1024);
+}
+
+TEST(TcpInfo, Loopback)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::seconds(5));
+	std::string frame(64 * 1024, 'c');
+
+	sender << frame;
+
+	ASSERT_EQ(receiver.receiveView(), frame);
+
+	web::utility::TcpInfo senderInfo = sender.getTcpInfo();
+	web::utility::TcpInfo receiverInfo = receiver.getTcpInfo();
+
+	ASSERT_GT(senderInfo.rtt.count(), 0);
+	ASSERT_GT(senderInfo.congestionWindow, 0U);
+	ASSERT_GT(senderInfo.mss, 0U);
+	ASSERT_GE(senderInfo.bytesSent, frame.size());
+	ASSERT_GE(receiverInfo.bytesReceived, frame.size());
+}
+
+TEST(TcpInfo, Sampler)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::utility::TcpInfoSampler sampler;
+	std::vector<web::utility::TcpInfo> connections;
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::seconds(5));
+
+	{
+		streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+
+		sampler.add(sender.getNetwork());
+		sampler.add(receiver.getNetwork());
+
+		sender << std::string("sample");
+
+		ASSERT_EQ(receiver.receiveView(), "sample");
+
+		web::utility::TcpInfoAggregate aggregate = sampler.sample(&connections);
+
+		ASSERT_EQ(aggregate.connections, 2U);
+		ASSERT_EQ(connections.size(), 2U);
+		ASSERT_GT(aggregate.rttMax.count(), 0);
+		ASSERT_GE(aggregate.rttMax, aggregate.rttP50);
+		ASSERT_GT(aggregate.congestionWindowMin, 0U);
+		ASSERT_GE(aggregate.congestionWindowMean, aggregate.congestionWindowMin);
+	}
+
+	// Closed sender removed
+	ASSERT_EQ(sampler.size(), 1U);
+	ASSERT_EQ(sampler.sample().connections, 1U);
+}
+
+TEST(Statistics, PrometheusSnapshot)
+{
+	web::utility::NetworkStatisticsSnapshot snapshot;
+	web::utility::NetworkStatisticsSnapshot other;
+
+	snapshot.bytesSent = 100;
+	snapshot.sendCalls = 2;
+	snapshot.partialSends = 1;
+	snapshot.sendLatency.buckets[web::utility::LatencyHistogramSnapshot::getIndex(1000)] = 1;
+	snapshot.sendLatency.count = 1;
+	snapshot.sendLatency.sum = 1000;
+
+	other.bytesSent = 20;
+	other.sendCalls = 1;
+
+	snapshot += other;
+
+	std::string text = snapshot.toPrometheus("test", "connection=\"1\"");
+
+	ASSERT_NE(text.find("# HELP test_sent_bytes_total Bytes sent\n# TYPE test_sent_bytes_total counter\ntest_sent_bytes_total{connection=\"1\"} 120\n"), std::string::npos);
+	ASSERT_NE(text.find("test_send_calls_total{connection=\"1\"} 3\n"), std::string::npos);
+	ASSERT_NE(text.find("test_partial_sends_total{connection=\"1\"} 1\n"), std::string::npos);
+	ASSERT_NE(text.find("test_errors_total{connection=\"1\"} 0\n"), std::string::npos);
+	ASSERT_NE(text.find("# TYPE test_send_duration_seconds histogram\n"), std::string::npos);
+	// 1000 nanoseconds in [512, 1024) bucket, buckets are cumulative
+	ASSERT_NE(text.find("test_send_duration_seconds_bucket{connection=\"1\",le=\"0.000000512\"} 0\n"), std::string::npos);
+	ASSERT_NE(text.find("test_send_duration_seconds_bucket{connection=\"1\",le=\"0.000001024\"} 1\n"), std::string::npos);
+	ASSERT_NE(text.find("test_send_duration_seconds_bucket{connection=\"1\",le=\"+Inf\"} 1\n"), std::string::npos);
+	ASSERT_NE(text.find("test_send_duration_seconds_sum{connection=\"1\"} 0.000001000\n"), std::string::npos);
+	ASSERT_NE(text.find("test_send_duration_seconds_count{connection=\"1\"} 1\n"), std::string::npos);
+	ASSERT_NE(text.find("test_receive_duration_seconds_count{connection=\"1\"} 0\n"), std::string::npos);
+
+	ASSERT_NE(web::utility::NetworkStatisticsSnapshot().toPrometheus().find("socket_streams_received_bytes_total 0\n"), std::string::npos);
+}
+
+TEST(Statistics, Counters)
+{
+	web::utility::NetworkStatistics statistics;
+
+	statistics.recordSend(60, 100, 0);
+	statistics.recordSend(40, 40, 0);
+	statistics.recordReceive(0, 0);
+	statistics.recordReceive(100, 0);
+	statistics.recordSendLatency(web::utility::NetworkStatistics::clock::now());
+
+	web::utility::NetworkStatisticsSnapshot snapshot = statistics.getSnapshot();
+
+	ASSERT_EQ(snapshot.bytesSent, 100U);
+	ASSERT_EQ(snapshot.sendCalls, 2U);
+	ASSERT_EQ(snapshot.partialSends, 1U);
+	ASSERT_EQ(snapshot.bytesReceived, 100U);
+	ASSERT_EQ(snapshot.receiveCalls, 2U);
+	ASSERT_EQ(snapshot.errors, 0U);
+	ASSERT_EQ(snapshot.sendLatency.count, 1U);
+	ASSERT_EQ(snapshot.receiveLatency.count, 0U);
+
+	statistics.reset();
+
+	ASSERT_EQ(statistics.getSnapshot().bytesSent, 0U);
+}
+
+TEST(Statistics, Connection)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	streams::IOSocketStream sender = streams::IOSocketStream::createStream<web::Network>(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::seconds(5));
+	std::string frame(1024, 'd');
+
+	// Library built without SOCKET_STREAMS_STATISTICS doesn't collect anything
+	bool enabled = sender.getNetwork().enableStatistics();
+
+	ASSERT_EQ(receiver.getNetwork().enableStatistics(), enabled);
+	ASSERT_EQ(sender.getNetwork().isStatisticsEnabled(), enabled);
+
+	sender << frame;
+
+	ASSERT_EQ(receiver.receiveView(), frame);
+
+	web::utility::NetworkStatisticsSnapshot sent = sender.getStatistics();
+	web::utility::NetworkStatisticsSnapshot received = receiver.getStatistics();
+
+	if (enabled)
+	{
+		ASSERT_GE(sent.bytesSent, frame.size());
+		ASSERT_GE(sent.sendCalls, 1U);
+		ASSERT_GE(sent.sendLatency.count, 1U);
+		ASSERT_EQ(received.bytesReceived, sent.bytesSent);
+		ASSERT_GE(received.receiveLatency.count, 1U);
+	}
+	else
+	{
+		ASSERT_EQ(sent.bytesSent, 0U);
+		ASSERT_EQ(received.bytesReceived, 0U);
+	}
+
+	sender.getNetwork().enableStatistics(false);
+
+	ASSERT_FALSE(sender.getNetwork().isStatisticsEnabled());
+}
+
+#ifdef __LINUX__
+TEST(Timestamping, ReceiveAndSend)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::seconds(5));
+	std::string payload(4096, 'e');
+	std::string result;
+	web::utility::ContainerWrapper payloadWrapper(payload);
+	web::utility::ContainerWrapper resultWrapper(result);
+	std::vector<web::utility::SendTimestamps> sent;
+	bool endOfStream = false;
+
+	ASSERT_TRUE(sender.enableTimestamping());
+	ASSERT_TRUE(receiver.enableTimestamping());
+	ASSERT_TRUE(receiver.isTimestampingEnabled());
+	ASSERT_FALSE(receiver.getReceiveTimestamps());
+
+	std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
+	std::optional<web::utility::ReceiveTimestamps> received;
+	size_t frames = 0;
+
+	// Kernel turns on receive timestamps of first timestamping socket asynchronously, so first packets may have none
+	for (; frames < 100 && !(received && received->kernel); frames++)
+	{
+		if (frames)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		result.clear();
+
+		ASSERT_EQ(sender.sendData(payloadWrapper, endOfStream), static_cast<int>(payload.size()));
+		ASSERT_EQ(receiver.receiveData(resultWrapper, endOfStream), static_cast<int>(payload.size()));
+		ASSERT_EQ(result, payload);
+
+		received = receiver.getReceiveTimestamps();
+
+		ASSERT_TRUE(received);
+	}
+
+	ASSERT_TRUE(received->kernel);
+	ASSERT_LE(*received->kernel, received->user);
+	ASSERT_GE(received->user, start);
+	ASSERT_GE(received->getQueueingDelay().count(), 0);
+
+	// Acknowledge timestamps arrive asynchronously in error queue
+	for (int i = 0; i < 100 && sent.size() < frames; i++)
+	{
+		std::vector<web::utility::SendTimestamps> acknowledged = sender.getSendTimestamps();
+
+		if (acknowledged.empty())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		sent.insert(sent.end(), acknowledged.begin(), acknowledged.end());
+	}
+
+	ASSERT_EQ(sent.size(), frames);
+
+	for (const web::utility::SendTimestamps& frame : sent)
+	{
+		ASSERT_EQ(frame.size, static_cast<int64_t>(payload.size()));
+		ASSERT_GE(frame.user, start);
+		ASSERT_TRUE(frame.software);
+		ASSERT_TRUE(frame.acknowledged);
+		ASSERT_LE(frame.user, *frame.acknowledged);
+	}
+
+	ASSERT_TRUE(sender.getSendTimestamps().empty());
+
+	ASSERT_TRUE(receiver.enableTimestamping(false));
+	ASSERT_FALSE(receiver.isTimestampingEnabled());
+	ASSERT_FALSE(receiver.getReceiveTimestamps());
+}
+#endif // __LINUX__
+
+TEST(BusyPoll, RoundTrip)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::seconds(5));
+	std::string small = "busy poll";
+	std::string large(1024 * 1024, 'f');
+	bool endOfStream = false;
+
+	ASSERT_EQ(receiver.getBusyPoll().count(), 0);
+
+	receiver.setBusyPoll(std::chrono::microseconds(-1));
+
+	ASSERT_EQ(receiver.getBusyPoll().count(), 0);
+
+	receiver.setBusyPoll(std::chrono::milliseconds(50));
+
+	ASSERT_EQ(receiver.getBusyPoll(), std::chrono::milliseconds(50));
+
+	std::thread thread
+	(
+		[&sender, &small, &large]()
+		{
+			bool endOfStream = false;
+			web::utility::ContainerWrapper smallWrapper(small);
+			web::utility::ContainerWrapper largeWrapper(large);
+
+			// Arrives while receiver spins
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+			sender.sendData(smallWrapper, endOfStream);
+
+			// Arrives after spin time, receiver falls back to blocking receive
+			std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+			sender.sendData(largeWrapper, endOfStream);
+		}
+	);
+
+	std::string result;
+	web::utility::ContainerWrapper wrapper(result);
+
+	ASSERT_EQ(receiver.receiveData(wrapper, endOfStream), static_cast<int>(small.size()));
+	ASSERT_EQ(result, small);
+
+	result.clear();
+
+	// Large frame is received in many non blocking parts
+	ASSERT_EQ(receiver.receiveData(wrapper, endOfStream), static_cast<int>(large.size()));
+	ASSERT_EQ(result, large);
+
+	thread.join();
+
+	receiver.setBusyPoll(std::chrono::microseconds(0));
+
+	ASSERT_EQ(receiver.getBusyPoll().count(), 0);
+}
+
+#ifdef __LINUX__
+TEST(BusyPoll, KernelBusyPoll)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::seconds(5));
+	std::string payload = "kernel busy poll";
+	std::string result;
+	web::utility::ContainerWrapper payloadWrapper(payload);
+	web::utility::ContainerWrapper resultWrapper(result);
+	bool endOfStream = false;
+
+	try
+	{
+		receiver.setBusyPoll(std::chrono::microseconds(50), true);
+
+		ASSERT_EQ(receiver.getBusyPoll().count(), 50);
+	}
+	catch (const web::exceptions::WebException& e)
+	{
+		// Values above net.core.busy_read require CAP_NET_ADMIN
+		ASSERT_EQ(e.getErrorCode(), EPERM);
+		ASSERT_EQ(receiver.getBusyPoll().count(), 0);
+	}
+
+	sender.sendData(payloadWrapper, endOfStream);
+
+	ASSERT_EQ(receiver.receiveData(resultWrapper, endOfStream), static_cast<int>(payload.size()));
+	ASSERT_EQ(result, payload);
+}
+#endif // __LINUX__
+
+TEST(FrameSize, NegativeHeader)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::seconds(5));
+	std::string result;
+	web::utility::ContainerWrapper wrapper(result);
+	int size = -1;
+	bool endOfStream = false;
+
+	sender.sendBytes(&size, sizeof(size), endOfStream);
+
+	try
+	{
+		receiver.receiveData(wrapper, endOfStream);
+
+		FAIL() << "Negative frame size accepted";
+	}
+	catch (const web::exceptions::WebException& e)
+	{
+		ASSERT_EQ(e.getErrorCode(), EBADMSG);
+		ASSERT_TRUE(result.empty());
+	}
+}
+
+TEST(FrameSize, OversizedFrameSkipped)
+{
+	for (web::FrameHeader header : { web::FrameHeader::fixed, web::FrameHeader::varint })
+	{
+		auto [first, second] = createLoopbackPair(SOCK_STREAM);
+		web::Network sender(first, std::chrono::seconds(5));
+		web::Network receiver(second, std::chrono::seconds(5));
+		std::string large(200000, 'l');
+		std::string small = "small";
+		bool endOfStream = false;
+
+		sender.setFrameHeader(header);
+		receiver.setFrameHeader(header);
+		receiver.setMaxFrameSize(1000);
+
+		std::thread writer
+		(
+			[&]()
+			{
+				bool endOfStream = false;
+
+				sender.sendRawData(large.data(), static_cast<int>(large.size()), endOfStream);
+				sender.sendRawData(small.data(), static_cast<int>(small.size()), endOfStream);
+			}
+		);
+
+		std::string result;
+		web::utility::ContainerWrapper wrapper(result);
+
+		try
+		{
+			receiver.receiveData(wrapper, endOfStream);
+
+			FAIL() << "Oversized frame accepted";
+		}
+		catch (const web::exceptions::WebException& e)
+		{
+			ASSERT_EQ(e.getErrorCode(), EMSGSIZE);
+			ASSERT_TRUE(result.empty());
+		}
+
+		ASSERT_EQ(receiver.receiveData(wrapper, endOfStream), static_cast<int>(small.size()));
+		ASSERT_EQ(result, small);
+
+		writer.join();
+	}
+}
+
+TEST(ExactReceive, PartialTimeoutKept)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::milliseconds(100));
+	bool endOfStream = false;
+	char result[4] = {};
+
+	sender.sendBytes("ab", 2, endOfStream);
+
+	ASSERT_THROW(receiver.receiveBytes(result, 4, endOfStream), web::exceptions::WebException);
+
+	sender.sendBytes("cd", 2, endOfStream);
+
+	ASSERT_EQ(receiver.receiveBytes(result, 4, endOfStream), 4);
+	ASSERT_EQ(std::string_view(result, 4), "abcd");
+}
+
+TEST(TryReceive, RetryAfterPartialTimeout)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::milliseconds(100));
+	web::NetworkError error = {};
+	bool endOfStream = false;
+	int32_t value = 0x01020304;
+	int32_t result = 0;
+
+	sender.sendBytes(reinterpret_cast<const char*>(&value), 2, endOfStream);
+
+	ASSERT_EQ(receiver.tryReceiveBytes(&result, sizeof(result), endOfStream, error), SOCKET_ERROR);
+	ASSERT_TRUE(error.isTimeout());
+
+	sender.sendBytes(reinterpret_cast<const char*>(&value) + 2, 2, endOfStream);
+
+	ASSERT_EQ(receiver.tryReceiveBytes(&result, sizeof(result), endOfStream, error), sizeof(result));
+	ASSERT_EQ(result, value);
+}
+
+TEST(TryReceive, VarintRetryAfterPartialTimeout)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::milliseconds(100));
+	web::NetworkError error = {};
+	bool endOfStream = false;
+	char encoded[web::utility::maxVarint64Size] = {};
+	size_t size = web::utility::encodeVarint(web::utility::toVarint(-1000), encoded);
+	int result = 0;
+
+	ASSERT_GT(size, 1);
+
+	receiver.setIntegerEncoding(streams::IntegerEncoding::varint);
+
+	sender.sendBytes(encoded, 1, endOfStream);
+
+	ASSERT_EQ(receiver.tryReceive(result, error), SOCKET_ERROR);
+	ASSERT_TRUE(error.isTimeout());
+	ASSERT_TRUE(receiver.good());
+
+	sender.sendBytes(encoded + 1, static_cast<int>(size - 1), endOfStream);
+
+	ASSERT_EQ(receiver.tryReceive(result, error), static_cast<int>(size));
+	ASSERT_EQ(result, -1000);
+}
+
+TEST(TryReceive, Frame)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	web::Network receiver(second, std::chrono::milliseconds(100));
+	web::NetworkError error = {};
+	bool endOfStream = false;
+	std::string result;
+	web::utility::ContainerWrapper wrapper(result);
+	std::string data = "frame";
+
+	ASSERT_EQ(receiver.tryReceiveData(wrapper, endOfStream, error), SOCKET_ERROR);
+	ASSERT_TRUE(error.isTimeout());
+
+	ASSERT_EQ(sender.trySendData(web::utility::ContainerWrapper(data), endOfStream, error), static_cast<int>(data.size()));
+
+	ASSERT_EQ(receiver.tryReceiveData(wrapper, endOfStream, error), static_cast<int>(data.size()));
+	ASSERT_EQ(result, data);
+
+	// Protocol errors are returned too
+	int32_t negativeSize = -1;
+
+	sender.sendBytes(&negativeSize, sizeof(negativeSize), endOfStream);
+
+	ASSERT_EQ(receiver.tryReceiveData(wrapper, endOfStream, error), SOCKET_ERROR);
+	ASSERT_EQ(error.errorCode, EBADMSG);
+	ASSERT_FALSE(error.description.empty());
+}
+
+TEST(TryReceive, FrameRetryAfterPartialTimeout)
+{
+	enum class Format
+	{
+		fixed,
+		varint,
+		checksum
+	};
+
+	for (Format format : { Format::fixed, Format::varint, Format::checksum })
+	{
+		auto [first, second] = createLoopbackPair(SOCK_STREAM);
+		// Frame is encoded in memory, so it can be written in pieces
+		MemoryNetwork encoder(first, std::chrono::seconds(5));
+		std::string data(300, 'f');
+		bool endOfStream = false;
+
+		closesocket(second);
+
+		if (format == Format::varint)
+		{
+			encoder.setFrameHeader(web::FrameHeader::varint);
+		}
+		else if (format == Format::checksum)
+		{
+			encoder.enableFrameChecksum();
+		}
+
+		encoder.sendData(data, endOfStream);
+
+		std::string frame = *encoder.wire;
+		size_t headerSize = frame.size() - data.size();
+
+		// Timeout inside header and inside payload
+		for (size_t split : { static_cast<size_t>(1), headerSize + 100 })
+		{
+			auto [writerSocket, readerSocket] = createLoopbackPair(SOCK_STREAM);
+			web::Network writer(writerSocket, std::chrono::seconds(5));
+			web::Network reader(readerSocket, std::chrono::milliseconds(100));
+			web::NetworkError error = {};
+			std::string result;
+			web::utility::ContainerWrapper wrapper(result);
+
+			if (format == Format::varint)
+			{
+				reader.setFrameHeader(web::FrameHeader::varint);
+			}
+			else if (format == Format::checksum)
+			{
+				reader.enableFrameChecksum();
+			}
+
+			writer.sendBytes(frame.data(), static_cast<int>(split), endOfStream);
+
+			ASSERT_EQ(reader.tryReceiveData(wrapper, endOfStream, error), SOCKET_ERROR);
+			ASSERT_TRUE(error.isTimeout());
+
+			writer.sendBytes(frame.data() + split, static_cast<int>(frame.size() - split), endOfStream);
+
+			ASSERT_EQ(reader.tryReceiveData(wrapper, endOfStream, error), static_cast<int>(data.size()));
+			ASSERT_EQ(result, data);
+		}
+	}
+}
+
+TEST(TryReceive, OverriddenReceiveData)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	LenientNetwork receiver(second, std::chrono::milliseconds(100));
+	web::NetworkError error = {};
+	bool endOfStream = false;
+	std::string data = "frame";
+	std::string result(data.size(), '\0');
+	web::utility::ContainerWrapper wrapper(result);
+
+	ASSERT_EQ(receiver.tryReceiveData(wrapper, endOfStream, error), SOCKET_ERROR);
+	ASSERT_TRUE(error.isTimeout());
+
+	sender.sendData(data, endOfStream);
+
+	ASSERT_EQ(receiver.tryReceiveData(wrapper, endOfStream, error), static_cast<int>(data.size()));
+	ASSERT_EQ(result, data);
+}
+
+#ifdef __cpp_lib_expected
+TEST(TryReceive, Expected)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::Network sender(first, std::chrono::seconds(5));
+	streams::IOSocketStream receiver = streams::IOSocketStream::createStream<web::Network>(second, std::chrono::milliseconds(100));
+	web::Network& receiverNetwork = receiver.getNetwork();
+	bool endOfStream = false;
+	std::string result;
+	web::utility::ContainerWrapper wrapper(result);
+	std::string data = "frame";
+	int32_t value = 0;
+
+	std::expected<int, web::NetworkError> received = receiverNetwork.tryReceiveData(wrapper, endOfStream);
+
+	ASSERT_FALSE(received);
+	ASSERT_TRUE(received.error().isTimeout());
+
+	ASSERT_EQ(sender.trySendData(web::utility::ContainerWrapper(data), endOfStream), static_cast<int>(data.size()));
+
+	received = receiverNetwork.tryReceiveData(wrapper, endOfStream);
+
+	ASSERT_TRUE(received);
+	ASSERT_EQ(result, data);
+
+	received = receiver.tryReceive(value);
+
+	ASSERT_FALSE(received);
+	ASSERT_TRUE(received.error().isTimeout());
+
+	ASSERT_TRUE(sender.trySendBytes(&data[0], 4, endOfStream));
+
+	received = receiverNetwork.tryReceiveBytes(&value, sizeof(value), endOfStream);
+
+	ASSERT_TRUE(received);
+	ASSERT_EQ(std::string_view(reinterpret_cast<const char*>(&value), sizeof(value)), "fram");
+}
+#endif // __cpp_lib_expected
+
+#ifdef SOCKET_STREAMS_COMPRESSION
+TEST(Compression, RoundTrip)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::CompressedNetwork sender(std::make_unique<web::Network>(first, std::chrono::seconds(5)), 1024);
+	web::CompressedNetwork receiver(std::make_unique<web::Network>(second, std::chrono::seconds(5)), 1024);
+	std::string large(64 * 1024, 'a');
+	std::string small = "below threshold";
+	bool endOfStream = false;
+
+	for (size_t i = 0; i < large.size(); i += 7)
+	{
+		large[i] = static_cast<char>('a' + i % 13);
+	}
+
+	sender.sendRawData(large.data(), static_cast<int>(large.size()), endOfStream);
+	sender.sendRawData(small.data(), static_cast<int>(small.size()), endOfStream);
+
+	{
+		std::string result;
+		web::utility::ContainerWrapper wrapper(result);
+
+		ASSERT_EQ(receiver.receiveData(wrapper, endOfStream), static_cast<int>(large.size()));
+		ASSERT_EQ(result, large);
+	}
+
+	{
+		std::string result(small.size(), '\0');
+
+		ASSERT_EQ(receiver.receiveRawData(result.data(), static_cast<int>(result.size()), endOfStream), static_cast<int>(small.size()));
+		ASSERT_EQ(result, small);
+	}
+
+	const web::CompressedNetwork::CompressionStatistics& statistics = sender.getCompressionStatistics();
+
+	ASSERT_EQ(statistics.compressedFrames, 1);
+	ASSERT_EQ(statistics.uncompressedFrames, 1);
+	ASSERT_EQ(statistics.inputBytes, large.size());
+	ASSERT_LT(statistics.outputBytes, large.size() / 4);
+}
+
+TEST(Compression, PlainPeer)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::CompressedNetwork sender(std::make_unique<web::Network>(first, std::chrono::seconds(5)), 1024);
+	web::Network receiver(second, std::chrono::seconds(5));
+	std::string data(100, 'b');
+	std::string result;
+	web::utility::ContainerWrapper wrapper(result);
+	bool endOfStream = false;
+
+	sender.sendRawData(data.data(), static_cast<int>(data.size()), endOfStream);
+
+	ASSERT_EQ(receiver.receiveData(wrapper, endOfStream), static_cast<int>(data.size()));
+	ASSERT_EQ(result, data);
+}
+
+TEST(Compression, OversizedFrameSkipped)
+{
+	auto [first, second] = createLoopbackPair(SOCK_STREAM);
+	web::CompressedNetwork sender(std::make_unique<web::Network>(first, std::chrono::seconds(5)), 1024);
+	web::CompressedNetwork receiver(std::make_unique<web::Network>(second, std::chrono::seconds(5)), 1024);
+	std::string large(100000, 'c');
+	std::string small = "small";
+	std::string result;
+	web::utility::ContainerWrapper wrapper(result);
+	bool endOfStream = false;
+
+	receiver.setMaxFrameSize(10000);
+
+	// Compressed payload is small, declared size is checked before it is allocated
+	sender.sendRawData(large.data(), static_cast<int>(large.size()), endOfStream);
+	sender.sendRawData(small.data(), static_cast<int>(small.size()), endOfStream);
+
+	try
+	{
+		receiver.receiveData(wrapper, endOfStream);
+
+		FAIL() << "Oversized frame accepted";
+	}
+	catch (const web::exceptions::WebException& e)
+	{
+		ASSERT_EQ(e.getErrorCode(), EMSGSIZE);
+	}
+
+	ASSERT_EQ(receiver.receiveData(wrapper, endOfStream), static_cast<int>(small.size()));
+	ASSERT_EQ(result, small);
+}
+#endif // SOCKET_STREAMS_COMPRESSION
+
 int main(int argc, char** argv)
 {
 	bool isRunning = false;
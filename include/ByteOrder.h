@@ -0,0 +1,45 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace web::utility
+{
+	/// @brief Arithmetic or enum type which byte order can be converted
+	template<typename T>
+	concept ByteSwappable = (std::is_arithmetic_v<T> || std::is_enum_v<T>) && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+	/**
+	 * @brief Reverse bytes of every element. Uses AVX2, SSSE3 or NEON shuffles if CPU supports them
+	 * @param source
+	 * @param destination Can be source for in place conversion, otherwise buffers must not overlap
+	 * @param count Number of elements
+	 * @param elementSize 1, 2, 4 or 8
+	 */
+	void byteSwap(const void* source, void* destination, size_t count, size_t elementSize) noexcept;
+
+	/// @brief Portable implementation. Same result as byteSwap
+	void byteSwapSoftware(const void* source, void* destination, size_t count, size_t elementSize) noexcept;
+
+	/// @brief Name of implementation selected for this CPU: avx2, ssse3, neon or software
+	std::string_view getByteSwapImplementation() noexcept;
+
+	/// @brief Convert elements in place between native and Order byte order. Does nothing if Order is native
+	template<std::endian Order, ByteSwappable T>
+	void convertByteOrder(std::span<T> data) noexcept;
+}
+
+namespace web::utility
+{
+	template<std::endian Order, ByteSwappable T>
+	void convertByteOrder(std::span<T> data) noexcept
+	{
+		if constexpr (Order != std::endian::native && sizeof(T) != 1)
+		{
+			utility::byteSwap(data.data(), data.data(), data.size(), sizeof(T));
+		}
+	}
+}
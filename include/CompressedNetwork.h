@@ -0,0 +1,104 @@
+#pragma once
+
+#ifdef SOCKET_STREAMS_COMPRESSION
+
+#include <zlib.h>
+
+#include "Network.h"
+
+namespace web
+{
+	/**
+	 * @brief Decorator that compresses frames(sendData/sendRawData) not smaller than threshold with zlib
+	 * Uncompressed frames keep plain Network format, so compressed network can receive from plain one.
+	 * Compressed frame has compressedFlag set in size header and starts with uncompressed size
+	 */
+	class CompressedNetwork : public Network
+	{
+	public:
+		static constexpr uint32_t compressedFlag = 0x80000000;
+
+		struct CompressionStatistics
+		{
+			uint64_t compressedFrames = 0;
+			/// @brief Frames below threshold or incompressible
+			uint64_t uncompressedFrames = 0;
+			/// @brief Original size of compressed frames
+			uint64_t inputBytes = 0;
+			/// @brief Size of compressed frames on wire without headers
+			uint64_t outputBytes = 0;
+		};
+
+	private:
+		std::unique_ptr<Network> network;
+		z_stream compressor;
+		z_stream decompressor;
+		utility::UninitializedBuffer sendBuffer;
+		utility::UninitializedBuffer receiveBuffer;
+		CompressionStatistics compressionStatistics;
+		size_t threshold;
+
+	private:
+		int sendFrame(const char* data, int size, bool& endOfStream, int flags);
+
+		/// @brief Receive compressed payload after size header
+		/// @return Uncompressed size, 0 on end of stream
+		int receiveCompressedFrame(uint32_t header, bool& endOfStream, int flags);
+
+		void decompress(char* data, uint32_t size);
+
+		/// @brief Decompress frame of size bytes into buffers one after another
+		void decompress(std::span<const std::span<char>> buffers, uint32_t size);
+
+	protected:
+		int sendBytesImplementation(const char* data, int size, int flags = 0) override;
+
+		int receiveBytesImplementation(char* data, int size, int flags = 0) override;
+
+	public:
+		/**
+		 * @brief Wrap network
+		 * @param network Network that sends compressed frames
+		 * @param threshold Minimal frame size to compress
+		 * @param level zlib compression level
+		 * @exception WebException
+		 */
+		CompressedNetwork(std::unique_ptr<Network>&& network, size_t threshold = 1024, int level = Z_DEFAULT_COMPRESSION);
+
+		CompressedNetwork(const CompressedNetwork&) = delete;
+
+		CompressedNetwork& operator = (const CompressedNetwork&) = delete;
+
+		int sendData(const utility::ContainerWrapper& data, bool& endOfStream, int flags = 0) override;
+
+		int sendRawData(const char* data, int size, bool& endOfStream, int flags = 0) override;
+
+		int receiveData(utility::ContainerWrapper& data, bool& endOfStream, int flags = 0) override;
+
+		int receiveRawData(char* data, int size, bool& endOfStream, int flags = 0) override;
+
+		using Network::receiveScatteredData;
+
+		/// @brief Compressed frame is decompressed directly into header and body
+		int receiveScatteredData(std::span<char> header, utility::ContainerWrapper& body, bool& endOfStream, int flags = 0) override;
+
+		/// @brief Compressed frames are protected by zlib adler32, so frame checksum isn't supported
+		/// @return false if enable
+		bool enableFrameChecksum(bool enable = true) override;
+
+		/// @brief Compressed frame header uses high bit of fixed header
+		/// @return false if header isn't FrameHeader::fixed
+		bool setFrameHeader(FrameHeader header) override;
+
+		/// @brief Also checks wrapped network
+		bool hasPendingInput() const noexcept override;
+
+		const std::unique_ptr<Network>& getNetwork() const noexcept;
+
+		const CompressionStatistics& getCompressionStatistics() const noexcept;
+
+		~CompressedNetwork();
+	};
+}
+
+#endif // SOCKET_STREAMS_COMPRESSION
@@ -1,7 +1,17 @@
 #pragma once
 
+#include <cerrno>
+#include <algorithm>
 #include <concepts>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "WebException.h"
 
 namespace web::utility
 {
@@ -18,6 +28,81 @@ namespace web::utility
 		{ value[size_t()] } -> std::same_as<char&>;
 	};
 
+	/**
+	 * @brief Allocator that default initializes elements, so resize of std::vector<char> doesn't zero new elements
+	 */
+	template<typename T, typename AllocatorT = std::allocator<T>>
+	class DefaultInitAllocator : public AllocatorT
+	{
+	private:
+		using Traits = std::allocator_traits<AllocatorT>;
+
+	public:
+		template<typename U>
+		struct rebind
+		{
+			using other = DefaultInitAllocator<U, typename Traits::template rebind_alloc<U>>;
+		};
+
+	public:
+		using AllocatorT::AllocatorT;
+
+		template<typename U>
+		void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+		{
+			::new (static_cast<void*>(ptr)) U;
+		}
+
+		template<typename U, typename... Args>
+		void construct(U* ptr, Args&&... args)
+		{
+			Traits::construct(static_cast<AllocatorT&>(*this), ptr, std::forward<Args>(args)...);
+		}
+	};
+
+	/// @brief Receive container which growth isn't zero filled
+	using UninitializedBuffer = std::vector<char, DefaultInitAllocator<char>>;
+
+	/**
+	 * @brief Container that can grow without initializing new elements(std::string since C++23)
+	 */
+	template<typename T>
+	concept ResizeAndOverwrite = requires(T value)
+	{
+		{ value.resize_and_overwrite(size_t(), [](char*, size_t size) { return size; }) };
+	};
+
+	/**
+	 * @brief Custom container hook for growth without initializing new elements
+	 */
+	template<typename T>
+	concept ResizeUninitialized = requires(T value)
+	{
+		{ value.resize_uninitialized(size_t()) };
+	};
+
+	/**
+	 * @brief Grow container to at least size and write its first size bytes with overwrite. New elements aren't initialized first if container supports it
+	 * Container keeps only old elements and bytes reported by overwrite, so no element is left indeterminate. If overwrite throws, container keeps its old size
+	 * @param value
+	 * @param size
+	 * @param overwrite Writes to buffer of at least size bytes, returns number of bytes written from start
+	 */
+	template<Container T>
+	void resizeAndOverwrite(T& value, size_t size, const std::function<size_t(char*)>& overwrite);
+
+	/**
+	 * @brief Receive frame that doesn't fit container through overwrite into temporary buffer and throw EBADMSG. Payload is consumed, so next frame can still be received
+	 * @param size Frame size
+	 * @param overwrite Receives payload, nullptr if container is resized without receive
+	 * @param message Description of exception
+	 */
+	[[noreturn]] void dropFrame(size_t size, const std::function<size_t(char*)>* overwrite, std::string_view message);
+
+	/// @brief Trivially copyable type that is sent as bytes of array. Pointers aren't meaningful for peer
+	template<typename T>
+	concept ArrayElement = std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>;
+
 	/**
 	* @brief Wrap Container concept instance
 	*/
@@ -27,7 +112,8 @@ namespace web::utility
 		std::function<char* ()> dataImplementation;
 		std::function<const char* ()> constDataImplementation;
 		std::function<size_t()> sizeImplementation;
-		std::function<void(size_t)> resizeImplementation;
+		/// @brief Plain resize if overwrite is nullptr, otherwise resizeAndOverwrite
+		std::function<void(size_t, const std::function<size_t(char*)>*)> resizeImplementation;
 		std::function<char& (size_t)> operatorImplementation;
 
 	protected:
@@ -36,7 +122,7 @@ namespace web::utility
 			const std::function<char* ()>& dataImplementation,
 			const std::function<const char* ()>& constDataImplementation,
 			const std::function<size_t()>& sizeImplementation,
-			const std::function<void(size_t)>& resizeImplementation,
+			const std::function<void(size_t, const std::function<size_t(char*)>*)>& resizeImplementation,
 			const std::function<char& (size_t)>& operatorImplementation
 		);
 
@@ -60,14 +146,105 @@ namespace web::utility
 
 		void resize(size_t newSize);
 
+		/// @brief Grow to at least newSize without initializing new elements if wrapped container supports it and write first newSize bytes. See utility::resizeAndOverwrite
+		void resizeAndOverwrite(size_t newSize, const std::function<size_t(char*)>& overwrite);
+
 		char& operator [](size_t index);
 
 		virtual ~ContainerWrapper() = default;
 	};
+
+	/**
+	 * @brief Wrap std::vector or std::span of ArrayElement as bytes, so whole array is one frame
+	 * Frame received into vector must be multiple of element size, frame received into span must have size of span. Other frames are received, dropped and rejected with EBADMSG
+	 */
+	class ArrayWrapper : public ContainerWrapper
+	{
+	public:
+		template<ArrayElement T, typename AllocatorT>
+		requires (!std::same_as<T, bool>)
+		ArrayWrapper(std::vector<T, AllocatorT>& value);
+
+		template<ArrayElement T, size_t Extent>
+		ArrayWrapper(std::span<T, Extent> value);
+
+		~ArrayWrapper() = default;
+	};
 }
 
 namespace web::utility
 {
+	template<Container T>
+	void resizeAndOverwrite(T& value, size_t size, const std::function<size_t(char*)>& overwrite)
+	{
+		size_t oldSize = value.size();
+
+		if (oldSize >= size)
+		{
+			overwrite(value.data());
+
+			return;
+		}
+
+		if constexpr (!ResizeUninitialized<T> && ResizeAndOverwrite<T>)
+		{
+			std::exception_ptr exception;
+
+			// Operation must not throw and every kept element must be written. Its size argument isn't used since some implementations pass capacity
+			value.resize_and_overwrite
+			(
+				size,
+				[&](char* data, size_t) -> size_t
+				{
+					try
+					{
+						return std::max(std::min(overwrite(data), size), oldSize);
+					}
+					catch (...)
+					{
+						exception = std::current_exception();
+
+						return oldSize;
+					}
+				}
+			);
+
+			if (exception)
+			{
+				std::rethrow_exception(exception);
+			}
+		}
+		else
+		{
+			size_t written = oldSize;
+
+			if constexpr (ResizeUninitialized<T>)
+			{
+				value.resize_uninitialized(size);
+			}
+			else
+			{
+				value.resize(size);
+			}
+
+			try
+			{
+				written = std::max(std::min(overwrite(value.data()), size), oldSize);
+			}
+			catch (...)
+			{
+				value.resize(oldSize);
+
+				throw;
+			}
+
+			if (written < size)
+			{
+				value.resize(written);
+			}
+		}
+	}
+
 	template<Container T>
 	ContainerWrapper::ContainerWrapper(T& value) :
 		ContainerWrapper
@@ -84,9 +261,16 @@ namespace web::utility
 			{
 				return value.size();
 			},
-			[&value](size_t newSize) mutable -> void
+			[&value](size_t newSize, const std::function<size_t(char*)>* overwrite) mutable -> void
 			{
-				value.resize(newSize);
+				if (overwrite)
+				{
+					utility::resizeAndOverwrite(value, newSize, *overwrite);
+				}
+				else
+				{
+					value.resize(newSize);
+				}
 			},
 			[&value](size_t index) mutable -> char&
 			{
@@ -96,4 +280,89 @@ namespace web::utility
 	{
 
 	}
+
+	template<ArrayElement T, typename AllocatorT>
+	requires (!std::same_as<T, bool>)
+	ArrayWrapper::ArrayWrapper(std::vector<T, AllocatorT>& value) :
+		ContainerWrapper
+		(
+			[&value]() mutable -> char*
+			{
+				return reinterpret_cast<char*>(value.data());
+			},
+			[&value]() mutable -> const char*
+			{
+				return reinterpret_cast<const char*>(value.data());
+			},
+			[&value]() mutable -> size_t
+			{
+				return value.size() * sizeof(T);
+			},
+			[&value](size_t newSize, const std::function<size_t(char*)>* overwrite) mutable -> void
+			{
+				if (newSize % sizeof(T))
+				{
+					utility::dropFrame(newSize, overwrite, "Frame size isn't multiple of array element size");
+				}
+
+				if (!overwrite)
+				{
+					value.resize(newSize / sizeof(T));
+
+					return;
+				}
+
+				// Elements aren't chars, so partially written frame is kept as whole zero filled elements
+				if (value.size() < newSize / sizeof(T))
+				{
+					value.resize(newSize / sizeof(T));
+				}
+
+				(*overwrite)(reinterpret_cast<char*>(value.data()));
+			},
+			[&value](size_t index) mutable -> char&
+			{
+				return reinterpret_cast<char*>(value.data())[index];
+			}
+		)
+	{
+
+	}
+
+	template<ArrayElement T, size_t Extent>
+	ArrayWrapper::ArrayWrapper(std::span<T, Extent> value) :
+		ContainerWrapper
+		(
+			[value]() mutable -> char*
+			{
+				return reinterpret_cast<char*>(const_cast<std::remove_const_t<T>*>(value.data()));
+			},
+			[value]() mutable -> const char*
+			{
+				return reinterpret_cast<const char*>(value.data());
+			},
+			[value]() mutable -> size_t
+			{
+				return value.size_bytes();
+			},
+			[value](size_t newSize, const std::function<size_t(char*)>* overwrite) mutable -> void
+			{
+				if (newSize != value.size_bytes())
+				{
+					utility::dropFrame(newSize, overwrite, "Frame size doesn't match array size");
+				}
+
+				if (overwrite)
+				{
+					(*overwrite)(reinterpret_cast<char*>(const_cast<std::remove_const_t<T>*>(value.data())));
+				}
+			},
+			[value](size_t index) mutable -> char&
+			{
+				return reinterpret_cast<char*>(const_cast<std::remove_const_t<T>*>(value.data()))[index];
+			}
+		)
+	{
+
+	}
 }
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace web::utility
+{
+	/**
+	 * @brief CRC32C(Castagnoli) checksum. Uses SSE4.2 crc32 with PCLMULQDQ lane combining or ARMv8 crc32c instructions if CPU supports them, slicing by 8 otherwise
+	 * @param data
+	 * @param size
+	 * @param crc Result of previous call to continue checksum of split data
+	 * @return
+	 */
+	uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0) noexcept;
+
+	/// @brief Portable slicing by 8 implementation. Same result as crc32c
+	uint32_t crc32cSoftware(const void* data, size_t size, uint32_t crc = 0) noexcept;
+
+	/// @brief Name of implementation selected for this CPU: sse4.2+pclmul, sse4.2, armv8 or software
+	std::string_view getCrc32cImplementation() noexcept;
+}
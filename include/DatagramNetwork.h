@@ -0,0 +1,159 @@
+#pragma once
+
+#include <span>
+
+#include "Network.h"
+
+namespace web
+{
+	/// @brief Datagram(UDP) network. Each sendData/sendRawData call maps to exactly one datagram without length prefix
+	class DatagramNetwork : public Network
+	{
+	public:
+		/// @brief Maximum UDP payload size
+		static constexpr size_t maxDatagramSize = 65507;
+
+		/// @brief Maximum number of datagrams moved by one sendmmsg call
+		static constexpr size_t maxBatchSize = 1024;
+
+		/// @brief Maximum number of messages moved by one recvmmsg call. Every message needs maxDatagramSize bytes(GRO coalesces up to 64 KiB into one message), so receive buffer stays about 1 MiB
+		static constexpr size_t maxReceiveSlots = 16;
+
+	private:
+		struct PendingDatagram
+		{
+			std::string_view data;
+			/// @brief SO_TIMESTAMPING software receive timestamp
+			std::optional<std::chrono::system_clock::time_point> kernel;
+		};
+
+	private:
+		/// @brief Allocated on first receive for actual batch size
+		utility::UninitializedBuffer receiveBuffer;
+		std::queue<PendingDatagram> pendingDatagrams;
+		uint16_t segmentSize;
+		bool receiveOffload;
+
+	private:
+		static SOCKET createSocket(std::string_view ip, std::string_view port);
+
+	private:
+		/// @brief Fill pendingDatagrams from socket
+		/// @return Number of received datagrams or SOCKET_ERROR
+		int receiveDatagramsImplementation(size_t maxDatagrams, int flags);
+
+		/// @brief Take next datagram, receive it if none is pending. Updates statistics latency and receive timestamps like Network::receiveData
+		/// @exception WebException
+		std::string_view receiveDatagram(int flags);
+
+	protected:
+		/// @brief receiveBytes returns after one datagram
+		bool isStreamOriented() const noexcept override;
+
+	public:
+		/// @brief Client side constructor. Socket connected to remote address so all datagrams go to ip:port
+		/// @param ip Remote address to send datagrams to
+		/// @param port Remote port to send datagrams to
+		/// @param timeout Timeout for receive and send calls
+		/// @exception WebException
+		template<Timeout T = std::chrono::seconds>
+		DatagramNetwork(std::string_view ip, std::string_view port, T timeout = 30s);
+
+		/// @brief Constructor from already created UDP socket(bound for receiving and/or connected for sending)
+		/// @param datagramSocket
+		/// @param timeout Timeout for receive and send calls
+		template<Timeout T = std::chrono::seconds>
+		DatagramNetwork(SOCKET datagramSocket, T timeout = 30s);
+
+		/**
+		 * @brief Enable UDP generic segmentation offload(UDP_SEGMENT). Consecutive datagrams of segmentSize passed to sendDatagrams are sent as one message and split back by kernel/NIC. Single sends larger than segmentSize stay one datagram
+		 * @param segmentSize Size of each datagram on the wire. 0 disables segmentation offload
+		 * @exception WebException Not supported by kernel or platform
+		 */
+		void setSegmentationOffload(uint16_t segmentSize);
+
+		/**
+		 * @brief Enable UDP generic receive offload(UDP_GRO). Coalesced datagrams are split back before they returned to caller
+		 * @param enable
+		 * @exception WebException Not supported by kernel or platform
+		 */
+		void setReceiveOffload(bool enable);
+
+		uint16_t getSegmentationOffload() const noexcept;
+
+		bool getReceiveOffload() const noexcept;
+
+		/**
+		* @brief Send one datagram
+		* @param data Datagram payload
+		* @param endOfStream Always false for datagrams
+		* @return Number of bytes send
+		*/
+		int sendData(const utility::ContainerWrapper& data, bool& endOfStream, int flags = 0) override;
+
+		/**
+		* @brief Send one datagram
+		* @param data Datagram payload
+		* @param endOfStream Always false for datagrams
+		* @return Number of bytes send
+		*/
+		int sendRawData(const char* data, int size, bool& endOfStream, int flags = 0) override;
+
+		/**
+		* @brief Receive one datagram
+		* @param data Resized if smaller than datagram
+		* @param endOfStream Always false for datagrams
+		* @return Datagram size
+		*/
+		int receiveData(utility::ContainerWrapper& data, bool& endOfStream, int flags = 0) override;
+
+		/**
+		* @brief Receive one datagram. If datagram is larger than size it is truncated
+		* @param data Actual data
+		* @param endOfStream Always false for datagrams
+		* @return Number of bytes copied to data
+		*/
+		int receiveRawData(char* data, int size, bool& endOfStream, int flags = 0) override;
+
+		/**
+		 * @brief Send many datagrams with as few system calls as possible(sendmmsg on Linux)
+		 * @param datagrams Each element is one datagram
+		 * @return Number of sent datagrams
+		 * @exception WebException
+		 */
+		int sendDatagrams(std::span<const std::string_view> datagrams, int flags = 0);
+
+		/**
+		 * @brief Receive up to maxDatagrams datagrams with as few system calls as possible(recvmmsg of up to maxReceiveSlots messages on Linux). Blocks until at least one datagram available
+		 * @param datagrams Received datagrams. Resized to number of received datagrams
+		 * @param maxDatagrams Maximum number of datagrams to receive
+		 * @return Number of received datagrams
+		 * @exception WebException
+		 */
+		int receiveDatagrams(std::vector<std::string>& datagrams, size_t maxDatagrams = 64, int flags = 0);
+
+		/// @brief Also true if datagrams received by previous batch are pending
+		bool hasPendingInput() const noexcept override;
+
+		~DatagramNetwork() = default;
+	};
+}
+
+namespace web
+{
+	template<Timeout T>
+	DatagramNetwork::DatagramNetwork(std::string_view ip, std::string_view port, T timeout) :
+		DatagramNetwork(DatagramNetwork::createSocket(ip, port), timeout)
+	{
+
+	}
+
+	template<Timeout T>
+	DatagramNetwork::DatagramNetwork(SOCKET datagramSocket, T timeout) :
+		Network(datagramSocket, timeout),
+		segmentSize(0),
+		receiveOffload(false)
+	{
+
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#include "Network.h"
+
+namespace web
+{
+	/**
+	 * @brief Exchange messages which size is known at compile time without size header, so every message is exactly Size bytes on wire
+	 * Messages are raw bytes of MessageT in native byte order. Frame checksum, varint header and compression aren't applied to them
+	 * @tparam MessageT Trivially copyable message
+	 * @tparam Size Message size agreed with peer. Message type of different size doesn't compile
+	 */
+	template<typename MessageT, size_t Size = sizeof(MessageT)>
+	requires std::is_trivially_copyable_v<MessageT>
+	class FixedFrameChannel
+	{
+		static_assert(sizeof(MessageT) == Size, "Message size doesn't match size agreed with peer");
+
+	public:
+		static constexpr size_t messageSize = Size;
+
+	private:
+		/// @brief Messages in one sendBytes/receiveBytes call, so byte count fits int
+		static constexpr size_t maxBatchSize = (std::numeric_limits<int>::max)() / Size;
+
+	private:
+		Network& network;
+
+	public:
+		/// @param network Network of connection. Channel doesn't own it
+		FixedFrameChannel(Network& network) noexcept;
+
+		/**
+		 * @brief Send one message
+		 * @return Number of sent bytes, Size unless endOfStream
+		 * @exception WebException
+		 */
+		int send(const MessageT& message, bool& endOfStream, int flags = 0);
+
+		/**
+		 * @brief Send messages one after another with one sendBytes call
+		 * @return Number of sent bytes
+		 * @exception WebException
+		 */
+		int64_t send(std::span<const MessageT> messages, bool& endOfStream, int flags = 0);
+
+		/**
+		 * @brief Receive exactly one message
+		 * @return Number of received bytes, Size unless endOfStream
+		 * @exception WebException
+		 */
+		int receive(MessageT& message, bool& endOfStream, int flags = 0);
+
+		/**
+		 * @brief Receive exactly messages.size() messages
+		 * @return Number of received bytes
+		 * @exception WebException
+		 */
+		int64_t receive(std::span<MessageT> messages, bool& endOfStream, int flags = 0);
+
+		Network& getNetwork() const noexcept;
+
+		~FixedFrameChannel() = default;
+	};
+}
+
+namespace web
+{
+	template<typename MessageT, size_t Size>
+	requires std::is_trivially_copyable_v<MessageT>
+	FixedFrameChannel<MessageT, Size>::FixedFrameChannel(Network& network) noexcept :
+		network(network)
+	{
+
+	}
+
+	template<typename MessageT, size_t Size>
+	requires std::is_trivially_copyable_v<MessageT>
+	int FixedFrameChannel<MessageT, Size>::send(const MessageT& message, bool& endOfStream, int flags)
+	{
+		return network.sendBytes(reinterpret_cast<const char*>(&message), static_cast<int>(Size), endOfStream, flags);
+	}
+
+	template<typename MessageT, size_t Size>
+	requires std::is_trivially_copyable_v<MessageT>
+	int64_t FixedFrameChannel<MessageT, Size>::send(std::span<const MessageT> messages, bool& endOfStream, int flags)
+	{
+		int64_t total = 0;
+
+		endOfStream = false;
+
+		for (size_t offset = 0; offset < messages.size() && !endOfStream; offset += maxBatchSize)
+		{
+			size_t count = (std::min)(maxBatchSize, messages.size() - offset);
+
+			total += network.sendBytes(reinterpret_cast<const char*>(messages.data() + offset), static_cast<int>(count * Size), endOfStream, flags);
+		}
+
+		return total;
+	}
+
+	template<typename MessageT, size_t Size>
+	requires std::is_trivially_copyable_v<MessageT>
+	int FixedFrameChannel<MessageT, Size>::receive(MessageT& message, bool& endOfStream, int flags)
+	{
+		return network.receiveBytes(reinterpret_cast<char*>(&message), static_cast<int>(Size), endOfStream, flags);
+	}
+
+	template<typename MessageT, size_t Size>
+	requires std::is_trivially_copyable_v<MessageT>
+	int64_t FixedFrameChannel<MessageT, Size>::receive(std::span<MessageT> messages, bool& endOfStream, int flags)
+	{
+		int64_t total = 0;
+
+		endOfStream = false;
+
+		for (size_t offset = 0; offset < messages.size() && !endOfStream; offset += maxBatchSize)
+		{
+			size_t count = (std::min)(maxBatchSize, messages.size() - offset);
+
+			total += network.receiveBytes(reinterpret_cast<char*>(messages.data() + offset), static_cast<int>(count * Size), endOfStream, flags);
+		}
+
+		return total;
+	}
+
+	template<typename MessageT, size_t Size>
+	requires std::is_trivially_copyable_v<MessageT>
+	Network& FixedFrameChannel<MessageT, Size>::getNetwork() const noexcept
+	{
+		return network;
+	}
+}
@@ -9,6 +9,14 @@ namespace buffers
 {
 	using namespace std::chrono_literals;
 
+	/// @brief Deletes network unless it's member of buffer(EmbeddedNetworkBuffer)
+	struct NetworkDeleter
+	{
+		bool owning = true;
+
+		void operator ()(web::Network* network) const noexcept;
+	};
+
 	/// @brief Base input/output socket buffer
 	class IOSocketBuffer : public std::streambuf
 	{
@@ -17,12 +25,14 @@ namespace buffers
 		using typename std::streambuf::char_type;
 		using typename std::streambuf::traits_type;
 
+		using NetworkPointer = std::unique_ptr<web::Network, NetworkDeleter>;
+
 	private:
+		/// @brief Receive buffer in page region from PageRegionPool. Region is allocated on first resize
 		class BufferArray
 		{
 		private:
 			size_t totalSize;
-			size_t pageSize;
 			void* pageData;
 
 		private:
@@ -47,6 +57,10 @@ namespace buffers
 
 			void resize(size_t size);
 
+			/// @brief Replace region with smaller one without copying data. Old region is freed first, so memory budget isn't exceeded
+			/// @return true if region was replaced
+			bool shrink(size_t size);
+
 			char& operator [](size_t index);
 
 			~BufferArray();
@@ -56,10 +70,21 @@ namespace buffers
 		size_t getAvailableInputSize() const;
 
 	protected:
-		std::unique_ptr<web::Network> network;
+		NetworkPointer network;
 		int lastPacketSize;
 		BufferArray inputData;
 		bool endOfStream;
+		size_t reclaimSize = 0;
+		std::chrono::steady_clock::duration reclaimPeriod = std::chrono::steady_clock::duration::zero();
+		/// @brief Last time frame larger than reclaimSize was received
+		std::chrono::steady_clock::time_point highWaterTime;
+
+	private:
+		/// @brief Called before receive into inputData. Applies reclamation and allocates buffer if it's released
+		void prepareBuffer();
+
+		/// @brief Called after receive into inputData
+		void updateHighWater();
 
 	protected:
 		int_type overflow(int_type ch) override;
@@ -70,6 +95,8 @@ namespace buffers
 
 		std::streamsize xsgetn(char_type* s, std::streamsize size) override;
 
+		IOSocketBuffer(NetworkPointer&& network);
+
 	public:
 		IOSocketBuffer() = default;
 
@@ -106,7 +133,43 @@ namespace buffers
 		/// @return Self
 		IOSocketBuffer& operator = (IOSocketBuffer&& other) noexcept = default;
 
-		const std::unique_ptr<web::Network>& getNetwork() const noexcept;
+		/**
+		 * @brief Receive frame into internal buffer without copying it to caller container
+		 * Characters of previous frame that weren't read are dropped
+		 * @return View of frame, valid until next receive or releaseBuffer call on this buffer. Empty if connection closed
+		 * @exception WebException
+		 */
+		std::string_view receiveView();
+
+		/**
+		 * @brief Shrink receive buffer to keepSize if no frame larger than keepSize was received for period. Checked when frame in buffer is consumed, before next receive into it and in reclaimBuffer
+		 * @param keepSize Size that buffer isn't shrunk below. 0 disables reclamation
+		 * @param period
+		 */
+		template<web::Timeout T>
+		void setBufferReclamation(size_t keepSize, T period);
+
+		/**
+		 * @brief Free receive buffer now, e.g. for idle connection. It's allocated again on next receive. Characters of frame that weren't read are dropped
+		 * @return true if buffer was freed
+		 */
+		bool releaseBuffer();
+
+		/**
+		 * @brief Apply reclamation of setBufferReclamation now, e.g. from timer for idle connections. Buffer isn't shrunk while it has unread characters of frame. View returned by receiveView becomes invalid if buffer is shrunk
+		 * @return true if buffer was shrunk
+		 * @exception WebException
+		 */
+		bool reclaimBuffer();
+
+		/// @brief Memory of receive buffer
+		size_t getBufferSize() const noexcept;
+
+		/**
+		 * @brief Network of buffer
+		 * @return Since 2.0.0 NetworkPointer instead of const std::unique_ptr<web::Network>&, because EmbeddedNetworkBuffer doesn't own its network through heap. Callers that dereference result or use auto are unaffected, callers that bind it to const std::unique_ptr<web::Network>& must use NetworkPointer or web::Network& instead
+		 */
+		const NetworkPointer& getNetwork() const noexcept;
 
 		int getLastPacketSize() const noexcept;
 
@@ -114,13 +177,35 @@ namespace buffers
 
 		~IOSocketBuffer() = default;
 	};
+
+	/// @brief Socket buffer that contains its network instead of separately allocated one
+	template<std::derived_from<web::Network> T>
+	class EmbeddedNetworkBuffer : public IOSocketBuffer
+	{
+	private:
+		T embeddedNetwork;
+
+	public:
+		template<typename... Args>
+		EmbeddedNetworkBuffer(Args&&... args);
+
+		EmbeddedNetworkBuffer(const EmbeddedNetworkBuffer&) = delete;
+
+		EmbeddedNetworkBuffer(EmbeddedNetworkBuffer&&) = delete;
+
+		EmbeddedNetworkBuffer& operator = (const EmbeddedNetworkBuffer&) = delete;
+
+		EmbeddedNetworkBuffer& operator = (EmbeddedNetworkBuffer&&) = delete;
+
+		~EmbeddedNetworkBuffer() = default;
+	};
 }
 
 namespace buffers
 {
 	template<web::Timeout T>
 	IOSocketBuffer::IOSocketBuffer(SOCKET clientSocket, T timeout) :
-		network(std::make_unique<web::Network>(clientSocket, timeout)),
+		network(std::make_unique<web::Network>(clientSocket, timeout).release()),
 		lastPacketSize(0),
 		endOfStream(false)
 	{
@@ -129,10 +214,27 @@ namespace buffers
 
 	template<web::Timeout T>
 	IOSocketBuffer::IOSocketBuffer(std::string_view ip, std::string_view port, T timeout) :
-		network(std::make_unique<web::Network>(ip, port, timeout)),
+		network(std::make_unique<web::Network>(ip, port, timeout).release()),
 		lastPacketSize(0),
 		endOfStream(false)
 	{
 
 	}
+
+	template<web::Timeout T>
+	void IOSocketBuffer::setBufferReclamation(size_t keepSize, T period)
+	{
+		reclaimSize = keepSize;
+		reclaimPeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+		highWaterTime = std::chrono::steady_clock::now();
+	}
+
+	template<std::derived_from<web::Network> T>
+	template<typename... Args>
+	EmbeddedNetworkBuffer<T>::EmbeddedNetworkBuffer(Args&&... args) :
+		IOSocketBuffer(NetworkPointer(&embeddedNetwork, NetworkDeleter{ false })),
+		embeddedNetwork(std::forward<Args>(args)...)
+	{
+
+	}
 }
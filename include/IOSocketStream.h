@@ -1,18 +1,33 @@
 #pragma once
 
+#include <bit>
 #include <istream>
 #include <limits>
+#include <span>
 
 #include "IOSocketBuffer.h"
+#include "ByteOrder.h"
+#include "Serialization.h"
 #include "SocketStreamsUtility.h"
+#include "Varint.h"
 
 namespace streams
 {
+	/// @brief Wire format of integral fundamentals sent with operator <<
+	enum class IntegerEncoding : uint8_t
+	{
+		/// @brief sizeof(T) bytes in native byte order
+		fixed,
+		/// @brief Unsigned LEB128, signed types are zigzag encoded first. 1 byte for values in [-64, 63] or [0, 127], up to 10 bytes
+		varint
+	};
+
 	/// @brief Base input/output socket stream
 	class IOSocketStream : public std::iostream
 	{
 	protected:
 		std::unique_ptr<buffers::IOSocketBuffer> buffer;
+		IntegerEncoding integerEncoding;
 
 	protected:
 		template<web::utility::Fundamental T>
@@ -25,12 +40,31 @@ namespace streams
 
 		virtual int receiveFundamentalImplementation(char* value, int valueSize, bool& endOfStream);
 
+		int sendVarint(uint64_t value, bool& endOfStream);
+
+		/// @exception WebException EBADMSG if value is longer than maxVarint64Size
+		int receiveVarint(uint64_t& value, bool& endOfStream);
+
+		/// @return SOCKET_ERROR with EBADMSG error if value is longer than maxVarint64Size
+		int tryReceiveVarint(uint64_t& value, bool& endOfStream, web::NetworkError& error);
+
+		/// @brief Send wrapped container as one frame through stream buffer
+		std::ostream& sendContainer(const web::utility::ContainerWrapper& container);
+
+		/// @brief Receive one frame into wrapped container through stream buffer
+		std::istream& receiveContainer(web::utility::ContainerWrapper& container);
+
 	private:
 		IOSocketStream(std::unique_ptr<buffers::IOSocketBuffer>&& buffer);
 
 		IOSocketStream(std::unique_ptr<web::Network>&& network);
 
+	private:
+		/// @brief Bigger records without packed layout are serialized into heap buffer
+		static constexpr size_t maxStackRecordSize = 4096;
+
 	public:
+		/// @brief Create stream with network T constructed from args. Network is embedded into stream buffer, so buffer and network take one allocation
 		template<std::derived_from<web::Network> T, typename... Args>
 		static IOSocketStream createStream(Args&&... args);
 
@@ -61,6 +95,13 @@ namespace streams
 		template<std::derived_from<web::Network> T = web::Network>
 		const T& getNetwork() const;
 
+		/// @brief Get I/O counters and latency histograms of underlying Network. Statistics enabled with getNetwork().enableStatistics()
+		web::utility::NetworkStatisticsSnapshot getStatistics() const;
+
+		/// @brief Get kernel TCP state of underlying Network
+		/// @exception WebException
+		web::utility::TcpInfo getTcpInfo() const;
+
 		std::ostream& operator << (bool value);
 		std::ostream& operator << (short value);
 		std::ostream& operator << (int value);
@@ -105,6 +146,151 @@ namespace streams
 		template<web::utility::Container T>
 		std::istream& operator >> (T& data);
 
+		/**
+		 * @brief Send array of trivially copyable elements as one frame
+		 * @tparam Order Byte order on wire. If it isn't native, elements are converted in temporary copy and T must be ByteSwappable
+		 */
+		template<std::endian Order = std::endian::native, web::utility::ArrayElement T, size_t Extent>
+		requires (Order == std::endian::native || web::utility::ByteSwappable<std::remove_const_t<T>>)
+		std::ostream& sendArray(std::span<T, Extent> data);
+
+		template<std::endian Order = std::endian::native, web::utility::ArrayElement T, typename AllocatorT>
+		requires (!std::same_as<T, bool> && (Order == std::endian::native || web::utility::ByteSwappable<T>))
+		std::ostream& sendArray(const std::vector<T, AllocatorT>& data);
+
+		/**
+		 * @brief Receive frame of array. Frame size must be multiple of element size
+		 * @tparam Order Byte order on wire. If it isn't native, elements are converted in place with byteSwap and T must be ByteSwappable
+		 * @param data Resized to received elements. Use web::utility::DefaultInitAllocator to skip zero filling of new elements
+		 * @exception WebException EBADMSG if frame size isn't multiple of element size
+		 */
+		template<std::endian Order = std::endian::native, web::utility::ArrayElement T, typename AllocatorT>
+		requires (!std::same_as<T, bool> && (Order == std::endian::native || web::utility::ByteSwappable<T>))
+		std::istream& receiveArray(std::vector<T, AllocatorT>& data);
+
+		/**
+		 * @brief Receive frame of array into existing memory
+		 * @exception WebException EBADMSG if frame size isn't equal to size of data
+		 */
+		template<std::endian Order = std::endian::native, web::utility::ArrayElement T, size_t Extent>
+		requires (!std::is_const_v<T> && (Order == std::endian::native || web::utility::ByteSwappable<T>))
+		std::istream& receiveArray(std::span<T, Extent> data);
+
+		/// @brief Send array in native byte order with sendArray
+		template<web::utility::ArrayElement T, size_t Extent>
+		std::ostream& operator << (std::span<T, Extent> data);
+
+		/// @brief Send array in native byte order with sendArray. Char vectors are sent as Container
+		template<web::utility::ArrayElement T, typename AllocatorT>
+		requires (!std::same_as<T, bool> && !web::utility::Container<std::vector<T, AllocatorT>>)
+		std::ostream& operator << (const std::vector<T, AllocatorT>& data);
+
+		/// @brief Receive array in native byte order with receiveArray
+		template<web::utility::ArrayElement T, size_t Extent>
+		requires (!std::is_const_v<T>)
+		std::istream& operator >> (std::span<T, Extent> data);
+
+		/// @brief Receive array in native byte order with receiveArray. Char vectors are received as Container
+		template<web::utility::ArrayElement T, typename AllocatorT>
+		requires (!std::same_as<T, bool> && !web::utility::Container<std::vector<T, AllocatorT>>)
+		std::istream& operator >> (std::vector<T, AllocatorT>& data);
+
+		/**
+		 * @brief Send integers as one frame of LEB128 values, signed types are zigzag encoded. Doesn't depend on setIntegerEncoding
+		 * @exception WebException
+		 */
+		template<web::utility::VarintInteger T>
+		std::ostream& sendVarints(std::span<const T> values);
+
+		template<web::utility::VarintInteger T, typename AllocatorT>
+		std::ostream& sendVarints(const std::vector<T, AllocatorT>& values);
+
+		/**
+		 * @brief Receive frame sent with sendVarints. Values are decoded from stream buffer without copy
+		 * @param values Resized to received values
+		 * @exception WebException EBADMSG if frame is malformed
+		 */
+		template<web::utility::VarintInteger T, typename AllocatorT>
+		std::istream& receiveVarints(std::vector<T, AllocatorT>& values);
+
+		/**
+		 * @brief Encoding of integral fundamentals sent with operator << and received with operator >>. Both ends must use same encoding
+		 * @param encoding Default is IntegerEncoding::fixed
+		 */
+		void setIntegerEncoding(IntegerEncoding encoding) noexcept;
+
+		IntegerEncoding getIntegerEncoding() const noexcept;
+
+		/**
+		 * @brief Send fields of record as one frame of web::utility::packedSize<T> bytes
+		 * @param record Aggregate or type with field list. Record with packed layout is sent from its memory
+		 */
+		template<web::utility::Record T>
+		std::ostream& operator << (const T& record);
+
+		/**
+		 * @brief Receive record sent with operator <<
+		 * @exception WebException EBADMSG if frame size isn't web::utility::packedSize<T>
+		 */
+		template<web::utility::Record T>
+		std::istream& operator >> (T& record);
+
+		/**
+		 * @brief Send value like operator << without exceptions. Stream state isn't changed by error
+		 * @param error Set if call failed
+		 * @return Number of sent bytes or SOCKET_ERROR. Sets eofbit if connection closed
+		 */
+		template<web::utility::Fundamental T>
+		int trySend(T value, web::NetworkError& error);
+
+		/**
+		 * @brief Receive value like operator >> without exceptions. Stream state isn't changed by error and bytes of value received before it are kept, so call can be repeated after timeout
+		 * @param error Set if call failed
+		 * @return Number of received bytes or SOCKET_ERROR. Sets eofbit if connection closed
+		 */
+		template<web::utility::Fundamental T>
+		int tryReceive(T& value, web::NetworkError& error);
+
+#ifdef __cpp_lib_expected
+		/// @brief trySend that returns std::expected
+		template<web::utility::Fundamental T>
+		std::expected<int, web::NetworkError> trySend(T value);
+
+		/// @brief tryReceive that returns std::expected
+		template<web::utility::Fundamental T>
+		std::expected<int, web::NetworkError> tryReceive(T& value);
+#endif // __cpp_lib_expected
+
+		/**
+		 * @brief Receive frame without copying it to container. Useful for parse and discard consumers
+		 * @return View into stream buffer, valid until next receive call on this stream. Empty if connection closed
+		 * @exception WebException
+		 */
+		std::string_view receiveView();
+
+		/**
+		 * @brief Shrink receive buffer of stream to keepSize if no frame larger than keepSize was received for period
+		 * @param keepSize Size that buffer isn't shrunk below. 0 disables reclamation
+		 * @param period
+		 */
+		template<web::Timeout T>
+		void setBufferReclamation(size_t keepSize, T period);
+
+		/**
+		 * @brief Free receive buffer of stream now, e.g. for idle connection. It's allocated again on next receive
+		 * @return true if buffer was freed
+		 */
+		bool releaseBuffer();
+
+		/**
+		 * @brief Shrink receive buffer of stream by setBufferReclamation now, e.g. from timer for idle connections
+		 * @return true if buffer was shrunk
+		 */
+		bool reclaimBuffer();
+
+		/// @brief Memory of stream receive buffer. Caller containers aren't included
+		size_t getBufferSize() const noexcept;
+
 		virtual ~IOSocketStream() = default;
 	};
 
@@ -114,7 +300,23 @@ namespace streams
 		try
 		{
 			bool endOfStream = false;
-			int lastPacketSize = this->sendFundamentalImplementation(reinterpret_cast<const char*>(&value), sizeof(value), endOfStream);
+			int lastPacketSize = 0;
+
+			if constexpr (web::utility::VarintInteger<T>)
+			{
+				if (integerEncoding == IntegerEncoding::varint)
+				{
+					lastPacketSize = this->sendVarint(web::utility::toVarint(value), endOfStream);
+				}
+				else
+				{
+					lastPacketSize = this->sendFundamentalImplementation(reinterpret_cast<const char*>(&value), sizeof(value), endOfStream);
+				}
+			}
+			else
+			{
+				lastPacketSize = this->sendFundamentalImplementation(reinterpret_cast<const char*>(&value), sizeof(value), endOfStream);
+			}
 
 			if (endOfStream)
 			{
@@ -137,7 +339,30 @@ namespace streams
 		try
 		{
 			bool endOfStream = false;
-			int lastPacketSize = this->receiveFundamentalImplementation(reinterpret_cast<char*>(&value), sizeof(value), endOfStream);
+			int lastPacketSize = 0;
+
+			if constexpr (web::utility::VarintInteger<T>)
+			{
+				if (integerEncoding == IntegerEncoding::varint)
+				{
+					uint64_t encoded = 0;
+
+					lastPacketSize = this->receiveVarint(encoded, endOfStream);
+
+					if (!endOfStream)
+					{
+						value = web::utility::fromVarint<T>(encoded);
+					}
+				}
+				else
+				{
+					lastPacketSize = this->receiveFundamentalImplementation(reinterpret_cast<char*>(&value), sizeof(value), endOfStream);
+				}
+			}
+			else
+			{
+				lastPacketSize = this->receiveFundamentalImplementation(reinterpret_cast<char*>(&value), sizeof(value), endOfStream);
+			}
 
 			if (endOfStream)
 			{
@@ -154,10 +379,110 @@ namespace streams
 		}
 	}
 
+	template<web::utility::Fundamental T>
+	int IOSocketStream::trySend(T value, web::NetworkError& error)
+	{
+		web::Network& network = *buffer->getNetwork();
+		bool endOfStream = false;
+		int result = 0;
+
+		if constexpr (web::utility::VarintInteger<T>)
+		{
+			if (integerEncoding == IntegerEncoding::varint)
+			{
+				char encoded[web::utility::maxVarint64Size];
+
+				result = network.trySendBytes(encoded, static_cast<int>(web::utility::encodeVarint(web::utility::toVarint(value), encoded)), endOfStream, error);
+			}
+			else
+			{
+				result = network.trySendBytes(&value, sizeof(value), endOfStream, error);
+			}
+		}
+		else
+		{
+			result = network.trySendBytes(&value, sizeof(value), endOfStream, error);
+		}
+
+		if (endOfStream)
+		{
+			setstate(std::ios_base::eofbit);
+		}
+
+		return result;
+	}
+
+	template<web::utility::Fundamental T>
+	int IOSocketStream::tryReceive(T& value, web::NetworkError& error)
+	{
+		bool endOfStream = false;
+		int result = 0;
+
+		if constexpr (web::utility::VarintInteger<T>)
+		{
+			if (integerEncoding == IntegerEncoding::varint)
+			{
+				uint64_t encoded = 0;
+
+				result = this->tryReceiveVarint(encoded, endOfStream, error);
+
+				if (result != SOCKET_ERROR && !endOfStream)
+				{
+					value = web::utility::fromVarint<T>(encoded);
+				}
+			}
+			else
+			{
+				result = buffer->getNetwork()->tryReceiveBytes(&value, sizeof(value), endOfStream, error);
+			}
+		}
+		else
+		{
+			result = buffer->getNetwork()->tryReceiveBytes(&value, sizeof(value), endOfStream, error);
+		}
+
+		if (endOfStream)
+		{
+			setstate(std::ios_base::eofbit);
+		}
+
+		return result;
+	}
+
+#ifdef __cpp_lib_expected
+	template<web::utility::Fundamental T>
+	std::expected<int, web::NetworkError> IOSocketStream::trySend(T value)
+	{
+		web::NetworkError error = {};
+		int result = this->trySend(value, error);
+
+		if (result == SOCKET_ERROR)
+		{
+			return std::unexpected(error);
+		}
+
+		return result;
+	}
+
+	template<web::utility::Fundamental T>
+	std::expected<int, web::NetworkError> IOSocketStream::tryReceive(T& value)
+	{
+		web::NetworkError error = {};
+		int result = this->tryReceive(value, error);
+
+		if (result == SOCKET_ERROR)
+		{
+			return std::unexpected(error);
+		}
+
+		return result;
+	}
+#endif // __cpp_lib_expected
+
 	template<std::derived_from<web::Network> T, typename... Args>
 	IOSocketStream IOSocketStream::createStream(Args&&... args)
 	{
-		return IOSocketStream(std::make_unique<T>(std::forward<Args>(args)...));
+		return IOSocketStream(std::make_unique<buffers::EmbeddedNetworkBuffer<T>>(std::forward<Args>(args)...));
 	}
 
 	template<std::derived_from<buffers::IOSocketBuffer> T, typename... Args>
@@ -166,6 +491,12 @@ namespace streams
 		return IOSocketStream(std::make_unique<T>(std::forward<Args>(args)...));
 	}
 
+	template<web::Timeout T>
+	void IOSocketStream::setBufferReclamation(size_t keepSize, T period)
+	{
+		buffer->setBufferReclamation(keepSize, period);
+	}
+
 	template<std::derived_from<web::Network> T>
 	T& IOSocketStream::getNetwork()
 	{
@@ -196,43 +527,237 @@ namespace streams
 	std::ostream& IOSocketStream::operator << (const T& data)
 	{
 		web::utility::ContainerWrapper container(const_cast<T&>(data));
-		constexpr std::streamsize size = (std::numeric_limits<std::streamsize>::max)();
 
-		try
+		return this->sendContainer(container);
+	}
+
+	template<web::utility::Container T>
+	std::istream& IOSocketStream::operator >> (T& data)
+	{
+		web::utility::ContainerWrapper container(data);
+
+		return this->receiveContainer(container);
+	}
+
+	template<std::endian Order, web::utility::ArrayElement T, size_t Extent>
+	requires (Order == std::endian::native || web::utility::ByteSwappable<std::remove_const_t<T>>)
+	std::ostream& IOSocketStream::sendArray(std::span<T, Extent> data)
+	{
+		if constexpr (Order == std::endian::native || sizeof(T) == 1)
 		{
-			if (buffer->sputn(reinterpret_cast<const char*>(&container), size) == buffers::IOSocketBuffer::traits_type::eof())
-			{
-				setstate(std::ios_base::eofbit);
-			}
+			web::utility::ArrayWrapper container(data);
+
+			return this->sendContainer(container);
 		}
-		catch (const web::exceptions::WebException&)
+		else
+		{
+			std::vector<std::remove_const_t<T>, web::utility::DefaultInitAllocator<std::remove_const_t<T>>> converted(data.size());
+			web::utility::ArrayWrapper container(converted);
+
+			web::utility::byteSwap(data.data(), converted.data(), data.size(), sizeof(T));
+
+			return this->sendContainer(container);
+		}
+	}
+
+	template<std::endian Order, web::utility::ArrayElement T, typename AllocatorT>
+	requires (!std::same_as<T, bool> && (Order == std::endian::native || web::utility::ByteSwappable<T>))
+	std::ostream& IOSocketStream::sendArray(const std::vector<T, AllocatorT>& data)
+	{
+		return this->sendArray<Order>(std::span<const T>(data));
+	}
+
+	template<std::endian Order, web::utility::ArrayElement T, typename AllocatorT>
+	requires (!std::same_as<T, bool> && (Order == std::endian::native || web::utility::ByteSwappable<T>))
+	std::istream& IOSocketStream::receiveArray(std::vector<T, AllocatorT>& data)
+	{
+		web::utility::ArrayWrapper container(data);
+
+		this->receiveContainer(container);
+
+		if (this->eof())
+		{
+			return *this;
+		}
+
+		// Receive only grows container, smaller frame leaves old elements after it
+		data.resize(static_cast<size_t>(buffer->getLastPacketSize()) / sizeof(T));
+
+		if constexpr (Order != std::endian::native)
+		{
+			web::utility::convertByteOrder<Order>(std::span<T>(data));
+		}
+
+		return *this;
+	}
+
+	template<std::endian Order, web::utility::ArrayElement T, size_t Extent>
+	requires (!std::is_const_v<T> && (Order == std::endian::native || web::utility::ByteSwappable<T>))
+	std::istream& IOSocketStream::receiveArray(std::span<T, Extent> data)
+	{
+		web::utility::ArrayWrapper container(data);
+
+		this->receiveContainer(container);
+
+		if (this->eof())
+		{
+			return *this;
+		}
+
+		// Network may fill only beginning of container without resizing it
+		if (static_cast<size_t>(buffer->getLastPacketSize()) != data.size_bytes())
 		{
 			setstate(std::ios_base::failbit);
 
-			throw;
+			throw web::exceptions::WebException(EBADMSG, "Frame size doesn't match array size", __LINE__, __FILE__);
+		}
+
+		if constexpr (Order != std::endian::native)
+		{
+			web::utility::convertByteOrder<Order>(std::span<T>(data));
 		}
 
 		return *this;
 	}
 
-	template<web::utility::Container T>
-	std::istream& IOSocketStream::operator >> (T& data)
+	template<web::utility::ArrayElement T, size_t Extent>
+	std::ostream& IOSocketStream::operator << (std::span<T, Extent> data)
 	{
-		web::utility::ContainerWrapper container(data);
-		constexpr std::streamsize size = (std::numeric_limits<std::streamsize>::max)();
+		return this->sendArray(data);
+	}
 
-		try
+	template<web::utility::ArrayElement T, typename AllocatorT>
+	requires (!std::same_as<T, bool> && !web::utility::Container<std::vector<T, AllocatorT>>)
+	std::ostream& IOSocketStream::operator << (const std::vector<T, AllocatorT>& data)
+	{
+		return this->sendArray(data);
+	}
+
+	template<web::utility::ArrayElement T, size_t Extent>
+	requires (!std::is_const_v<T>)
+	std::istream& IOSocketStream::operator >> (std::span<T, Extent> data)
+	{
+		return this->receiveArray(data);
+	}
+
+	template<web::utility::ArrayElement T, typename AllocatorT>
+	requires (!std::same_as<T, bool> && !web::utility::Container<std::vector<T, AllocatorT>>)
+	std::istream& IOSocketStream::operator >> (std::vector<T, AllocatorT>& data)
+	{
+		return this->receiveArray(data);
+	}
+
+	template<web::utility::VarintInteger T>
+	std::ostream& IOSocketStream::sendVarints(std::span<const T> values)
+	{
+		web::utility::UninitializedBuffer encoded(values.size() * web::utility::maxVarint64Size);
+		web::utility::ContainerWrapper container(encoded);
+
+		encoded.resize(web::utility::encodeVarints(values, encoded.data()));
+
+		return this->sendContainer(container);
+	}
+
+	template<web::utility::VarintInteger T, typename AllocatorT>
+	std::ostream& IOSocketStream::sendVarints(const std::vector<T, AllocatorT>& values)
+	{
+		return this->sendVarints(std::span<const T>(values));
+	}
+
+	template<web::utility::VarintInteger T, typename AllocatorT>
+	std::istream& IOSocketStream::receiveVarints(std::vector<T, AllocatorT>& values)
+	{
+		std::string_view encoded = this->receiveView();
+
+		if (this->eof())
+		{
+			return *this;
+		}
+
+		values.resize(web::utility::countVarints(encoded.data(), encoded.size()));
+
+		if (web::utility::decodeVarints(encoded.data(), encoded.size(), std::span<T>(values)) != encoded.size())
+		{
+			setstate(std::ios_base::failbit);
+
+			throw web::exceptions::WebException(EBADMSG, "Malformed varint frame", __LINE__, __FILE__);
+		}
+
+		return *this;
+	}
+
+	template<web::utility::Record T>
+	std::ostream& IOSocketStream::operator << (const T& record)
+	{
+		constexpr size_t size = web::utility::packedSize<T>;
+
+		if constexpr (web::utility::hasPackedLayout<T>)
+		{
+			web::utility::ArrayWrapper container(std::span<const char, size>(reinterpret_cast<const char*>(&record), size));
+
+			return this->sendContainer(container);
+		}
+		else
 		{
-			if (buffer->sgetn(reinterpret_cast<char*>(&container), size) == buffers::IOSocketBuffer::traits_type::eof())
+			std::conditional_t<(size <= maxStackRecordSize), std::array<char, size>, web::utility::UninitializedBuffer> data;
+
+			if constexpr (size > maxStackRecordSize)
 			{
-				setstate(std::ios_base::eofbit);
+				data.resize(size);
 			}
+
+			web::utility::ArrayWrapper container(std::span<char, size>(data.data(), size));
+
+			web::utility::serialize(record, data.data());
+
+			return this->sendContainer(container);
 		}
-		catch (const web::exceptions::WebException&)
+	}
+
+	template<web::utility::Record T>
+	std::istream& IOSocketStream::operator >> (T& record)
+	{
+		constexpr size_t size = web::utility::packedSize<T>;
+		constexpr size_t stackSize = web::utility::hasPackedLayout<T> ? 0 : size;
+
+		// Record with packed layout is received directly into its memory, so it doesn't need storage
+		std::conditional_t<(stackSize <= maxStackRecordSize), std::array<char, stackSize>, web::utility::UninitializedBuffer> data;
+		char* frame = nullptr;
+
+		if constexpr (web::utility::hasPackedLayout<T>)
+		{
+			frame = reinterpret_cast<char*>(&record);
+		}
+		else
+		{
+			if constexpr (size > maxStackRecordSize)
+			{
+				data.resize(size);
+			}
+
+			frame = data.data();
+		}
+
+		web::utility::ArrayWrapper container(std::span<char, size>(frame, size));
+
+		this->receiveContainer(container);
+
+		if (this->eof())
+		{
+			return *this;
+		}
+
+		// Network that doesn't resize container may fill only its beginning
+		if (static_cast<size_t>(buffer->getLastPacketSize()) != size)
 		{
 			setstate(std::ios_base::failbit);
 
-			throw;
+			throw web::exceptions::WebException(EBADMSG, "Frame size doesn't match record size", __LINE__, __FILE__);
+		}
+
+		if constexpr (!web::utility::hasPackedLayout<T>)
+		{
+			web::utility::deserialize(record, data.data());
 		}
 
 		return *this;
@@ -7,6 +7,17 @@
 #include <any>
 #include <memory>
 #include <chrono>
+#include <array>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <version>
+
+#ifdef __cpp_lib_expected
+#include <expected>
+#endif // __cpp_lib_expected
 
 #ifdef __LINUX__
 #include <sys/types.h>
@@ -22,7 +33,14 @@
 #endif // __LINUX__
 
 #include "WebException.h"
+#include "NetworkError.h"
 #include "ContainerWrapper.h"
+#include "NetworkStatistics.h"
+#include "TcpInfo.h"
+#include "NetworkObserver.h"
+#include "Timestamping.h"
+#include "Crc32c.h"
+#include "Varint.h"
 
 #ifndef __LINUX__
 #pragma comment (lib, "ws2_32.lib")
@@ -43,6 +61,30 @@
 
 namespace web
 {
+	namespace utility
+	{
+		class TcpInfoSampler;
+
+		/// @brief FIFO of buffers added by Network::addReceiveBuffer. Doesn't allocate until first buffer and reuses its storage after it's drained
+		class ReceivePrefixQueue
+		{
+		private:
+			std::vector<std::string_view> buffers;
+			size_t head = 0;
+
+		public:
+			ReceivePrefixQueue() = default;
+
+			size_t size() const noexcept;
+
+			std::string_view& front() noexcept;
+
+			void push(std::string_view buffer);
+
+			void pop() noexcept;
+		};
+	}
+
 	template<typename T>
 	concept Timeout = requires(T value)
 	{
@@ -51,20 +93,151 @@ namespace web
 
 	using namespace std::chrono_literals;
 
+	/// @brief Size header format of frames
+	enum class FrameHeader : uint8_t
+	{
+		/// @brief 4 byte int
+		fixed,
+		/// @brief Unsigned LEB128, 1 byte for frames smaller than 128 bytes, up to 5 bytes
+		varint,
+		/// @brief 8 byte int64, required for frames larger than 2 GiB
+		large
+	};
+
 	/// @brief Base network class
 	class Network
 	{
+	public:
+		/// @brief Default size of pieces passed to callback of receiveChunkedData
+		static constexpr int64_t defaultChunkSize = 64 * 1024;
+
 	protected:
 		std::shared_ptr<SOCKET> handle;
-		std::queue<std::string_view> buffers;
+		utility::ReceivePrefixQueue buffers;
+		/// @brief Declared without SOCKET_STREAMS_STATISTICS too, so layout and inline code don't depend on it. Null until enableStatistics
+		std::shared_ptr<utility::NetworkStatistics> statistics;
+		std::shared_ptr<utility::NetworkObserver> observer;
+		std::shared_ptr<utility::TimestampingState> timestamping;
+		std::chrono::microseconds busyPollTime = std::chrono::microseconds(0);
+		bool frameChecksum = false;
+		FrameHeader frameHeader = FrameHeader::fixed;
+		/// @brief Payload bytes received together with varint header
+		std::array<char, utility::maxVarint32Size - 1> headerOverflow = {};
+		int headerOverflowSize = 0;
+		int maxFrameSize = (std::numeric_limits<int>::max)();
+		/// @brief Storage of bytes returned by restoreReceivedBytes, referenced from buffers
+		std::string restoredBytes;
 
 	protected:
 		virtual int sendBytesImplementation(const char* data, int size, int flags = 0);
 
 		virtual int receiveBytesImplementation(char* data, int size, int flags = 0);
 
+		/**
+		 * @brief Receive into several buffers. Uses one system call(recvmsg/WSARecv) only for Network itself without timestamping and busy polling, otherwise fills buffers one after another with receiveBytesImplementation, so subclasses that override receiveBytesImplementation keep working
+		 * @param buffers Non empty buffers
+		 * @return Number of received bytes, 0 if connection closed, SOCKET_ERROR on error
+		 */
+		virtual int receiveBuffersImplementation(std::span<const std::span<char>> buffers, int flags = 0);
+
+		/// @brief Stream oriented network receives exactly requested size in receiveBytes. Message oriented subclasses return false, so receiveBytes returns after one message
+		virtual bool isStreamOriented() const noexcept;
+
 		virtual void throwException(int line, std::string_view file) const;
 
+		/// @brief Throw error of non throwing call through throwException(line, file)
+		[[noreturn]] void throwException(const NetworkError& error) const;
+
+	private:
+		/// @brief sendBytes without exceptions
+		/// @return Total number of sent bytes or SOCKET_ERROR with error set
+		int sendBytesWithoutException(const char* data, int size, bool& endOfStream, int flags, NetworkError& error);
+
+		/// @brief receiveBytes without exceptions. Bytes received before error are restored with restoreReceivedBytes
+		/// @return Total number of received bytes or SOCKET_ERROR with error set
+		int receiveBytesWithoutException(char* data, int size, bool& endOfStream, int flags, NetworkError& error);
+
+		/// @brief Frame of sendData/sendRawData without exceptions and observer events
+		/// @return Number of sent payload bytes or SOCKET_ERROR with error set
+		int sendFrameWithoutException(const char* data, int size, bool& endOfStream, int flags, NetworkError& error);
+
+		/// @brief Frame of receiveData without exceptions and observer events. Frame received before system error is restored with restoreReceivedBytes, invalid frame is dropped
+		/// @return Number of received payload bytes or SOCKET_ERROR with error set
+		int receiveFrameWithoutException(utility::ContainerWrapper& data, bool& endOfStream, int flags, NetworkError& error);
+
+		/// @brief sendFrameWithoutException between observer events of sendData
+		int trySendFrame(const char* data, int size, bool& endOfStream, NetworkError& error, int flags);
+
+		/// @brief receiveFrameWithoutException between observer events of receiveData
+		int tryReceiveFrame(utility::ContainerWrapper& data, bool& endOfStream, NetworkError& error, int flags);
+
+		/// @brief Size header in current format without checksum
+		/// @param header At least maxFrameHeaderSize bytes
+		/// @return Size of header
+		size_t encodeSizeHeader(int64_t size, char* header) const noexcept;
+
+		/// @brief Return header of frame which payload failed to arrive, so next receive starts from whole frame
+		void restoreFrameHeader(int size, uint32_t checksum);
+
+		/// @brief Receive and drop size bytes of payload
+		/// @return 0 or SOCKET_ERROR with error set
+		int dropFramePayload(int64_t size, bool& endOfStream, int flags, NetworkError& error);
+
+	protected:
+		static utility::TcpInfo getTcpInfo(SOCKET socket);
+
+		/// @brief Shared handle that closes socket, socket and control block are allocated together
+		static std::shared_ptr<SOCKET> createHandle(SOCKET socket);
+
+		/// @brief Own observer or global one
+		std::shared_ptr<utility::NetworkObserver> getActiveObserver() const;
+
+		/// @brief Call function between begin and end events of active observer
+		/// @param error Set by function that returns SOCKET_ERROR instead of throwing
+		template<typename FunctionT>
+		int observe(utility::NetworkOperation operation, int size, bool& endOfStream, const FunctionT& function, const NetworkError* error = nullptr);
+
+		/// @brief Send size header in current format
+		/// @exception WebException Size doesn't fit format
+		int sendSizeHeader(int64_t size, bool& endOfStream, int flags);
+
+		/// @brief Receive size header in current format. Bytes of varint header received before system error are restored with restoreReceivedBytes
+		/// @return Header size or SOCKET_ERROR with error set
+		int receiveSizeHeader(int64_t& size, bool& endOfStream, int flags, NetworkError& error);
+
+		/// @brief Throw if frames can't be sent or received in pieces
+		void checkChunkedMode() const;
+
+		/**
+		 * @brief Fail with EBADMSG if size is negative or EMSGSIZE if frame received into container is larger than maxFrameSize
+		 * Before EMSGSIZE unread payload is received and dropped, so next frame can still be received
+		 * @param size Frame size
+		 * @param payloadSize Bytes of frame that are still in socket
+		 * @return 0 or SOCKET_ERROR with error set
+		 */
+		int checkFrameSize(int64_t size, int64_t payloadSize, int flags, NetworkError& error);
+
+		/// @brief checkFrameSize that throws error
+		/// @exception WebException
+		void checkFrameSize(int64_t size, int64_t payloadSize, int flags);
+
+		/// @brief Send size header. If frame checksum enabled header also contains payload checksum and own checksum
+		/// @return Header size or SOCKET_ERROR with error set
+		int sendFrameHeader(const char* data, int size, bool& endOfStream, int flags, NetworkError& error);
+
+		/// @brief Receive size header and verify its checksum if frame checksum enabled
+		/// @param checksum Payload checksum if frame checksum enabled
+		/// @return Header size or SOCKET_ERROR with error set
+		int receiveFrameHeader(int& size, uint32_t& checksum, bool& endOfStream, int flags, NetworkError& error);
+
+		/// @brief Receive frame payload after receiveFrameHeader, starting with bytes that were received together with header
+		/// @return Number of received bytes or SOCKET_ERROR with error set. Bytes received before error are restored with restoreReceivedBytes
+		int receiveFramePayload(char* data, int size, bool& endOfStream, int flags, NetworkError& error);
+
+		/// @brief Fill buffers with frame payload after receiveFrameHeader. Unlike receiveFramePayload doesn't return until all buffers are filled
+		/// @return Number of received bytes, 0 if connection closed
+		int receiveFrameBuffers(std::span<std::span<char>> buffers, bool& endOfStream, int flags);
+
 	protected:
 		void setTimeout(int64_t timeout);
 
@@ -128,16 +301,189 @@ namespace web
 		*/
 		virtual int receiveRawData(char* data, int size, bool& endOfStream, int flags = 0);
 
+		/**
+		 * @brief Receive frame into fixed size header and body container resized to rest of frame. Both are filled directly by one recvmsg(WSARecv) call if whole frame is available
+		 * @param header Fixed size start of frame
+		 * @param body Container for rest of frame, only grows like in receiveData
+		 * @param endOfStream Is connection closed
+		 * @return Frame size
+		 * @exception WebException Frame is smaller than header(EBADMSG)
+		 */
+		virtual int receiveScatteredData(std::span<char> header, utility::ContainerWrapper& body, bool& endOfStream, int flags = 0);
+
+		/**
+		 * @brief Receive frame into header struct and body container resized to rest of frame
+		 * @param header Trivially copyable struct sent as start of frame
+		 * @param body Container for rest of frame
+		 * @param endOfStream Is connection closed
+		 * @return Frame size
+		 * @exception WebException Frame is smaller than header(EBADMSG)
+		 */
+		template<typename HeaderT> requires std::is_trivially_copyable_v<HeaderT>
+		int receiveScatteredData(HeaderT& header, utility::ContainerWrapper& body, bool& endOfStream, int flags = 0);
+
 		/**
 		 * @brief Add additional data that uses before getting bytes from network
 		 * @param buffer
 		 */
 		void addReceiveBuffer(std::string_view buffer);
 
+		/**
+		 * @brief Return bytes to network, so next receive starts with them. Used for bytes received before error of non throwing call, so it can be repeated
+		 * @param data Copied before pending receive buffers
+		 */
+		void restoreReceivedBytes(std::string_view data);
+
+		/// @brief Received data is buffered in this object, so next receive doesn't wait for socket
+		virtual bool hasPendingInput() const noexcept;
+
 		/// @brief clientSocket getter
 		/// @return clientSocket
 		SOCKET getClientSocket() const;
 
+		/**
+		 * @brief Start or stop collecting I/O counters and latency histograms
+		 * @param enable
+		 * @return false if library built without SOCKET_STREAMS_STATISTICS
+		 */
+		bool enableStatistics(bool enable = true);
+
+		bool isStatisticsEnabled() const noexcept;
+
+		/**
+		 * @brief Get current I/O counters and latency histograms
+		 * @return Empty snapshot if statistics disabled
+		 */
+		utility::NetworkStatisticsSnapshot getStatistics() const;
+
+		void resetStatistics();
+
+		/**
+		 * @brief Get kernel TCP state: RTT, congestion window, retransmits, delivery rate, limited times
+		 * @return Unsupported by platform values are 0
+		 * @exception WebException
+		 */
+		utility::TcpInfo getTcpInfo() const;
+
+		/**
+		 * @brief Set observer of this Network calls. Overrides global observer(NetworkObserver::setGlobal)
+		 * @param observer nullptr removes observer
+		 */
+		void setObserver(const std::shared_ptr<utility::NetworkObserver>& observer);
+
+		std::shared_ptr<utility::NetworkObserver> getObserver() const;
+
+		/**
+		 * @brief Start or stop collecting kernel software receive/transmit timestamps(SO_TIMESTAMPING) of frames
+		 * @param enable
+		 * @return false if not supported by platform
+		 * @exception WebException
+		 */
+		bool enableTimestamping(bool enable = true);
+
+		bool isTimestampingEnabled() const noexcept;
+
+		/// @brief Timestamps of last frame returned by receiveData/receiveRawData
+		std::optional<utility::ReceiveTimestamps> getReceiveTimestamps() const;
+
+		/**
+		 * @brief Read transmit timestamps from socket error queue without blocking
+		 * @return Frames sent by sendData/sendRawData that are acknowledged by peer, in send order
+		 * @exception WebException
+		 */
+		std::vector<utility::SendTimestamps> getSendTimestamps();
+
+		/**
+		 * @brief Spin on non blocking receive before falling back to blocking receive. Trades CPU for scheduler wakeup latency
+		 * @param spinTime Spin duration. 0 disables busy polling
+		 * @param kernelBusyPoll Also set SO_BUSY_POLL and SO_PREFER_BUSY_POLL so kernel polls device queue(Linux only). Values above net.core.busy_read require CAP_NET_ADMIN
+		 * @exception WebException
+		 */
+		void setBusyPoll(std::chrono::microseconds spinTime, bool kernelBusyPoll = false);
+
+		std::chrono::microseconds getBusyPoll() const noexcept;
+
+		/**
+		 * @brief Protect frames(sendData/sendRawData) with CRC32C. Size header is followed by CRC32C of payload and CRC32C of header itself
+		 * Header is verified before container resized, payload after it received. Both sides must use same mode. Mismatch throws WebException with EBADMSG error code
+		 * @param enable
+		 * @return false if frame format of this Network doesn't support checksums
+		 */
+		virtual bool enableFrameChecksum(bool enable = true);
+
+		bool isFrameChecksumEnabled() const noexcept;
+
+		/**
+		 * @brief Set size header format of frames(sendData/sendRawData). Both sides must use same format, see negotiateFrameHeader
+		 * Frame checksum mode has own header and ignores this format
+		 * @param header
+		 * @return false if frame format of this Network doesn't support header
+		 */
+		virtual bool setFrameHeader(FrameHeader header);
+
+		FrameHeader getFrameHeader() const noexcept;
+
+		/**
+		 * @brief Exchange preferred header formats with peer and select one both sides can use. Both sides must call it before first frame
+		 * FrameHeader::large wins if either side prefers it, otherwise FrameHeader::fixed if either side prefers it, otherwise FrameHeader::varint
+		 * @param preferred FrameHeader::large if this side sends frames over 2 GiB, otherwise most compact format this side supports
+		 * @return Negotiated format
+		 * @exception WebException EPROTO if peer sent unknown format or this Network doesn't support negotiated one
+		 */
+		FrameHeader negotiateFrameHeader(FrameHeader preferred = FrameHeader::varint);
+
+		/**
+		 * @brief Limit frames that receiveData grows container for. Bigger frame is rejected with EMSGSIZE before container is resized, its payload is received in pieces and dropped, so connection stays usable.
+		 * Frames of any size can still be streamed with receiveFrameChunks/receiveChunkedData
+		 * @param maxFrameSize
+		 */
+		void setMaxFrameSize(int maxFrameSize) noexcept;
+
+		int getMaxFrameSize() const noexcept;
+
+		/**
+		 * @brief Send frame from memory. Size isn't limited by int with FrameHeader::large
+		 * @return Total number of sent payload bytes
+		 * @exception WebException Size doesn't fit frame header or frame checksum enabled
+		 */
+		int64_t sendLargeData(const char* data, int64_t size, bool& endOfStream, int flags = 0);
+
+		/**
+		 * @brief Send size header of frame which payload is sent by following sendBytes calls with size bytes in total
+		 * @exception WebException Size doesn't fit frame header or frame checksum enabled
+		 */
+		int sendFrameSize(int64_t size, bool& endOfStream, int flags = 0);
+
+		/**
+		 * @brief Receive size header of frame which payload is received with receiveFrameChunks
+		 * @return Payload size, 0 if connection closed
+		 * @exception WebException
+		 */
+		int64_t receiveFrameSize(bool& endOfStream, int flags = 0);
+
+		/**
+		 * @brief Receive size bytes of payload after receiveFrameSize and pass them to callback in pieces. Memory usage doesn't depend on frame size
+		 * @param callback Called with pieces not larger than chunkSize
+		 * @return Total number of received payload bytes
+		 * @exception WebException
+		 */
+		int64_t receiveFrameChunks(int64_t size, const std::function<void(std::string_view)>& callback, bool& endOfStream, int64_t chunkSize = defaultChunkSize, int flags = 0);
+
+		/**
+		 * @brief Receive frame sent by sendData, sendRawData, sendLargeData or sendFrameSize and pass payload to callback in pieces
+		 * @return Total number of received payload bytes
+		 * @exception WebException
+		 */
+		int64_t receiveChunkedData(const std::function<void(std::string_view)>& callback, bool& endOfStream, int64_t chunkSize = defaultChunkSize, int flags = 0);
+
+		/**
+		 * @brief Receive frame and copy payload to output in pieces
+		 * @return Output after last written byte
+		 * @exception WebException
+		 */
+		template<std::output_iterator<char> OutputT>
+		OutputT receiveChunkedData(OutputT output, bool& endOfStream, int64_t chunkSize = defaultChunkSize, int flags = 0);
+
 		/// @brief Send raw bytes through network
 		/// @tparam DataT 
 		/// @param data 
@@ -154,19 +500,93 @@ namespace web
 		/// @param data 
 		/// @param size 
 		/// @param endOfStream 
-		/// @param flags
-		/// @return Total number of received bytes 
+		/// @param flags MSG_PEEK and MSG_DONTWAIT return after one receive call
+		/// @return Total number of received bytes. Stream oriented network receives exactly size bytes unless connection closed
 		/// @exception WebException  
 		template<typename DataT>
 		int receiveBytes(DataT* data, int size, bool& endOfStream, int flags = 0);
 
+		/**
+		 * @brief sendBytes without exceptions for loops where timeouts are routine. Error path doesn't allocate
+		 * @param error Set if call failed
+		 * @return Total number of sended bytes or SOCKET_ERROR. Bytes sent before error aren't sent again by repeated call
+		 */
+		template<typename DataT>
+		int trySendBytes(const DataT* data, int size, bool& endOfStream, NetworkError& error, int flags = 0);
+
+		/**
+		 * @brief receiveBytes without exceptions for loops where timeouts are routine. Error path doesn't allocate unless part of data was received before error
+		 * @param error Set if call failed
+		 * @return Total number of received bytes or SOCKET_ERROR. Bytes received before error are returned by next receive, so call can be repeated
+		 */
+		template<typename DataT>
+		int tryReceiveBytes(DataT* data, int size, bool& endOfStream, NetworkError& error, int flags = 0);
+
+		/**
+		 * @brief sendData without exceptions
+		 * @param error Set if call failed
+		 * @return Total number of sent bytes or SOCKET_ERROR. Frame that failed in the middle leaves connection out of sync
+		 */
+		int trySendData(const utility::ContainerWrapper& data, bool& endOfStream, NetworkError& error, int flags = 0);
+
+		/**
+		 * @brief receiveData without exceptions. Frame received before timeout is returned by next receive, so call can be repeated. Invalid frame header or checksum mismatch is returned as error too
+		 * Subclasses that override receiveData are called through it and its exceptions are converted to error
+		 * @param error Set if call failed
+		 * @return Total number of received bytes or SOCKET_ERROR. Exceptions of container(e.g. ENOBUFS of memory budget) aren't converted
+		 */
+		int tryReceiveData(utility::ContainerWrapper& data, bool& endOfStream, NetworkError& error, int flags = 0);
+
+#ifdef __cpp_lib_expected
+		/// @brief trySendBytes that returns std::expected
+		template<typename DataT>
+		std::expected<int, NetworkError> trySendBytes(const DataT* data, int size, bool& endOfStream, int flags = 0);
+
+		/// @brief tryReceiveBytes that returns std::expected
+		template<typename DataT>
+		std::expected<int, NetworkError> tryReceiveBytes(DataT* data, int size, bool& endOfStream, int flags = 0);
+
+		/// @brief trySendData that returns std::expected
+		std::expected<int, NetworkError> trySendData(const utility::ContainerWrapper& data, bool& endOfStream, int flags = 0);
+
+		/// @brief tryReceiveData that returns std::expected
+		std::expected<int, NetworkError> tryReceiveData(utility::ContainerWrapper& data, bool& endOfStream, int flags = 0);
+#endif // __cpp_lib_expected
+
 		virtual ~Network() = default;
+
+		friend class utility::TcpInfoSampler;
 	};
 
 }
 
 namespace web
 {
+	inline size_t utility::ReceivePrefixQueue::size() const noexcept
+	{
+		return buffers.size() - head;
+	}
+
+	inline std::string_view& utility::ReceivePrefixQueue::front() noexcept
+	{
+		return buffers[head];
+	}
+
+	inline void utility::ReceivePrefixQueue::push(std::string_view buffer)
+	{
+		buffers.push_back(buffer);
+	}
+
+	inline void utility::ReceivePrefixQueue::pop() noexcept
+	{
+		if (++head == buffers.size())
+		{
+			buffers.clear();
+
+			head = 0;
+		}
+	}
+
 	template<typename FunctionT, typename... Args>
 	auto Network::callInNonBlockingMode(const FunctionT& functor, Args&&... args) const -> decltype(std::declval<FunctionT>()(std::forward<Args>(args)...))
 	{
@@ -208,6 +628,82 @@ namespace web
 		return result;
 	}
 
+	template<typename FunctionT>
+	int Network::observe(utility::NetworkOperation operation, int size, bool& endOfStream, const FunctionT& function, const NetworkError* error)
+	{
+		std::shared_ptr<utility::NetworkObserver> activeObserver = this->getActiveObserver();
+
+		if (!activeObserver)
+		{
+			return function();
+		}
+
+		utility::NetworkEvent event = { operation, static_cast<int64_t>(this->getClientSocket()), std::chrono::steady_clock::now(), size, 0, false };
+
+		activeObserver->onBegin(event);
+
+		int result = 0;
+
+		try
+		{
+			result = function();
+		}
+		catch (const exceptions::WebException& e)
+		{
+			event.timestamp = std::chrono::steady_clock::now();
+			event.bytes = 0;
+			event.errorCode = e.getErrorCode();
+
+			activeObserver->onEnd(event);
+
+			throw;
+		}
+		catch (...)
+		{
+			event.timestamp = std::chrono::steady_clock::now();
+			event.bytes = 0;
+			event.errorCode = -1;
+
+			activeObserver->onEnd(event);
+
+			throw;
+		}
+
+		event.timestamp = std::chrono::steady_clock::now();
+
+		if (error && result == SOCKET_ERROR)
+		{
+			event.bytes = 0;
+			event.errorCode = error->errorCode;
+		}
+		else
+		{
+			event.bytes = result;
+			event.endOfStream = endOfStream;
+		}
+
+		activeObserver->onEnd(event);
+
+		return result;
+	}
+
+	template<std::output_iterator<char> OutputT>
+	OutputT Network::receiveChunkedData(OutputT output, bool& endOfStream, int64_t chunkSize, int flags)
+	{
+		this->receiveChunkedData
+		(
+			[&output](std::string_view chunk)
+			{
+				output = std::copy(chunk.begin(), chunk.end(), output);
+			},
+			endOfStream,
+			chunkSize,
+			flags
+		);
+
+		return output;
+	}
+
 	template<Timeout T>
 	Network::Network(std::string_view ip, std::string_view port, T timeout) :
 		Network(ip, port, std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count())
@@ -227,77 +723,124 @@ namespace web
 		}
 #endif // !__LINUX__
 
-		handle = std::shared_ptr<SOCKET>(new SOCKET(clientSocket), [](SOCKET* ptr) { closesocket(*ptr); delete ptr; });
+		handle = Network::createHandle(clientSocket);
 
 		this->setTimeout(std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count());
 	}
 
+	template<typename HeaderT> requires std::is_trivially_copyable_v<HeaderT>
+	int Network::receiveScatteredData(HeaderT& header, utility::ContainerWrapper& body, bool& endOfStream, int flags)
+	{
+		return this->receiveScatteredData(std::span<char>(reinterpret_cast<char*>(&header), sizeof(header)), body, endOfStream, flags);
+	}
+
 	template<typename DataT>
 	int Network::sendBytes(const DataT* data, int size, bool& endOfStream, int flags)
 	{
-		int lastSend = 0;
-		int totalSent = 0;
+		NetworkError error = {};
+		int result = this->trySendBytes(data, size, endOfStream, error, flags);
+
+		if (result == SOCKET_ERROR)
+		{
+			this->throwException(error);
+		}
+
+		return result;
+	}
 
-		endOfStream = false;
+	template<typename DataT>
+	int Network::receiveBytes(DataT* data, int size, bool& endOfStream, int flags)
+	{
+		NetworkError error = {};
+		int result = this->tryReceiveBytes(data, size, endOfStream, error, flags);
 
-		do
+		if (result == SOCKET_ERROR)
 		{
-			lastSend = this->sendBytesImplementation(reinterpret_cast<const char*>(data) + totalSent, size - totalSent, flags);
+			this->throwException(error);
+		}
 
-			if (lastSend == SOCKET_ERROR)
-			{
-				this->throwException(__LINE__, __FILE__);
-			}
-			else if (!lastSend)
+		return result;
+	}
+
+	template<typename DataT>
+	int Network::trySendBytes(const DataT* data, int size, bool& endOfStream, NetworkError& error, int flags)
+	{
+		auto sendFunction = [&]() -> int
 			{
-				endOfStream = true;
+				return this->sendBytesWithoutException(reinterpret_cast<const char*>(data), size, endOfStream, flags, error);
+			};
 
-				return totalSent;
-			}
+		return utility::NetworkObserver::isAnyInstalled() ?
+			this->observe(utility::NetworkOperation::sendBytes, size, endOfStream, sendFunction, &error) :
+			sendFunction();
+	}
 
-			totalSent += lastSend;
-		} while (totalSent < size);
+	template<typename DataT>
+	int Network::tryReceiveBytes(DataT* data, int size, bool& endOfStream, NetworkError& error, int flags)
+	{
+		auto receiveFunction = [&]() -> int
+			{
+				return this->receiveBytesWithoutException(reinterpret_cast<char*>(data), size, endOfStream, flags, error);
+			};
 
-		return totalSent;
+		return utility::NetworkObserver::isAnyInstalled() ?
+			this->observe(utility::NetworkOperation::receiveBytes, size, endOfStream, receiveFunction, &error) :
+			receiveFunction();
 	}
 
+#ifdef __cpp_lib_expected
 	template<typename DataT>
-	int Network::receiveBytes(DataT* data, int size, bool& endOfStream, int flags)
+	std::expected<int, NetworkError> Network::trySendBytes(const DataT* data, int size, bool& endOfStream, int flags)
 	{
-		int receive = 0;
-		char* actualData = reinterpret_cast<char*>(data);
+		NetworkError error = {};
+		int result = this->trySendBytes(data, size, endOfStream, error, flags);
 
-		while (buffers.size())
+		if (result == SOCKET_ERROR)
 		{
-			std::string_view& receiveBuffer = buffers.front();
-			int fromBufferSize = std::min<int>(static_cast<int>(receiveBuffer.size()), size);
-
-			std::copy(receiveBuffer.data(), receiveBuffer.data() + fromBufferSize, actualData);
+			return std::unexpected(error);
+		}
 
-			receiveBuffer = std::string_view(receiveBuffer.data() + fromBufferSize, receiveBuffer.size() - fromBufferSize);
+		return result;
+	}
 
-			actualData += fromBufferSize;
-			receive += fromBufferSize;
-			size -= fromBufferSize;
+	template<typename DataT>
+	std::expected<int, NetworkError> Network::tryReceiveBytes(DataT* data, int size, bool& endOfStream, int flags)
+	{
+		NetworkError error = {};
+		int result = this->tryReceiveBytes(data, size, endOfStream, error, flags);
 
-			if (receiveBuffer.empty())
-			{
-				buffers.pop();
-			}
+		if (result == SOCKET_ERROR)
+		{
+			return std::unexpected(error);
 		}
 
-		if (size)
+		return result;
+	}
+
+	inline std::expected<int, NetworkError> Network::trySendData(const utility::ContainerWrapper& data, bool& endOfStream, int flags)
+	{
+		NetworkError error = {};
+		int result = this->trySendData(data, endOfStream, error, flags);
+
+		if (result == SOCKET_ERROR)
 		{
-			receive += this->receiveBytesImplementation(actualData, size, flags);
+			return std::unexpected(error);
 		}
 
-		endOfStream = !static_cast<bool>(receive);
+		return result;
+	}
 
-		if (receive == SOCKET_ERROR)
+	inline std::expected<int, NetworkError> Network::tryReceiveData(utility::ContainerWrapper& data, bool& endOfStream, int flags)
+	{
+		NetworkError error = {};
+		int result = this->tryReceiveData(data, endOfStream, error, flags);
+
+		if (result == SOCKET_ERROR)
 		{
-			this->throwException(__LINE__, __FILE__);
+			return std::unexpected(error);
 		}
 
-		return receive;
+		return result;
 	}
+#endif // __cpp_lib_expected
 }
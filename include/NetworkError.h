@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string_view>
+
+namespace web
+{
+	/**
+	 * @brief Error of non throwing Network calls(trySendBytes/tryReceiveBytes/trySendData/tryReceiveData). Trivially copyable, so error path doesn't allocate
+	 */
+	struct NetworkError
+	{
+		/// @brief errno on Linux, WSAGetLastError on Windows
+		int errorCode;
+		int line;
+		/// @brief Source file of failed call, usually __FILE__
+		std::string_view file;
+		/// @brief Static description of error that doesn't come from errno/WSAGetLastError, e.g. invalid frame header. Empty for system errors
+		std::string_view description = {};
+
+		/// @brief Error of last failed socket call
+		static NetworkError fromLastError(int line, std::string_view file) noexcept;
+
+		/// @brief Send or receive timeout expired(SO_SNDTIMEO/SO_RCVTIMEO) or non blocking call would block
+		bool isTimeout() const noexcept;
+
+		/// @brief Restore errno/WSAGetLastError, so WebException created after it has same error code and description
+		void setLastError() const noexcept;
+	};
+}
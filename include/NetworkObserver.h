@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <ostream>
+#include <cstdint>
+#include <string_view>
+
+namespace web::utility
+{
+	struct ObserverRegistration;
+
+	enum class NetworkOperation
+	{
+		sendBytes,
+		receiveBytes,
+		/// @brief sendData and sendRawData
+		sendData,
+		/// @brief receiveData and receiveRawData
+		receiveData
+	};
+
+	std::string_view getNetworkOperationName(NetworkOperation operation) noexcept;
+
+	/**
+	 * @brief Begin or end of observed Network call
+	 */
+	struct NetworkEvent
+	{
+		NetworkOperation operation;
+		int64_t socket;
+		std::chrono::steady_clock::time_point timestamp;
+		/// @brief Requested bytes for begin event, transferred bytes for end event
+		int64_t bytes;
+		/// @brief Error code of failed call for end event. -1 if call failed not with WebException
+		int errorCode;
+		bool endOfStream;
+	};
+
+	/**
+	 * @brief Receives begin/end events of sendBytes, receiveBytes, sendData and receiveData. Installed per Network or globally
+	 * Called on thread that calls Network methods, so implementation must be thread safe if observer is shared
+	 */
+	class NetworkObserver
+	{
+	private:
+		static std::atomic<size_t> installedObservers;
+		static std::atomic<std::shared_ptr<NetworkObserver>> globalObserver;
+
+	public:
+		/// @brief Checked before every observed call, so without observers overhead is one branch
+		static bool isAnyInstalled() noexcept;
+
+		/**
+		 * @brief Wrap observer so it counts as installed while returned pointer or its copies alive
+		 * @return nullptr if observer is nullptr
+		 */
+		static std::shared_ptr<NetworkObserver> install(const std::shared_ptr<NetworkObserver>& observer);
+
+		/// @brief Set observer for all Networks without own observer. nullptr removes global observer
+		static void setGlobal(const std::shared_ptr<NetworkObserver>& observer);
+
+		static std::shared_ptr<NetworkObserver> getGlobal();
+
+	public:
+		NetworkObserver() = default;
+
+		virtual void onBegin(const NetworkEvent& event) = 0;
+
+		virtual void onEnd(const NetworkEvent& event) = 0;
+
+		virtual ~NetworkObserver() = default;
+
+		friend struct ObserverRegistration;
+	};
+
+	/**
+	 * @brief Keeps last events of every thread in per thread ring. Writing is lock free after first event on thread
+	 * Use getRecords or dump after latency spike
+	 */
+	class RingBufferNetworkObserver : public NetworkObserver
+	{
+	public:
+		struct Record
+		{
+			NetworkEvent event;
+			std::thread::id thread;
+			bool begin;
+		};
+
+	private:
+		static constexpr size_t recordWords = (sizeof(Record) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+		/// @brief Seqlock protected record. Stored as atomic words so reader copying during write is not a data race
+		struct Slot
+		{
+			/// @brief Odd while written, 2 * (number of completed writes) otherwise
+			std::atomic<uint64_t> sequence;
+			std::array<std::atomic<uint64_t>, recordWords> words;
+		};
+
+		struct Ring
+		{
+			std::vector<Slot> slots;
+			std::atomic<uint64_t> head;
+			std::thread::id thread;
+
+			Ring(size_t capacity);
+		};
+
+	private:
+		std::vector<std::shared_ptr<Ring>> rings;
+		mutable std::mutex ringsMutex;
+		size_t capacity;
+		uint64_t id;
+
+	private:
+		Ring& getRing();
+
+		void push(const NetworkEvent& event, bool begin);
+
+	public:
+		/// @param capacity Number of records kept per thread. Rounded up to power of two
+		RingBufferNetworkObserver(size_t capacity = 4096);
+
+		void onBegin(const NetworkEvent& event) override;
+
+		void onEnd(const NetworkEvent& event) override;
+
+		/// @brief Records of all threads sorted by timestamp. Records overwritten during copy are skipped
+		std::vector<Record> getRecords() const;
+
+		/// @brief Write records one per line: timestamp in nanoseconds, thread, operation, begin/end, socket, bytes, error code
+		void dump(std::ostream& stream) const;
+
+		~RingBufferNetworkObserver() = default;
+	};
+
+	inline bool NetworkObserver::isAnyInstalled() noexcept
+	{
+		return installedObservers.load(std::memory_order_relaxed) != 0;
+	}
+}
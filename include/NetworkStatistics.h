@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+namespace web::utility
+{
+	/**
+	 * @brief Latency histogram snapshot. Log-linear buckets: subBuckets linear buckets inside every power of two nanoseconds
+	 */
+	struct LatencyHistogramSnapshot
+	{
+		static constexpr size_t subBucketsBits = 2;
+		static constexpr size_t subBuckets = 1 << subBucketsBits;
+		/// @brief Values up to 2^maxMagnitude nanoseconds(~68 seconds), larger values go to the last bucket
+		static constexpr size_t maxMagnitude = 36;
+		static constexpr size_t bucketsCount = (maxMagnitude - subBucketsBits + 1) * subBuckets;
+
+		std::array<uint64_t, bucketsCount> buckets{};
+		uint64_t count = 0;
+		uint64_t sum = 0;
+
+		/// @brief Bucket index for value in nanoseconds
+		static size_t getIndex(uint64_t value) noexcept;
+
+		/// @brief Exclusive upper bound of bucket in nanoseconds
+		static uint64_t getUpperBound(size_t index) noexcept;
+
+		/// @brief Approximate value at percentile in nanoseconds
+		/// @param percentile In range [0, 100]
+		uint64_t getValueAtPercentile(double percentile) const noexcept;
+
+		LatencyHistogramSnapshot& operator += (const LatencyHistogramSnapshot& other) noexcept;
+	};
+
+	/**
+	 * @brief Network counters snapshot
+	 */
+	struct NetworkStatisticsSnapshot
+	{
+		uint64_t bytesSent = 0;
+		uint64_t bytesReceived = 0;
+		uint64_t sendCalls = 0;
+		uint64_t receiveCalls = 0;
+		/// @brief Send system calls that sent less than requested
+		uint64_t partialSends = 0;
+		/// @brief Send/receive calls failed because of SO_SNDTIMEO/SO_RCVTIMEO
+		uint64_t timeouts = 0;
+		/// @brief Non blocking send/receive calls failed with EAGAIN/EWOULDBLOCK
+		uint64_t wouldBlock = 0;
+		/// @brief Other failed send/receive calls
+		uint64_t errors = 0;
+		/// @brief sendBytes latency
+		LatencyHistogramSnapshot sendLatency;
+		/// @brief receiveBytes latency
+		LatencyHistogramSnapshot receiveLatency;
+
+		/// @brief Aggregate statistics of many connections
+		NetworkStatisticsSnapshot& operator += (const NetworkStatisticsSnapshot& other) noexcept;
+
+		/**
+		 * @brief Export in Prometheus text exposition format
+		 * @param prefix Metrics names prefix
+		 * @param labels Labels without braces added to every metric. For example connection="1"
+		 */
+		std::string toPrometheus(std::string_view prefix = "socket_streams", std::string_view labels = "") const;
+	};
+
+	/**
+	 * @brief Per connection counters. Relaxed atomics so snapshot can be taken from other thread
+	 */
+	class NetworkStatistics
+	{
+	public:
+		using clock = std::chrono::steady_clock;
+
+	private:
+		class LatencyHistogram
+		{
+		private:
+			std::array<std::atomic<uint64_t>, LatencyHistogramSnapshot::bucketsCount> buckets;
+			std::atomic<uint64_t> count;
+			std::atomic<uint64_t> sum;
+
+		public:
+			LatencyHistogram();
+
+			void record(uint64_t value) noexcept;
+
+			LatencyHistogramSnapshot getSnapshot() const noexcept;
+
+			void reset() noexcept;
+		};
+
+	private:
+		std::atomic<uint64_t> bytesSent;
+		std::atomic<uint64_t> bytesReceived;
+		std::atomic<uint64_t> sendCalls;
+		std::atomic<uint64_t> receiveCalls;
+		std::atomic<uint64_t> partialSends;
+		std::atomic<uint64_t> timeouts;
+		std::atomic<uint64_t> wouldBlock;
+		std::atomic<uint64_t> errors;
+		LatencyHistogram sendLatency;
+		LatencyHistogram receiveLatency;
+
+	private:
+		void recordError(int flags) noexcept;
+
+	public:
+		NetworkStatistics();
+
+		/// @brief Record result of one send system call
+		/// @param result Return value of send
+		/// @param requested Requested number of bytes
+		void recordSend(int result, int requested, int flags) noexcept;
+
+		/// @brief Record result of one receive system call
+		/// @param result Return value of recv
+		void recordReceive(int result, int flags) noexcept;
+
+		void recordSendLatency(clock::time_point start) noexcept;
+
+		void recordReceiveLatency(clock::time_point start) noexcept;
+
+		NetworkStatisticsSnapshot getSnapshot() const noexcept;
+
+		void reset() noexcept;
+
+		~NetworkStatistics() = default;
+	};
+}
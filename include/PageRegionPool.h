@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace buffers
+{
+	/**
+	 * @brief Process wide pool of page aligned regions for IOSocketBuffer receive buffers
+	 * Regions of 1 - 256 pages are rounded up to power of 2 pages and returned regions are kept per size class in thread cache and shared pool instead of unmapping them.
+	 * Bigger regions are mapped and unmapped directly. Regions not smaller than huge page threshold are rounded up to huge pages and backed by them if system allows it
+	 */
+	class PageRegionPool
+	{
+	public:
+		/// @brief Size classes are 1, 2, 4, ..., 256 pages
+		static constexpr size_t sizeClassesCount = 9;
+
+		/// @brief Regions of each size class kept by thread before they are returned to shared pool
+		static constexpr size_t threadCacheRegions = 4;
+
+		/// @brief Default limit of retained memory
+		static constexpr size_t defaultMaxRetainedBytes = 64 * 1024 * 1024;
+
+		/// @brief Default minimal region size backed by huge pages
+		static constexpr size_t defaultHugePageThreshold = 4 * 1024 * 1024;
+
+		struct Statistics
+		{
+			/// @brief Allocations served from thread cache or shared pool
+			uint64_t hits = 0;
+			/// @brief Allocations that mapped new region
+			uint64_t misses = 0;
+			/// @brief Memory of free regions in thread caches and shared pool
+			uint64_t retainedBytes = 0;
+			/// @brief Regions mapped with explicit(MAP_HUGETLB, MEM_LARGE_PAGES) or transparent huge pages
+			uint64_t hugePageRegions = 0;
+			/// @brief Memory of regions allocated by buffers
+			uint64_t usedBytes = 0;
+		};
+
+	private:
+		struct ThreadCache;
+
+	private:
+		std::array<std::vector<void*>, sizeClassesCount> regions;
+		std::mutex mutex;
+		size_t pageSize;
+		size_t hugePageSize;
+		std::atomic<size_t> maxRetainedBytes;
+		std::atomic<size_t> maxUsedBytes;
+		std::atomic<size_t> hugePageThreshold;
+		std::atomic<bool> prefault;
+		std::atomic<uint64_t> hits;
+		std::atomic<uint64_t> misses;
+		std::atomic<uint64_t> retainedBytes;
+		std::atomic<uint64_t> hugePageRegions;
+		std::atomic<uint64_t> usedBytes;
+
+	private:
+		/// @return nullptr if thread cache of this thread is already destroyed
+		static ThreadCache* getThreadCache();
+
+		/// @brief Map region with huge pages, fall back to transparent huge pages
+		/// @return nullptr if huge pages aren't available
+		void* mapHugePages(size_t size) noexcept;
+
+		void* map(size_t size);
+
+		static void unmap(void* region, size_t size) noexcept;
+
+		/// @return sizeClassesCount if size isn't pooled
+		size_t getSizeClass(size_t size) const noexcept;
+
+		/// @brief Move regions of thread cache to shared pool or unmap them if it's full
+		void flush(ThreadCache& cache) noexcept;
+
+	private:
+		PageRegionPool();
+
+	public:
+		static PageRegionPool& get();
+
+		PageRegionPool(const PageRegionPool&) = delete;
+
+		PageRegionPool& operator = (const PageRegionPool&) = delete;
+
+		/// @brief Round size up to size of region that will be allocated for it
+		size_t getRegionSize(size_t size) const noexcept;
+
+		/**
+		 * @brief Get region from thread cache, shared pool or map new one
+		 * @param size Result of getRegionSize
+		 * @return Page aligned region
+		 * @exception WebException ENOBUFS if memory budget is exceeded
+		 */
+		void* allocate(size_t size);
+
+		/// @brief Return region to thread cache or shared pool, unmap it if retained memory limit is reached
+		/// @param region Result of allocate
+		/// @param size Size passed to allocate
+		void deallocate(void* region, size_t size) noexcept;
+
+		/// @brief Limit of memory in free regions. 0 disables pooling
+		void setMaxRetainedBytes(size_t maxRetainedBytes) noexcept;
+
+		/// @brief Memory budget of regions allocated by buffers of all connections
+		void setMaxUsedBytes(size_t maxUsedBytes) noexcept;
+
+		/// @brief Minimal size of region backed by huge pages. 0 disables huge pages
+		void setHugePageThreshold(size_t hugePageThreshold) noexcept;
+
+		/// @brief Fault in all pages of huge page regions when they are mapped instead of on first touch
+		void setPrefault(bool prefault) noexcept;
+
+		/// @brief Unmap free regions of shared pool and current thread cache
+		void trim() noexcept;
+
+		size_t getPageSize() const noexcept;
+
+		/// @return 0 if system doesn't support huge pages
+		size_t getHugePageSize() const noexcept;
+
+		size_t getMaxRetainedBytes() const noexcept;
+
+		size_t getMaxUsedBytes() const noexcept;
+
+		size_t getHugePageThreshold() const noexcept;
+
+		bool getPrefault() const noexcept;
+
+		Statistics getStatistics() const noexcept;
+	};
+}
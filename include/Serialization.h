@@ -0,0 +1,324 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace web::utility
+{
+	/// @brief Maximal number of aggregate fields found with structured binding. Bigger records need field list
+	inline constexpr size_t maxRecordFields = 16;
+
+	/**
+	 * @brief Record that lists serialized fields as tuple of member pointers instead of structured binding:
+	 * static constexpr auto fields = std::make_tuple(&Quote::id, &Quote::price);
+	 */
+	template<typename T>
+	concept FieldList = requires { std::tuple_size<std::remove_cvref_t<decltype(T::fields)>>::value; };
+
+	/// @brief Converts to any type, counts initializers that aggregate accepts
+	struct AnyField
+	{
+		template<typename T>
+		constexpr operator T() const noexcept;
+	};
+
+	template<typename T>
+	inline constexpr bool isStdArray = false;
+
+	template<typename T, size_t Size>
+	inline constexpr bool isStdArray<std::array<T, Size>> = true;
+
+	template<typename T, size_t... Indices>
+	constexpr bool isInitializableWith(std::index_sequence<Indices...>)
+	{
+		return requires { T{ (static_cast<void>(Indices), AnyField())... }; };
+	}
+
+	/// @brief Number of aggregate fields, maxRecordFields + 1 if there are more. C arrays fields aren't supported, use std::array
+	template<typename T, size_t Count = 0>
+	constexpr size_t countFields()
+	{
+		if constexpr (Count > maxRecordFields || !isInitializableWith<T>(std::make_index_sequence<Count + 1>()))
+		{
+			return Count;
+		}
+		else
+		{
+			return countFields<T, Count + 1>();
+		}
+	}
+
+	/// @brief Tuple of references to fields of record from field list or structured binding
+	template<typename T>
+	constexpr auto tieFields(T& value) noexcept
+	{
+		if constexpr (FieldList<std::remove_const_t<T>>)
+		{
+			return std::apply([&value](auto... members) { return std::tie(value.*members...); }, std::remove_const_t<T>::fields);
+		}
+		else
+		{
+			constexpr size_t count = countFields<std::remove_const_t<T>>();
+
+			static_assert(count && count <= maxRecordFields, "Record must have 1 - maxRecordFields fields, use field list otherwise");
+
+			if constexpr (count == 1)
+			{
+				auto& [field0] = value;
+
+				return std::tie(field0);
+			}
+			else if constexpr (count == 2)
+			{
+				auto& [field0, field1] = value;
+
+				return std::tie(field0, field1);
+			}
+			else if constexpr (count == 3)
+			{
+				auto& [field0, field1, field2] = value;
+
+				return std::tie(field0, field1, field2);
+			}
+			else if constexpr (count == 4)
+			{
+				auto& [field0, field1, field2, field3] = value;
+
+				return std::tie(field0, field1, field2, field3);
+			}
+			else if constexpr (count == 5)
+			{
+				auto& [field0, field1, field2, field3, field4] = value;
+
+				return std::tie(field0, field1, field2, field3, field4);
+			}
+			else if constexpr (count == 6)
+			{
+				auto& [field0, field1, field2, field3, field4, field5] = value;
+
+				return std::tie(field0, field1, field2, field3, field4, field5);
+			}
+			else if constexpr (count == 7)
+			{
+				auto& [field0, field1, field2, field3, field4, field5, field6] = value;
+
+				return std::tie(field0, field1, field2, field3, field4, field5, field6);
+			}
+			else if constexpr (count == 8)
+			{
+				auto& [field0, field1, field2, field3, field4, field5, field6, field7] = value;
+
+				return std::tie(field0, field1, field2, field3, field4, field5, field6, field7);
+			}
+			else if constexpr (count == 9)
+			{
+				auto& [field0, field1, field2, field3, field4, field5, field6, field7, field8] = value;
+
+				return std::tie(field0, field1, field2, field3, field4, field5, field6, field7, field8);
+			}
+			else if constexpr (count == 10)
+			{
+				auto& [field0, field1, field2, field3, field4, field5, field6, field7, field8, field9] = value;
+
+				return std::tie(field0, field1, field2, field3, field4, field5, field6, field7, field8, field9);
+			}
+			else if constexpr (count == 11)
+			{
+				auto& [field0, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10] = value;
+
+				return std::tie(field0, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10);
+			}
+			else if constexpr (count == 12)
+			{
+				auto& [field0, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11] = value;
+
+				return std::tie(field0, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11);
+			}
+			else if constexpr (count == 13)
+			{
+				auto& [field0, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12] = value;
+
+				return std::tie(field0, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12);
+			}
+			else if constexpr (count == 14)
+			{
+				auto& [field0, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13] = value;
+
+				return std::tie(field0, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13);
+			}
+			else if constexpr (count == 15)
+			{
+				auto& [field0, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14] = value;
+
+				return std::tie(field0, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14);
+			}
+			else if constexpr (count == 16)
+			{
+				auto& [field0, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15] = value;
+
+				return std::tie(field0, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15);
+			}
+		}
+	}
+
+	template<typename T>
+	using RecordFields = decltype(utility::tieFields(std::declval<T&>()));
+
+	template<typename T>
+	constexpr bool isSerializable();
+
+	template<typename Fields, size_t... Indices>
+	constexpr bool areSerializable(std::index_sequence<Indices...>)
+	{
+		return (utility::isSerializable<std::remove_cvref_t<std::tuple_element_t<Indices, Fields>>>() && ...);
+	}
+
+	/// @brief Arithmetic, enum, std::array of serializable elements or record which fields are serializable
+	template<typename T>
+	constexpr bool isSerializable()
+	{
+		if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+		{
+			return true;
+		}
+		else if constexpr (isStdArray<T>)
+		{
+			return utility::isSerializable<typename T::value_type>();
+		}
+		else if constexpr (FieldList<T>)
+		{
+			return utility::areSerializable<RecordFields<T>>(std::make_index_sequence<std::tuple_size_v<RecordFields<T>>>());
+		}
+		else if constexpr (std::is_aggregate_v<T> && !std::is_array_v<T> && !std::is_union_v<T>)
+		{
+			if constexpr (constexpr size_t count = utility::countFields<T>(); count && count <= maxRecordFields)
+			{
+				return utility::areSerializable<RecordFields<T>>(std::make_index_sequence<count>());
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	template<typename T>
+	constexpr size_t getPackedSize();
+
+	template<typename Fields, size_t... Indices>
+	constexpr size_t sumPackedSizes(std::index_sequence<Indices...>)
+	{
+		return (utility::getPackedSize<std::remove_cvref_t<std::tuple_element_t<Indices, Fields>>>() + ... + 0);
+	}
+
+	/// @brief Size of value on wire without padding
+	template<typename T>
+	constexpr size_t getPackedSize()
+	{
+		if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+		{
+			return sizeof(T);
+		}
+		else if constexpr (isStdArray<T>)
+		{
+			return std::tuple_size_v<T> * utility::getPackedSize<typename T::value_type>();
+		}
+		else
+		{
+			return utility::sumPackedSizes<RecordFields<T>>(std::make_index_sequence<std::tuple_size_v<RecordFields<T>>>());
+		}
+	}
+
+	/// @brief Class with serializable fields that is sent as one frame of packed fields in native byte order
+	template<typename T>
+	concept Record = std::is_class_v<T> && isSerializable<T>();
+
+	/// @brief Wire size of record computed at compile time
+	template<Record T>
+	inline constexpr size_t packedSize = utility::getPackedSize<T>();
+
+	/// @brief Memory of record is its wire format, so it's sent and received without serialization
+	template<Record T>
+	inline constexpr bool hasPackedLayout = std::is_trivially_copyable_v<T> && sizeof(T) == packedSize<T>;
+
+	/**
+	 * @brief Write fields of value one after another without padding
+	 * @param value
+	 * @param data At least getPackedSize<T>() bytes
+	 * @return End of written data
+	 */
+	template<typename T>
+	char* serialize(const T& value, char* data) noexcept;
+
+	/**
+	 * @brief Read fields written by serialize
+	 * @param value
+	 * @param data At least getPackedSize<T>() bytes
+	 * @return End of read data
+	 */
+	template<typename T>
+	const char* deserialize(T& value, const char* data) noexcept;
+}
+
+namespace web::utility
+{
+	template<typename T>
+	char* serialize(const T& value, char* data) noexcept
+	{
+		if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) == getPackedSize<T>())
+		{
+			std::memcpy(data, &value, sizeof(T));
+
+			return data + sizeof(T);
+		}
+		else if constexpr (isStdArray<T>)
+		{
+			for (const auto& element : value)
+			{
+				data = utility::serialize(element, data);
+			}
+
+			return data;
+		}
+		else
+		{
+			std::apply([&data](const auto&... fields) { ((data = utility::serialize(fields, data)), ...); }, utility::tieFields(value));
+
+			return data;
+		}
+	}
+
+	template<typename T>
+	const char* deserialize(T& value, const char* data) noexcept
+	{
+		if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) == getPackedSize<T>())
+		{
+			std::memcpy(&value, data, sizeof(T));
+
+			return data + sizeof(T);
+		}
+		else if constexpr (isStdArray<T>)
+		{
+			for (auto& element : value)
+			{
+				data = utility::deserialize(element, data);
+			}
+
+			return data;
+		}
+		else
+		{
+			std::apply([&data](auto&... fields) { ((data = utility::deserialize(fields, data)), ...); }, utility::tieFields(value));
+
+			return data;
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace web::utility
+{
+	/**
+	 * @brief Kernel TCP state of connection(TCP_INFO on Linux, SIO_TCP_INFO on Windows). Unavailable values are 0
+	 */
+	struct TcpInfo
+	{
+		/// @brief Smoothed round trip time
+		std::chrono::microseconds rtt;
+		/// @brief Round trip time variance
+		std::chrono::microseconds rttVariance;
+		std::chrono::microseconds minRtt;
+		/// @brief Congestion window in segments
+		uint32_t congestionWindow;
+		uint32_t slowStartThreshold;
+		/// @brief Maximum segment size in bytes
+		uint32_t mss;
+		/// @brief Segments sent but not acknowledged
+		uint32_t unacked;
+		/// @brief Segments currently considered lost
+		uint32_t lost;
+		/// @brief Segments currently retransmitted
+		uint32_t retransmitting;
+		/// @brief Total retransmitted segments during connection life
+		uint32_t totalRetransmits;
+		/// @brief Bytes written by application but not sent yet
+		uint32_t notSentBytes;
+		/// @brief Latest delivery rate estimate in bytes per second
+		uint64_t deliveryRate;
+		uint64_t bytesSent;
+		uint64_t bytesRetransmitted;
+		uint64_t bytesReceived;
+		/// @brief Time spent with data in flight
+		std::chrono::microseconds busyTime;
+		/// @brief Time sending was limited by peer receive window
+		std::chrono::microseconds receiveWindowLimited;
+		/// @brief Time sending was limited by local send buffer
+		std::chrono::microseconds sendBufferLimited;
+	};
+
+	/**
+	 * @brief Values aggregated over all connections of TcpInfoSampler
+	 */
+	struct TcpInfoAggregate
+	{
+		size_t connections;
+		std::chrono::microseconds rttP50;
+		std::chrono::microseconds rttP99;
+		std::chrono::microseconds rttMax;
+		std::chrono::microseconds rttVarianceMax;
+		uint32_t congestionWindowMin;
+		double congestionWindowMean;
+		uint64_t unacked;
+		uint64_t lost;
+		uint64_t totalRetransmits;
+		uint64_t deliveryRateMin;
+		double deliveryRateMean;
+		std::chrono::microseconds busyTime;
+		std::chrono::microseconds receiveWindowLimited;
+		std::chrono::microseconds sendBufferLimited;
+	};
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+
+#include "Network.h"
+
+namespace web::utility
+{
+	/**
+	 * @brief Periodically samples TcpInfo of all registered connections that are still alive and reports aggregate
+	 */
+	class TcpInfoSampler
+	{
+	public:
+		using Callback = std::function<void(const TcpInfoAggregate& aggregate, const std::vector<TcpInfo>& connections)>;
+
+	private:
+		std::vector<std::weak_ptr<SOCKET>> handles;
+		Callback callback;
+		std::chrono::milliseconds period;
+		std::mutex handlesMutex;
+		std::mutex stopMutex;
+		std::condition_variable stopCondition;
+		std::thread worker;
+		bool stopped;
+
+	private:
+		void run();
+
+	public:
+		/**
+		 * @brief Construct sampler
+		 * @param period Sampling period. Zero means no background thread, use sample directly
+		 * @param callback Called from sampler thread after each sample
+		 */
+		TcpInfoSampler(std::chrono::milliseconds period = std::chrono::milliseconds(0), const Callback& callback = nullptr);
+
+		TcpInfoSampler(const TcpInfoSampler&) = delete;
+
+		TcpInfoSampler& operator = (const TcpInfoSampler&) = delete;
+
+		/// @brief Register connection. Sampler doesn't prolong socket life, closed connections are removed automatically
+		void add(const Network& network);
+
+		/// @brief Number of registered connections that are still alive
+		size_t size();
+
+		/**
+		 * @brief Sample all connections now
+		 * @param connections Optional per connection values
+		 */
+		TcpInfoAggregate sample(std::vector<TcpInfo>* connections = nullptr);
+
+		/// @brief Stop background thread
+		void stop();
+
+		~TcpInfoSampler();
+	};
+}
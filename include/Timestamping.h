@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <deque>
+#include <cstdint>
+
+namespace web::utility
+{
+	/**
+	 * @brief Timestamps of frame returned by receiveData/receiveRawData. Kernel software timestamps use CLOCK_REALTIME
+	 */
+	struct ReceiveTimestamps
+	{
+		/// @brief When kernel received last part of frame. Empty if frame was taken from receive buffers
+		std::optional<std::chrono::system_clock::time_point> kernel;
+		/// @brief When receiveData returned frame
+		std::chrono::system_clock::time_point user;
+
+		/// @brief Time frame waited in socket receive queue
+		std::chrono::nanoseconds getQueueingDelay() const;
+	};
+
+	/**
+	 * @brief Timestamps of frame sent by sendData/sendRawData
+	 */
+	struct SendTimestamps
+	{
+		/// @brief Offset of last byte of frame in bytes sent since timestamping enabled. Wraps at 2^32
+		uint32_t id;
+		/// @brief Frame size without header
+		int64_t size;
+		/// @brief When sendData was called
+		std::chrono::system_clock::time_point user;
+		/// @brief When last part of frame entered packet scheduler
+		std::optional<std::chrono::system_clock::time_point> scheduled;
+		/// @brief When last part of frame was passed to device driver
+		std::optional<std::chrono::system_clock::time_point> software;
+		/// @brief When peer acknowledged last part of frame
+		std::optional<std::chrono::system_clock::time_point> acknowledged;
+	};
+
+	/**
+	 * @brief Per connection SO_TIMESTAMPING state
+	 */
+	struct TimestampingState
+	{
+		/// @brief Maximum frames waiting for acknowledge timestamp, older frames are dropped
+		static constexpr size_t maxPendingFrames = 4096;
+
+		std::deque<SendTimestamps> pendingFrames;
+		std::optional<std::chrono::system_clock::time_point> frameKernelTimestamp;
+		std::optional<ReceiveTimestamps> lastReceive;
+		/// @brief Bytes sent since timestamping enabled, used as SOF_TIMESTAMPING_OPT_ID key
+		uint32_t sentBytes = 0;
+	};
+}
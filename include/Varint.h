@@ -0,0 +1,347 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace web::utility
+{
+	/// @brief Maximum LEB128 size of 32 bit value
+	inline constexpr size_t maxVarint32Size = 5;
+
+	/// @brief Maximum LEB128 size of 64 bit value
+	inline constexpr size_t maxVarint64Size = 10;
+
+	/**
+	 * @brief Write value as unsigned LEB128: 7 bits per byte starting from least significant, high bit set on all bytes except last
+	 * @param value
+	 * @param data At least maxVarint64Size bytes
+	 * @return Number of written bytes
+	 */
+	inline size_t encodeVarint(uint64_t value, char* data) noexcept
+	{
+		size_t size = 0;
+
+		while (value >= 0x80)
+		{
+			data[size++] = static_cast<char>(value | 0x80);
+			value >>= 7;
+		}
+
+		data[size++] = static_cast<char>(value);
+
+		return size;
+	}
+
+	/**
+	 * @brief Decode unsigned LEB128 value up to maxVarint32Size bytes without branching on every byte
+	 * @param data At least 8 readable bytes, bytes after value are ignored
+	 * @param value Decoded value, up to 35 bits
+	 * @return Size of value in bytes, 0 if first maxVarint32Size bytes don't contain last byte of value
+	 */
+	inline size_t decodeVarint32(const char* data, uint64_t& value) noexcept
+	{
+		uint64_t word = 0;
+
+		if constexpr (std::endian::native == std::endian::little)
+		{
+			std::memcpy(&word, data, sizeof(word));
+		}
+		else
+		{
+			for (size_t i = 0; i < sizeof(word); i++)
+			{
+				word |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (i * 8);
+			}
+		}
+
+		// Last byte is first one with high bit cleared
+		uint64_t lastBytes = ~word & 0x0000008080808080ULL;
+
+		if (!lastBytes)
+		{
+			return 0;
+		}
+
+		size_t size = std::countr_zero(lastBytes) / 8 + 1;
+		uint64_t bits =
+			(word & 0x7F) |
+			((word >> 1) & 0x3F80) |
+			((word >> 2) & 0x1FC000) |
+			((word >> 3) & 0xFE00000) |
+			((word >> 4) & 0x7F0000000ULL);
+
+		value = bits & ((1ULL << (size * 7)) - 1);
+
+		return size;
+	}
+
+	/**
+	 * @brief Decode unsigned LEB128 value of up to maxVarint64Size bytes
+	 * @param data
+	 * @param size Readable bytes
+	 * @param value Decoded value
+	 * @return Size of value in bytes, 0 if value is incomplete or longer than maxVarint64Size
+	 */
+	inline size_t decodeVarint(const char* data, size_t size, uint64_t& value) noexcept
+	{
+		uint64_t result = 0;
+
+		for (size_t i = 0; i < size && i < maxVarint64Size; i++)
+		{
+			uint8_t byte = static_cast<uint8_t>(data[i]);
+
+			result |= static_cast<uint64_t>(byte & 0x7F) << (i * 7);
+
+			if (!(byte & 0x80))
+			{
+				value = result;
+
+				return i + 1;
+			}
+		}
+
+		return 0;
+	}
+
+	/// @brief Map signed value to unsigned so small magnitudes of both signs are small: 0, -1, 1, -2 -> 0, 1, 2, 3
+	constexpr uint64_t encodeZigzag(int64_t value) noexcept
+	{
+		return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+	}
+
+	constexpr int64_t decodeZigzag(uint64_t value) noexcept
+	{
+		return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+	}
+
+	/// @brief Integer encoded as LEB128, signed types with zigzag
+	template<typename T>
+	concept VarintInteger = std::is_integral_v<T> && !std::same_as<T, bool> && sizeof(T) <= sizeof(uint64_t);
+
+	template<VarintInteger T>
+	constexpr uint64_t toVarint(T value) noexcept
+	{
+		if constexpr (std::is_signed_v<T>)
+		{
+			return utility::encodeZigzag(value);
+		}
+		else
+		{
+			return value;
+		}
+	}
+
+	/// @brief Value is truncated to T if it was encoded from wider type
+	template<VarintInteger T>
+	constexpr T fromVarint(uint64_t value) noexcept
+	{
+		if constexpr (std::is_signed_v<T>)
+		{
+			return static_cast<T>(utility::decodeZigzag(value));
+		}
+		else
+		{
+			return static_cast<T>(value);
+		}
+	}
+
+	/// @brief Load 8 bytes as little endian word
+	inline uint64_t loadLittleEndian64(const char* data) noexcept
+	{
+		uint64_t word = 0;
+
+		if constexpr (std::endian::native == std::endian::little)
+		{
+			std::memcpy(&word, data, sizeof(word));
+		}
+		else
+		{
+			for (size_t i = 0; i < sizeof(word); i++)
+			{
+				word |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (i * 8);
+			}
+		}
+
+		return word;
+	}
+
+	inline void storeLittleEndian64(uint64_t word, char* data) noexcept
+	{
+		if constexpr (std::endian::native == std::endian::little)
+		{
+			std::memcpy(data, &word, sizeof(word));
+		}
+		else
+		{
+			for (size_t i = 0; i < sizeof(word); i++)
+			{
+				data[i] = static_cast<char>(word >> (i * 8));
+			}
+		}
+	}
+
+	/// @brief Number of values in encoded data: every value has one byte with high bit cleared
+	inline size_t countVarints(const char* data, size_t size) noexcept
+	{
+		size_t result = 0;
+		size_t offset = 0;
+
+		for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t))
+		{
+			uint64_t word;
+
+			std::memcpy(&word, data + offset, sizeof(word));
+
+			result += std::popcount(~word & 0x8080808080808080ULL);
+		}
+
+		for (; offset < size; offset++)
+		{
+			result += !(data[offset] & 0x80);
+		}
+
+		return result;
+	}
+
+	/**
+	 * @brief Decode value of up to 8 bytes from little endian word
+	 * @param word
+	 * @param value
+	 * @return Size of value in bytes, 0 if word doesn't contain last byte of value
+	 */
+	inline size_t decodeWordVarint(uint64_t word, uint64_t& value) noexcept
+	{
+		uint64_t lastBytes = ~word & 0x8080808080808080ULL;
+
+		if (!lastBytes)
+		{
+			return 0;
+		}
+
+		size_t size = std::countr_zero(lastBytes) / 8 + 1;
+
+		word &= ~0ULL >> ((sizeof(uint64_t) - size) * 8);
+
+		value =
+			(word & 0x7F) |
+			((word >> 1) & 0x3F80) |
+			((word >> 2) & 0x1FC000) |
+			((word >> 3) & 0xFE00000) |
+			((word >> 4) & 0x7F0000000ULL) |
+			((word >> 5) & 0x3F800000000ULL) |
+			((word >> 6) & 0x1FC0000000000ULL) |
+			((word >> 7) & 0xFE000000000000ULL);
+
+		return size;
+	}
+
+	/**
+	 * @brief Encode values one after another. Groups of 8 values below 128 are written as one word
+	 * @param values
+	 * @param data At least values.size() * maxVarint64Size bytes
+	 * @return Number of written bytes
+	 */
+	template<VarintInteger T>
+	size_t encodeVarints(std::span<const T> values, char* data) noexcept
+	{
+		constexpr size_t groupSize = sizeof(uint64_t);
+
+		size_t size = 0;
+		size_t i = 0;
+		size_t groupEnd = 0;
+
+		while (i < values.size())
+		{
+			uint64_t encoded = utility::toVarint(values[i]);
+
+			if (encoded < 0x80 && i >= groupEnd && i + groupSize <= values.size())
+			{
+				uint64_t word = 0;
+				uint64_t highBits = 0;
+
+				for (size_t j = 0; j < groupSize; j++)
+				{
+					uint64_t groupValue = utility::toVarint(values[i + j]);
+
+					highBits |= groupValue;
+					word |= (groupValue & 0xFF) << (j * 8);
+				}
+
+				if (highBits < 0x80)
+				{
+					utility::storeLittleEndian64(word, data + size);
+
+					size += groupSize;
+					i += groupSize;
+
+					continue;
+				}
+
+				// Group has larger values, so encode it value by value without checking again
+				groupEnd = i + groupSize;
+			}
+
+			size += utility::encodeVarint(encoded, data + size);
+			i++;
+		}
+
+		return size;
+	}
+
+	/**
+	 * @brief Decode values written by encodeVarints. Words of 8 single byte values are decoded at once, other values from one word each without loop over bytes
+	 * @param data
+	 * @param size
+	 * @param values Receives exactly values.size() values
+	 * @return Number of read bytes, 0 if data is malformed or has fewer values
+	 */
+	template<VarintInteger T>
+	size_t decodeVarints(const char* data, size_t size, std::span<T> values) noexcept
+	{
+		constexpr size_t groupSize = sizeof(uint64_t);
+
+		size_t offset = 0;
+		size_t i = 0;
+
+		while (i < values.size())
+		{
+			uint64_t word = offset + groupSize <= size ? utility::loadLittleEndian64(data + offset) : 0;
+
+			if (i + groupSize <= values.size() && offset + groupSize <= size && !(word & 0x8080808080808080ULL))
+			{
+				for (size_t j = 0; j < groupSize; j++)
+				{
+					values[i + j] = utility::fromVarint<T>((word >> (j * 8)) & 0x7F);
+				}
+
+				i += groupSize;
+				offset += groupSize;
+
+				continue;
+			}
+
+			uint64_t decoded = 0;
+			size_t valueSize = offset + groupSize <= size ? utility::decodeWordVarint(word, decoded) : 0;
+
+			if (!valueSize)
+			{
+				valueSize = utility::decodeVarint(data + offset, size - offset, decoded);
+
+				if (!valueSize)
+				{
+					return 0;
+				}
+			}
+
+			values[i++] = utility::fromVarint<T>(decoded);
+			offset += valueSize;
+		}
+
+		return offset;
+	}
+}
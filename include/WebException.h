@@ -20,6 +20,11 @@ namespace web::exceptions
 	public:
 		WebException(int line, std::string_view file);
 
+		/// @brief Exception with error code that doesn't come from errno/WSAGetLastError
+		/// @param errorCode Library specific error code
+		/// @param description Error description
+		WebException(int errorCode, std::string_view description, int line, std::string_view file);
+
 		WebException(const WebException& other) = default;
 
 		WebException(WebException&& other) noexcept = default;
@@ -1,11 +1,6 @@
 #include "IOSocketBuffer.h"
 
-#ifdef __LINUX__
-#include <sys/mman.h>
-#include <unistd.h>
-#else
-#include <Windows.h>
-#endif
+#include "PageRegionPool.h"
 
 namespace buffers
 {
@@ -13,11 +8,7 @@ namespace buffers
 	{
 		if (pageData)
 		{
-#ifdef __LINUX__
-			munmap(pageData, totalSize);
-#else
-			VirtualFree(pageData, 0, MEM_RELEASE);
-#endif
+			PageRegionPool::get().deallocate(pageData, totalSize);
 
 			pageData = nullptr;
 		}
@@ -27,33 +18,27 @@ namespace buffers
 		totalSize(0),
 		pageData(nullptr)
 	{
-#ifdef __LINUX__
-		totalSize = sysconf(_SC_PAGESIZE);
-		pageSize = totalSize;
-		pageData = mmap(NULL, totalSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-#else
-		SYSTEM_INFO sysInfo;
-
-		GetSystemInfo(&sysInfo);
-
-		totalSize = sysInfo.dwPageSize;
-		pageSize = totalSize;
-		pageData = VirtualAlloc(NULL, totalSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-#endif
+
 	}
 
-	IOSocketBuffer::BufferArray::BufferArray(BufferArray&& other) noexcept
+	IOSocketBuffer::BufferArray::BufferArray(BufferArray&& other) noexcept :
+		totalSize(0),
+		pageData(nullptr)
 	{
 		(*this) = std::move(other);
 	}
 
 	IOSocketBuffer::BufferArray& IOSocketBuffer::BufferArray::operator =(BufferArray&& other) noexcept
 	{
-		pageData = other.pageData;
-		pageSize = other.pageSize;
-		totalSize = other.totalSize;
+		if (this != &other)
+		{
+			this->free();
 
-		other.pageData = nullptr;
+			pageData = other.pageData;
+			totalSize = other.totalSize;
+
+			other.pageData = nullptr;
+		}
 
 		return *this;
 	}
@@ -80,29 +65,46 @@ namespace buffers
 			return;
 		}
 
-		void* newRegion = nullptr;
-		size_t pages = size / pageSize;
+		PageRegionPool& pool = PageRegionPool::get();
+		size_t newSize = pool.getRegionSize(size);
+		void* newRegion = pool.allocate(newSize);
 
-		if (size % pageSize)
+		std::copy(this->data(), this->data() + totalSize, static_cast<char*>(newRegion));
+
+		this->free();
+
+		totalSize = newSize;
+		pageData = newRegion;
+	}
+
+	bool IOSocketBuffer::BufferArray::shrink(size_t size)
+	{
+		if (!size)
 		{
-			pages++;
-		}
+			bool allocated = pageData;
 
-		size_t newSize = pages * pageSize;
+			this->free();
 
-#ifdef __LINUX__
-		newRegion = mmap(NULL, newSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-#else
-		newRegion = VirtualAlloc(NULL, newSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-#endif
+			totalSize = 0;
 
-		std::copy(this->data(), this->data() + totalSize, static_cast<char*>(newRegion));
+			return allocated;
+		}
 
-		totalSize = newSize;
+		PageRegionPool& pool = PageRegionPool::get();
+		size_t newSize = pool.getRegionSize(size);
+
+		if (newSize >= totalSize)
+		{
+			return false;
+		}
 
 		this->free();
 
-		pageData = newRegion;
+		totalSize = 0;
+		pageData = pool.allocate(newSize);
+		totalSize = newSize;
+
+		return true;
 	}
 
 	char& IOSocketBuffer::BufferArray::operator [](size_t index)
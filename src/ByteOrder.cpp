@@ -0,0 +1,315 @@
+#include "ByteOrder.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BYTE_ORDER_X86
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+
+#define BYTE_ORDER_SSSE3_TARGET
+#define BYTE_ORDER_AVX2_TARGET
+#else
+#include <immintrin.h>
+
+#define BYTE_ORDER_SSSE3_TARGET __attribute__((target("ssse3")))
+#define BYTE_ORDER_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define BYTE_ORDER_ARM
+
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
+
+namespace web::utility
+{
+	using ByteSwapFunction = void(*)(const uint8_t* source, uint8_t* destination, size_t count, size_t elementSize);
+
+	template<typename T>
+	static T swapElement(T value)
+	{
+#ifdef _MSC_VER
+		if constexpr (sizeof(T) == sizeof(uint16_t))
+		{
+			return _byteswap_ushort(value);
+		}
+		else if constexpr (sizeof(T) == sizeof(uint32_t))
+		{
+			return _byteswap_ulong(value);
+		}
+		else
+		{
+			return _byteswap_uint64(value);
+		}
+#else
+		if constexpr (sizeof(T) == sizeof(uint16_t))
+		{
+			return __builtin_bswap16(value);
+		}
+		else if constexpr (sizeof(T) == sizeof(uint32_t))
+		{
+			return __builtin_bswap32(value);
+		}
+		else
+		{
+			return __builtin_bswap64(value);
+		}
+#endif
+	}
+
+	template<typename T>
+	static void softwareElements(const uint8_t* source, uint8_t* destination, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			T value;
+
+			std::memcpy(&value, source + i * sizeof(T), sizeof(T));
+
+			value = swapElement(value);
+
+			std::memcpy(destination + i * sizeof(T), &value, sizeof(T));
+		}
+	}
+
+	static void software(const uint8_t* source, uint8_t* destination, size_t count, size_t elementSize)
+	{
+		switch (elementSize)
+		{
+		case sizeof(uint16_t):
+			softwareElements<uint16_t>(source, destination, count);
+
+			break;
+
+		case sizeof(uint32_t):
+			softwareElements<uint32_t>(source, destination, count);
+
+			break;
+
+		case sizeof(uint64_t):
+			softwareElements<uint64_t>(source, destination, count);
+
+			break;
+
+		default:
+			if (source != destination)
+			{
+				std::memcpy(destination, source, count * elementSize);
+			}
+		}
+	}
+
+#if defined(BYTE_ORDER_X86)
+	/// @brief pshufb masks that reverse 2, 4 and 8 byte elements of 16 byte lane
+	alignas(16) static constexpr std::array<std::array<uint8_t, 16>, 3> shuffleMasks =
+	{ {
+		{ 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 },
+		{ 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 },
+		{ 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 }
+	} };
+
+	static const uint8_t* getShuffleMask(size_t elementSize)
+	{
+		return shuffleMasks[std::countr_zero(elementSize) - 1].data();
+	}
+
+	BYTE_ORDER_SSSE3_TARGET static void ssse3(const uint8_t* source, uint8_t* destination, size_t count, size_t elementSize)
+	{
+		__m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(getShuffleMask(elementSize)));
+		size_t size = count * elementSize;
+		size_t offset = 0;
+
+		for (; offset + sizeof(__m128i) <= size; offset += sizeof(__m128i))
+		{
+			__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + offset));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + offset), _mm_shuffle_epi8(value, mask));
+		}
+
+		software(source + offset, destination + offset, (size - offset) / elementSize, elementSize);
+	}
+
+	BYTE_ORDER_AVX2_TARGET static void avx2(const uint8_t* source, uint8_t* destination, size_t count, size_t elementSize)
+	{
+		__m256i mask = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(getShuffleMask(elementSize))));
+		size_t size = count * elementSize;
+		size_t offset = 0;
+
+		for (; offset + sizeof(__m256i) * 2 <= size; offset += sizeof(__m256i) * 2)
+		{
+			__m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + offset));
+			__m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + offset + sizeof(__m256i)));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + offset), _mm256_shuffle_epi8(first, mask));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + offset + sizeof(__m256i)), _mm256_shuffle_epi8(second, mask));
+		}
+
+		if (offset + sizeof(__m256i) <= size)
+		{
+			__m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + offset));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + offset), _mm256_shuffle_epi8(value, mask));
+
+			offset += sizeof(__m256i);
+		}
+
+		software(source + offset, destination + offset, (size - offset) / elementSize, elementSize);
+	}
+
+	static ByteSwapFunction selectImplementation(std::string_view& name)
+	{
+#ifdef _MSC_VER
+		int registers[4] = {};
+
+		__cpuid(registers, 1);
+
+		bool hasSsse3 = registers[2] & (1 << 9);
+		bool hasOsAvx = (registers[2] & (1 << 27)) && (registers[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+
+		__cpuidex(registers, 7, 0);
+
+		bool hasAvx2 = hasOsAvx && (registers[1] & (1 << 5));
+#else
+		__builtin_cpu_init();
+
+		bool hasSsse3 = __builtin_cpu_supports("ssse3");
+		bool hasAvx2 = __builtin_cpu_supports("avx2");
+#endif
+
+		if (hasAvx2)
+		{
+			name = "avx2";
+
+			return avx2;
+		}
+		else if (hasSsse3)
+		{
+			name = "ssse3";
+
+			return ssse3;
+		}
+
+		name = "software";
+
+		return software;
+	}
+#elif defined(BYTE_ORDER_ARM)
+	template<size_t ElementSize>
+	static void neonElements(const uint8_t* source, uint8_t* destination, size_t count)
+	{
+		size_t size = count * ElementSize;
+		size_t offset = 0;
+
+		for (; offset + sizeof(uint8x16_t) <= size; offset += sizeof(uint8x16_t))
+		{
+			uint8x16_t value = vld1q_u8(source + offset);
+
+			if constexpr (ElementSize == sizeof(uint16_t))
+			{
+				value = vrev16q_u8(value);
+			}
+			else if constexpr (ElementSize == sizeof(uint32_t))
+			{
+				value = vrev32q_u8(value);
+			}
+			else
+			{
+				value = vrev64q_u8(value);
+			}
+
+			vst1q_u8(destination + offset, value);
+		}
+
+		software(source + offset, destination + offset, (size - offset) / ElementSize, ElementSize);
+	}
+
+	/// @brief NEON is part of ARMv8, so it doesn't need detection
+	static void neon(const uint8_t* source, uint8_t* destination, size_t count, size_t elementSize)
+	{
+		switch (elementSize)
+		{
+		case sizeof(uint16_t):
+			neonElements<sizeof(uint16_t)>(source, destination, count);
+
+			break;
+
+		case sizeof(uint32_t):
+			neonElements<sizeof(uint32_t)>(source, destination, count);
+
+			break;
+
+		default:
+			neonElements<sizeof(uint64_t)>(source, destination, count);
+
+			break;
+		}
+	}
+
+	static ByteSwapFunction selectImplementation(std::string_view& name)
+	{
+		name = "neon";
+
+		return neon;
+	}
+#else
+	static ByteSwapFunction selectImplementation(std::string_view& name)
+	{
+		name = "software";
+
+		return software;
+	}
+#endif
+
+	struct ByteSwapImplementation
+	{
+		std::string_view name;
+		ByteSwapFunction function;
+
+		ByteSwapImplementation() :
+			function(selectImplementation(name))
+		{
+
+		}
+	};
+
+	static const ByteSwapImplementation& getImplementation()
+	{
+		static const ByteSwapImplementation implementation;
+
+		return implementation;
+	}
+
+	void byteSwap(const void* source, void* destination, size_t count, size_t elementSize) noexcept
+	{
+		if (elementSize != sizeof(uint16_t) && elementSize != sizeof(uint32_t) && elementSize != sizeof(uint64_t))
+		{
+			software(static_cast<const uint8_t*>(source), static_cast<uint8_t*>(destination), count, elementSize);
+
+			return;
+		}
+
+		getImplementation().function(static_cast<const uint8_t*>(source), static_cast<uint8_t*>(destination), count, elementSize);
+	}
+
+	void byteSwapSoftware(const void* source, void* destination, size_t count, size_t elementSize) noexcept
+	{
+		software(static_cast<const uint8_t*>(source), static_cast<uint8_t*>(destination), count, elementSize);
+	}
+
+	std::string_view getByteSwapImplementation() noexcept
+	{
+		return getImplementation().name;
+	}
+}
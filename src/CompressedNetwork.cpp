@@ -0,0 +1,378 @@
+#include "CompressedNetwork.h"
+
+#ifdef SOCKET_STREAMS_COMPRESSION
+
+namespace web
+{
+	/// @brief Size header and uncompressed size
+	static constexpr size_t compressedHeaderSize = sizeof(uint32_t) * 2;
+
+	int CompressedNetwork::sendFrame(const char* data, int size, bool& endOfStream, int flags)
+	{
+		if (static_cast<size_t>(size) < threshold)
+		{
+			compressionStatistics.uncompressedFrames++;
+
+			return Network::sendRawData(data, size, endOfStream, flags);
+		}
+
+		uLong bound = deflateBound(&compressor, static_cast<uLong>(size));
+
+		if (sendBuffer.size() < compressedHeaderSize + bound)
+		{
+			sendBuffer.resize(compressedHeaderSize + bound);
+		}
+
+		deflateReset(&compressor);
+
+		compressor.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+		compressor.avail_in = static_cast<uInt>(size);
+		compressor.next_out = reinterpret_cast<Bytef*>(sendBuffer.data() + compressedHeaderSize);
+		compressor.avail_out = static_cast<uInt>(bound);
+
+		if (int code = deflate(&compressor, Z_FINISH); code != Z_STREAM_END)
+		{
+			throw exceptions::WebException(code, compressor.msg ? compressor.msg : zError(code), __LINE__, __FILE__);
+		}
+
+		uint32_t compressedSize = static_cast<uint32_t>(compressor.total_out);
+
+		if (compressedSize >= static_cast<uint32_t>(size))
+		{
+			compressionStatistics.uncompressedFrames++;
+
+			return Network::sendRawData(data, size, endOfStream, flags);
+		}
+
+		uint32_t header[] = { compressedSize | compressedFlag, static_cast<uint32_t>(size) };
+
+		std::copy_n(reinterpret_cast<const char*>(header), sizeof(header), sendBuffer.data());
+
+		// Header and payload in one send
+		int lastPacketSize = this->sendBytes(sendBuffer.data(), static_cast<int>(compressedHeaderSize + compressedSize), endOfStream, flags);
+
+		if (endOfStream)
+		{
+			return lastPacketSize;
+		}
+
+		compressionStatistics.compressedFrames++;
+		compressionStatistics.inputBytes += size;
+		compressionStatistics.outputBytes += compressedSize;
+
+		return size;
+	}
+
+	int CompressedNetwork::receiveCompressedFrame(uint32_t header, bool& endOfStream, int flags)
+	{
+		uint32_t compressedSize = header & ~compressedFlag;
+		uint32_t size = 0;
+		int lastPacketSize = this->receiveBytes(&size, sizeof(size), endOfStream, flags);
+
+		if (endOfStream)
+		{
+			return lastPacketSize;
+		}
+
+		this->checkFrameSize(compressedSize, compressedSize, flags);
+		this->checkFrameSize(size, compressedSize, flags);
+
+		if (receiveBuffer.size() < compressedSize)
+		{
+			receiveBuffer.resize(compressedSize);
+		}
+
+		lastPacketSize = this->receiveBytes(receiveBuffer.data(), static_cast<int>(compressedSize), endOfStream, flags);
+
+		if (endOfStream)
+		{
+			return lastPacketSize;
+		}
+
+		inflateReset(&decompressor);
+
+		decompressor.next_in = reinterpret_cast<Bytef*>(receiveBuffer.data());
+		decompressor.avail_in = compressedSize;
+
+		return static_cast<int>(size);
+	}
+
+	void CompressedNetwork::decompress(char* data, uint32_t size)
+	{
+		std::span<char> buffer(data, size);
+
+		this->decompress(std::span<const std::span<char>>(&buffer, 1), size);
+	}
+
+	void CompressedNetwork::decompress(std::span<const std::span<char>> buffers, uint32_t size)
+	{
+		int code = Z_OK;
+
+		for (std::span<char> buffer : buffers)
+		{
+			if (buffer.empty())
+			{
+				continue;
+			}
+
+			decompressor.next_out = reinterpret_cast<Bytef*>(buffer.data());
+			decompressor.avail_out = static_cast<uInt>(buffer.size());
+
+			if (code = inflate(&decompressor, Z_NO_FLUSH); code != Z_OK)
+			{
+				break;
+			}
+		}
+
+		if (code == Z_OK)
+		{
+			// End of stream isn't reported while it fits exactly into last buffer
+			decompressor.avail_out = 0;
+
+			code = inflate(&decompressor, Z_FINISH);
+		}
+
+		if (code != Z_STREAM_END || decompressor.total_out != size)
+		{
+			if (code == Z_STREAM_END || code == Z_BUF_ERROR)
+			{
+				code = Z_DATA_ERROR;
+			}
+
+			throw exceptions::WebException(code, decompressor.msg ? decompressor.msg : zError(code), __LINE__, __FILE__);
+		}
+	}
+
+	int CompressedNetwork::sendBytesImplementation(const char* data, int size, int flags)
+	{
+		bool endOfStream = false;
+
+		return network->sendBytes(data, size, endOfStream, flags);
+	}
+
+	int CompressedNetwork::receiveBytesImplementation(char* data, int size, int flags)
+	{
+		bool endOfStream = false;
+
+		return network->receiveBytes(data, size, endOfStream, flags);
+	}
+
+	CompressedNetwork::CompressedNetwork(std::unique_ptr<Network>&& network, size_t threshold, int level) :
+		Network(*network),
+		network(std::move(network)),
+		compressor(),
+		decompressor(),
+		threshold(threshold)
+	{
+		frameChecksum = false;
+		frameHeader = FrameHeader::fixed;
+
+		if (int code = deflateInit(&compressor, level); code != Z_OK)
+		{
+			throw exceptions::WebException(code, zError(code), __LINE__, __FILE__);
+		}
+
+		if (int code = inflateInit(&decompressor); code != Z_OK)
+		{
+			deflateEnd(&compressor);
+
+			throw exceptions::WebException(code, zError(code), __LINE__, __FILE__);
+		}
+	}
+
+	int CompressedNetwork::sendData(const utility::ContainerWrapper& data, bool& endOfStream, int flags)
+	{
+		return this->sendFrame(data.data(), static_cast<int>(data.size()), endOfStream, flags);
+	}
+
+	int CompressedNetwork::sendRawData(const char* data, int size, bool& endOfStream, int flags)
+	{
+		return this->sendFrame(data, size, endOfStream, flags);
+	}
+
+	int CompressedNetwork::receiveData(utility::ContainerWrapper& data, bool& endOfStream, int flags)
+	{
+		uint32_t header = 0;
+		int lastPacketSize = this->receiveBytes(&header, sizeof(header), endOfStream, flags);
+
+		if (endOfStream)
+		{
+			return lastPacketSize;
+		}
+
+		if (!(header & compressedFlag))
+		{
+			this->checkFrameSize(header, header, flags);
+
+			data.resizeAndOverwrite
+			(
+				static_cast<size_t>(header),
+				[&](char* buffer) -> size_t
+				{
+					lastPacketSize = this->receiveBytes(buffer, static_cast<int>(header), endOfStream, flags);
+
+					return endOfStream ? 0 : static_cast<size_t>(header);
+				}
+			);
+
+			return lastPacketSize;
+		}
+
+		int size = this->receiveCompressedFrame(header, endOfStream, flags);
+
+		if (endOfStream)
+		{
+			return size;
+		}
+
+		// Checked in receiveCompressedFrame before payload received
+		data.resizeAndOverwrite
+		(
+			static_cast<size_t>(size),
+			[&](char* buffer) -> size_t
+			{
+				this->decompress(buffer, static_cast<uint32_t>(size));
+
+				return static_cast<size_t>(size);
+			}
+		);
+
+		return size;
+	}
+
+	int CompressedNetwork::receiveRawData(char* data, int size, bool& endOfStream, int flags)
+	{
+		uint32_t header = 0;
+		int lastPacketSize = this->receiveBytes(&header, sizeof(header), endOfStream, flags);
+
+		if (endOfStream)
+		{
+			return lastPacketSize;
+		}
+
+		if (!(header & compressedFlag))
+		{
+			if (static_cast<uint32_t>(size) < header)
+			{
+				std::cerr << "In " << __FUNCTION__ << " passed size(" << size << ") < actual data size(" << header << ')' << std::endl;
+			}
+
+			return this->receiveBytes(data, size, endOfStream, flags);
+		}
+
+		int inputSize = this->receiveCompressedFrame(header, endOfStream, flags);
+
+		if (endOfStream)
+		{
+			return inputSize;
+		}
+
+		if (size < inputSize)
+		{
+			std::vector<char> frame(static_cast<size_t>(inputSize));
+
+			std::cerr << "In " << __FUNCTION__ << " passed size(" << size << ") < actual data size(" << inputSize << ')' << std::endl;
+
+			this->decompress(frame.data(), static_cast<uint32_t>(inputSize));
+
+			std::copy_n(frame.data(), size, data);
+
+			return size;
+		}
+
+		this->decompress(data, static_cast<uint32_t>(inputSize));
+
+		return inputSize;
+	}
+
+	int CompressedNetwork::receiveScatteredData(std::span<char> header, utility::ContainerWrapper& body, bool& endOfStream, int flags)
+	{
+		uint32_t sizeHeader = 0;
+		int lastPacketSize = this->receiveBytes(&sizeHeader, sizeof(sizeHeader), endOfStream, flags);
+
+		if (endOfStream)
+		{
+			return lastPacketSize;
+		}
+
+		bool compressed = sizeHeader & compressedFlag;
+		int size = static_cast<int>(sizeHeader);
+
+		if (compressed)
+		{
+			size = this->receiveCompressedFrame(sizeHeader, endOfStream, flags);
+
+			if (endOfStream)
+			{
+				return size;
+			}
+		}
+
+		if (static_cast<size_t>(size) < header.size())
+		{
+			throw exceptions::WebException(EBADMSG, "Frame is smaller than header", __LINE__, __FILE__);
+		}
+
+		if (!compressed)
+		{
+			this->checkFrameSize(size, size, flags);
+		}
+
+		size_t bodySize = static_cast<size_t>(size) - header.size();
+
+		body.resizeAndOverwrite
+		(
+			bodySize,
+			[&](char* buffer) -> size_t
+			{
+				std::array<std::span<char>, 2> buffers = { header, std::span<char>(buffer, bodySize) };
+
+				if (!compressed)
+				{
+					lastPacketSize = this->receiveFrameBuffers(buffers, endOfStream, flags);
+
+					return endOfStream ? 0 : bodySize;
+				}
+
+				this->decompress(buffers, static_cast<uint32_t>(size));
+
+				return bodySize;
+			}
+		);
+
+		return compressed || !endOfStream ? size : lastPacketSize;
+	}
+
+	bool CompressedNetwork::enableFrameChecksum(bool enable)
+	{
+		return !enable;
+	}
+
+	bool CompressedNetwork::setFrameHeader(FrameHeader header)
+	{
+		return header == FrameHeader::fixed;
+	}
+
+	bool CompressedNetwork::hasPendingInput() const noexcept
+	{
+		return Network::hasPendingInput() || network->hasPendingInput();
+	}
+
+	const std::unique_ptr<Network>& CompressedNetwork::getNetwork() const noexcept
+	{
+		return network;
+	}
+
+	const CompressedNetwork::CompressionStatistics& CompressedNetwork::getCompressionStatistics() const noexcept
+	{
+		return compressionStatistics;
+	}
+
+	CompressedNetwork::~CompressedNetwork()
+	{
+		deflateEnd(&compressor);
+		inflateEnd(&decompressor);
+	}
+}
+
+#endif // SOCKET_STREAMS_COMPRESSION
@@ -2,12 +2,24 @@
 
 namespace web::utility
 {
+	void dropFrame(size_t size, const std::function<size_t(char*)>* overwrite, std::string_view message)
+	{
+		if (overwrite)
+		{
+			UninitializedBuffer frame(size);
+
+			(*overwrite)(frame.data());
+		}
+
+		throw exceptions::WebException(EBADMSG, message, __LINE__, __FILE__);
+	}
+
 	ContainerWrapper::ContainerWrapper
 	(
 		const std::function<char* ()>& dataImplementation,
 		const std::function<const char* ()>& constDataImplementation,
 		const std::function<size_t()>& sizeImplementation,
-		const std::function<void(size_t)>& resizeImplementation,
+		const std::function<void(size_t, const std::function<size_t(char*)>*)>& resizeImplementation,
 		const std::function<char& (size_t)>& operatorImplementation
 	) :
 		dataImplementation(dataImplementation),
@@ -36,7 +48,12 @@ namespace web::utility
 
 	void ContainerWrapper::resize(size_t newSize)
 	{
-		resizeImplementation(newSize);
+		resizeImplementation(newSize, nullptr);
+	}
+
+	void ContainerWrapper::resizeAndOverwrite(size_t newSize, const std::function<size_t(char*)>& overwrite)
+	{
+		resizeImplementation(newSize, &overwrite);
 	}
 
 	char& ContainerWrapper::operator [](size_t index)
@@ -0,0 +1,363 @@
+#include "Crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CRC32C_X86
+
+#ifdef _MSC_VER
+#include <intrin.h>
+
+#define CRC32C_X86_TARGET
+#else
+#include <immintrin.h>
+
+#define CRC32C_X86_TARGET __attribute__((target("sse4.2,pclmul")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CRC32C_ARM
+
+#ifdef _MSC_VER
+#include <Windows.h>
+#include <arm64intr.h>
+
+#define CRC32C_ARM_TARGET
+#else
+#include <arm_acle.h>
+
+#ifdef __linux__
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#define CRC32C_ARM_TARGET __attribute__((target("+crc")))
+#endif
+#endif
+
+namespace web::utility
+{
+	using Crc32cFunction = uint32_t(*)(const uint8_t* data, size_t size, uint32_t crc);
+
+	/// @brief Reversed Castagnoli polynomial
+	static constexpr uint32_t polynomial = 0x82F63B78;
+
+	static constexpr std::array<std::array<uint32_t, 256>, 8> createTables()
+	{
+		std::array<std::array<uint32_t, 256>, 8> result = {};
+
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t crc = i;
+
+			for (int bit = 0; bit < 8; bit++)
+			{
+				crc = crc & 1 ? (crc >> 1) ^ polynomial : crc >> 1;
+			}
+
+			result[0][i] = crc;
+		}
+
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			for (size_t table = 1; table < result.size(); table++)
+			{
+				result[table][i] = (result[table - 1][i] >> 8) ^ result[0][result[table - 1][i] & 0xFF];
+			}
+		}
+
+		return result;
+	}
+
+	static constexpr std::array<std::array<uint32_t, 256>, 8> tables = createTables();
+
+	static uint64_t load64(const uint8_t* data)
+	{
+		uint64_t result;
+
+		std::memcpy(&result, data, sizeof(result));
+
+		return result;
+	}
+
+	/// @brief Little endian register, all supported targets are little endian
+	static uint32_t software(const uint8_t* data, size_t size, uint32_t crc)
+	{
+		while (size && reinterpret_cast<uintptr_t>(data) % sizeof(uint64_t))
+		{
+			crc = (crc >> 8) ^ tables[0][(crc ^ *data++) & 0xFF];
+			size--;
+		}
+
+		for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), data += sizeof(uint64_t))
+		{
+			uint64_t value = load64(data) ^ crc;
+
+			crc =
+				tables[7][value & 0xFF] ^
+				tables[6][(value >> 8) & 0xFF] ^
+				tables[5][(value >> 16) & 0xFF] ^
+				tables[4][(value >> 24) & 0xFF] ^
+				tables[3][(value >> 32) & 0xFF] ^
+				tables[2][(value >> 40) & 0xFF] ^
+				tables[1][(value >> 48) & 0xFF] ^
+				tables[0][value >> 56];
+		}
+
+		while (size--)
+		{
+			crc = (crc >> 8) ^ tables[0][(crc ^ *data++) & 0xFF];
+		}
+
+		return crc;
+	}
+
+#ifdef CRC32C_X86
+	/// @brief Lane sizes of 3 way interleaving. crc32 instruction has latency 3 and throughput 1, so 3 independent lanes saturate it
+	static constexpr std::array<size_t, 2> laneSizes = { 8192, 256 };
+
+	/// @brief a * b modulo polynomial in reflected representation
+	static uint32_t multiplyModulo(uint32_t a, uint32_t b)
+	{
+		uint32_t result = 0;
+
+		for (uint32_t mask = 1U << 31; mask; mask >>= 1)
+		{
+			if (a & mask)
+			{
+				result ^= b;
+			}
+
+			b = b & 1 ? (b >> 1) ^ polynomial : b >> 1;
+		}
+
+		return result;
+	}
+
+	/// @brief x^power modulo polynomial in reflected representation
+	static uint32_t powerModulo(uint64_t power)
+	{
+		uint32_t result = 1U << 31;
+		uint32_t square = 1U << 30;
+
+		for (; power; power >>= 1)
+		{
+			if (power & 1)
+			{
+				result = multiplyModulo(result, square);
+			}
+
+			square = multiplyModulo(square, square);
+		}
+
+		return result;
+	}
+
+	/**
+	 * @brief Constants that shift CRC of lane over zeroes of next lanes
+	 * Carry-less product of 32 bit values is one bit short of 64 bit reflected value and crc32 of it multiplies by x^32, so constant for shift over n bytes is x^(8n - 33)
+	 */
+	static const std::array<uint32_t, laneSizes.size()>& getShiftConstants()
+	{
+		static const std::array<uint32_t, laneSizes.size()> constants = []()
+			{
+				std::array<uint32_t, laneSizes.size()> result = {};
+
+				for (size_t i = 0; i < laneSizes.size(); i++)
+				{
+					result[i] = powerModulo(laneSizes[i] * 8 - 33);
+				}
+
+				return result;
+			}();
+
+		return constants;
+	}
+
+	CRC32C_X86_TARGET static uint32_t shift(uint32_t crc, uint32_t constant)
+	{
+		__m128i product = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(crc)), _mm_cvtsi32_si128(static_cast<int>(constant)), 0);
+
+		return static_cast<uint32_t>(_mm_crc32_u64(0, static_cast<uint64_t>(_mm_cvtsi128_si64(product))));
+	}
+
+	CRC32C_X86_TARGET static uint32_t sse42(const uint8_t* data, size_t size, uint32_t crc)
+	{
+		while (size && reinterpret_cast<uintptr_t>(data) % sizeof(uint64_t))
+		{
+			crc = _mm_crc32_u8(crc, *data++);
+			size--;
+		}
+
+		uint64_t crc64 = crc;
+
+		for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), data += sizeof(uint64_t))
+		{
+			crc64 = _mm_crc32_u64(crc64, load64(data));
+		}
+
+		crc = static_cast<uint32_t>(crc64);
+
+		while (size--)
+		{
+			crc = _mm_crc32_u8(crc, *data++);
+		}
+
+		return crc;
+	}
+
+	CRC32C_X86_TARGET static uint32_t sse42Pclmul(const uint8_t* data, size_t size, uint32_t crc)
+	{
+		const std::array<uint32_t, laneSizes.size()>& constants = getShiftConstants();
+
+		while (size && reinterpret_cast<uintptr_t>(data) % sizeof(uint64_t))
+		{
+			crc = _mm_crc32_u8(crc, *data++);
+			size--;
+		}
+
+		for (size_t i = 0; i < laneSizes.size(); i++)
+		{
+			size_t laneSize = laneSizes[i];
+
+			for (; size >= laneSize * 3; size -= laneSize * 3, data += laneSize * 3)
+			{
+				uint64_t first = crc;
+				uint64_t second = 0;
+				uint64_t third = 0;
+
+				for (size_t offset = 0; offset < laneSize; offset += sizeof(uint64_t))
+				{
+					first = _mm_crc32_u64(first, load64(data + offset));
+					second = _mm_crc32_u64(second, load64(data + laneSize + offset));
+					third = _mm_crc32_u64(third, load64(data + laneSize * 2 + offset));
+				}
+
+				crc = shift(shift(static_cast<uint32_t>(first), constants[i]) ^ static_cast<uint32_t>(second), constants[i]) ^ static_cast<uint32_t>(third);
+			}
+		}
+
+		return sse42(data, size, crc);
+	}
+
+	static Crc32cFunction selectImplementation(std::string_view& name)
+	{
+#ifdef _MSC_VER
+		int registers[4] = {};
+
+		__cpuid(registers, 1);
+
+		bool hasSse42 = registers[2] & (1 << 20);
+		bool hasPclmul = registers[2] & (1 << 1);
+#else
+		__builtin_cpu_init();
+
+		bool hasSse42 = __builtin_cpu_supports("sse4.2");
+		bool hasPclmul = __builtin_cpu_supports("pclmul");
+#endif
+
+		if (hasSse42 && hasPclmul)
+		{
+			name = "sse4.2+pclmul";
+
+			return sse42Pclmul;
+		}
+		else if (hasSse42)
+		{
+			name = "sse4.2";
+
+			return sse42;
+		}
+
+		name = "software";
+
+		return software;
+	}
+#elif defined(CRC32C_ARM)
+	CRC32C_ARM_TARGET static uint32_t armv8(const uint8_t* data, size_t size, uint32_t crc)
+	{
+		while (size && reinterpret_cast<uintptr_t>(data) % sizeof(uint64_t))
+		{
+			crc = __crc32cb(crc, *data++);
+			size--;
+		}
+
+		for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), data += sizeof(uint64_t))
+		{
+			crc = __crc32cd(crc, load64(data));
+		}
+
+		while (size--)
+		{
+			crc = __crc32cb(crc, *data++);
+		}
+
+		return crc;
+	}
+
+	static Crc32cFunction selectImplementation(std::string_view& name)
+	{
+#ifdef _MSC_VER
+		bool hasCrc = IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE);
+#elif defined(__linux__)
+		bool hasCrc = getauxval(AT_HWCAP) & HWCAP_CRC32;
+#elif defined(__APPLE__)
+		bool hasCrc = true;
+#else
+		bool hasCrc = false;
+#endif
+
+		if (hasCrc)
+		{
+			name = "armv8";
+
+			return armv8;
+		}
+
+		name = "software";
+
+		return software;
+	}
+#else
+	static Crc32cFunction selectImplementation(std::string_view& name)
+	{
+		name = "software";
+
+		return software;
+	}
+#endif
+
+	struct Crc32cImplementation
+	{
+		std::string_view name;
+		Crc32cFunction function;
+
+		Crc32cImplementation() :
+			function(selectImplementation(name))
+		{
+
+		}
+	};
+
+	static const Crc32cImplementation& getImplementation()
+	{
+		static const Crc32cImplementation implementation;
+
+		return implementation;
+	}
+
+	uint32_t crc32c(const void* data, size_t size, uint32_t crc) noexcept
+	{
+		return ~getImplementation().function(static_cast<const uint8_t*>(data), size, ~crc);
+	}
+
+	uint32_t crc32cSoftware(const void* data, size_t size, uint32_t crc) noexcept
+	{
+		return ~software(static_cast<const uint8_t*>(data), size, ~crc);
+	}
+
+	std::string_view getCrc32cImplementation() noexcept
+	{
+		return getImplementation().name;
+	}
+}
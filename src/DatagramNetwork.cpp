@@ -0,0 +1,512 @@
+#include "DatagramNetwork.h"
+
+#include <algorithm>
+
+#ifdef __LINUX__
+#include <netinet/udp.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif // !SOL_UDP
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif // !UDP_SEGMENT
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif // !UDP_GRO
+#endif // __LINUX__
+
+namespace web
+{
+#ifdef __LINUX__
+	/// @brief Kernel limit of segments in one UDP_SEGMENT send
+	static constexpr size_t maxSegments = 64;
+
+	static std::chrono::system_clock::time_point toTimePoint(const timespec& time)
+	{
+		return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec)));
+	}
+#endif // __LINUX__
+
+	SOCKET DatagramNetwork::createSocket(std::string_view ip, std::string_view port)
+	{
+		SOCKET result = INVALID_SOCKET;
+
+#ifndef __LINUX__
+		WSADATA wsaData;
+
+		if (WSAStartup(MAKEWORD(2, 2), &wsaData))
+		{
+			THROW_WEB_EXCEPTION;
+		}
+#endif // !__LINUX__
+
+		addrinfo* info = nullptr;
+		addrinfo hints = {};
+
+		hints.ai_family = AF_INET;
+		hints.ai_socktype = SOCK_DGRAM;
+		hints.ai_protocol = IPPROTO_UDP;
+
+		if (getaddrinfo(ip.data(), port.data(), &hints, &info))
+		{
+			THROW_WEB_EXCEPTION;
+		}
+
+		if (result = socket(info->ai_family, info->ai_socktype, info->ai_protocol); result == INVALID_SOCKET)
+		{
+			freeaddrinfo(info);
+
+			THROW_WEB_EXCEPTION;
+		}
+
+		if (connect(result, info->ai_addr, static_cast<int>(info->ai_addrlen)) == SOCKET_ERROR)
+		{
+			exceptions::WebException exception(__LINE__, __FILE__);
+
+			freeaddrinfo(info);
+
+			closesocket(result);
+
+			throw exception;
+		}
+
+		freeaddrinfo(info);
+
+		return result;
+	}
+
+	int DatagramNetwork::receiveDatagramsImplementation(size_t maxDatagrams, int flags)
+	{
+		maxDatagrams = std::clamp<size_t>(maxDatagrams, 1, maxReceiveSlots);
+
+		if (receiveBuffer.size() < maxDatagrams * maxDatagramSize)
+		{
+			receiveBuffer.resize(maxDatagrams * maxDatagramSize);
+		}
+
+#ifdef __LINUX__
+		constexpr size_t offloadControlSize = CMSG_SPACE(sizeof(int));
+		constexpr size_t timestampControlSize = CMSG_SPACE(sizeof(scm_timestamping));
+
+		size_t controlSize = (receiveOffload ? offloadControlSize : 0) + (timestamping ? timestampControlSize : 0);
+		std::vector<mmsghdr> messages(maxDatagrams);
+		std::vector<iovec> chunks(maxDatagrams);
+		std::vector<char> control(maxDatagrams * controlSize);
+
+		for (size_t i = 0; i < maxDatagrams; i++)
+		{
+			msghdr& header = messages[i].msg_hdr;
+
+			chunks[i].iov_base = receiveBuffer.data() + i * maxDatagramSize;
+			chunks[i].iov_len = maxDatagramSize;
+
+			header.msg_iov = &chunks[i];
+			header.msg_iovlen = 1;
+
+			if (controlSize)
+			{
+				header.msg_control = control.data() + i * controlSize;
+				header.msg_controllen = controlSize;
+			}
+		}
+
+		int received = recvmmsg(this->getClientSocket(), messages.data(), static_cast<unsigned int>(maxDatagrams), flags | MSG_WAITFORONE, nullptr);
+
+		if (received == SOCKET_ERROR)
+		{
+			if (statistics)
+			{
+				statistics->recordReceive(SOCKET_ERROR, flags);
+			}
+
+			return SOCKET_ERROR;
+		}
+
+		int receivedBytes = 0;
+
+		for (int i = 0; i < received; i++)
+		{
+			msghdr& header = messages[i].msg_hdr;
+			const char* datagram = static_cast<const char*>(chunks[i].iov_base);
+			size_t size = messages[i].msg_len;
+			size_t segment = size;
+			std::optional<std::chrono::system_clock::time_point> kernel;
+
+			receivedBytes += static_cast<int>(size);
+
+			for (cmsghdr* message = CMSG_FIRSTHDR(&header); message; message = CMSG_NXTHDR(&header, message))
+			{
+				if (message->cmsg_level == SOL_UDP && message->cmsg_type == UDP_GRO)
+				{
+					int coalescedSize = 0;
+
+					std::copy_n(reinterpret_cast<const char*>(CMSG_DATA(message)), sizeof(coalescedSize), reinterpret_cast<char*>(&coalescedSize));
+
+					if (coalescedSize > 0)
+					{
+						segment = static_cast<size_t>(coalescedSize);
+					}
+				}
+				else if (message->cmsg_level == SOL_SOCKET && message->cmsg_type == SCM_TIMESTAMPING)
+				{
+					scm_timestamping timestamps;
+
+					std::copy_n(reinterpret_cast<const char*>(CMSG_DATA(message)), sizeof(timestamps), reinterpret_cast<char*>(&timestamps));
+
+					kernel = toTimePoint(timestamps.ts[0]);
+				}
+			}
+
+			if (!size)
+			{
+				pendingDatagrams.push({ std::string_view(datagram, 0), kernel });
+
+				continue;
+			}
+
+			for (size_t offset = 0; offset < size; offset += segment)
+			{
+				pendingDatagrams.push({ std::string_view(datagram + offset, std::min(segment, size - offset)), kernel });
+			}
+		}
+
+		if (statistics)
+		{
+			statistics->recordReceive(receivedBytes, flags);
+		}
+
+		return static_cast<int>(pendingDatagrams.size());
+#else
+		int received = this->receiveBytesImplementation(receiveBuffer.data(), static_cast<int>(maxDatagramSize), flags);
+
+		if (statistics)
+		{
+			statistics->recordReceive(received, flags);
+		}
+
+		if (received == SOCKET_ERROR)
+		{
+			return SOCKET_ERROR;
+		}
+
+		pendingDatagrams.push({ std::string_view(receiveBuffer.data(), static_cast<size_t>(received)), std::nullopt });
+
+		return 1;
+#endif // __LINUX__
+	}
+
+	std::string_view DatagramNetwork::receiveDatagram(int flags)
+	{
+		utility::NetworkStatistics::clock::time_point start = statistics ? utility::NetworkStatistics::clock::now() : utility::NetworkStatistics::clock::time_point();
+
+		if (pendingDatagrams.empty() && this->receiveDatagramsImplementation(1, flags) == SOCKET_ERROR)
+		{
+			this->throwException(__LINE__, __FILE__);
+		}
+
+		PendingDatagram datagram = pendingDatagrams.front();
+
+		pendingDatagrams.pop();
+
+		if (timestamping)
+		{
+			timestamping->lastReceive = utility::ReceiveTimestamps{ datagram.kernel, std::chrono::system_clock::now() };
+		}
+
+		if (statistics)
+		{
+			statistics->recordReceiveLatency(start);
+		}
+
+		return datagram.data;
+	}
+
+	bool DatagramNetwork::isStreamOriented() const noexcept
+	{
+		return false;
+	}
+
+	bool DatagramNetwork::hasPendingInput() const noexcept
+	{
+		return !pendingDatagrams.empty() || Network::hasPendingInput();
+	}
+
+	void DatagramNetwork::setSegmentationOffload(uint16_t segmentSize)
+	{
+#ifdef __LINUX__
+		// Only probe support here. Socket wide UDP_SEGMENT would split every send larger than segmentSize, so it is set per message in sendDatagrams
+		if (segmentSize)
+		{
+			int value = segmentSize;
+
+			if (setsockopt(this->getClientSocket(), SOL_UDP, UDP_SEGMENT, &value, sizeof(value)) == SOCKET_ERROR)
+			{
+				THROW_WEB_EXCEPTION;
+			}
+
+			value = 0;
+
+			if (setsockopt(this->getClientSocket(), SOL_UDP, UDP_SEGMENT, &value, sizeof(value)) == SOCKET_ERROR)
+			{
+				THROW_WEB_EXCEPTION;
+			}
+		}
+
+		this->segmentSize = segmentSize;
+#else
+		if (segmentSize)
+		{
+			WSASetLastError(WSAEOPNOTSUPP);
+
+			THROW_WEB_EXCEPTION;
+		}
+#endif // __LINUX__
+	}
+
+	void DatagramNetwork::setReceiveOffload(bool enable)
+	{
+#ifdef __LINUX__
+		int value = enable;
+
+		if (setsockopt(this->getClientSocket(), SOL_UDP, UDP_GRO, &value, sizeof(value)) == SOCKET_ERROR)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+
+		receiveOffload = enable;
+#else
+		if (enable)
+		{
+			WSASetLastError(WSAEOPNOTSUPP);
+
+			THROW_WEB_EXCEPTION;
+		}
+#endif // __LINUX__
+	}
+
+	uint16_t DatagramNetwork::getSegmentationOffload() const noexcept
+	{
+		return segmentSize;
+	}
+
+	bool DatagramNetwork::getReceiveOffload() const noexcept
+	{
+		return receiveOffload;
+	}
+
+	int DatagramNetwork::sendData(const utility::ContainerWrapper& data, bool& endOfStream, int flags)
+	{
+		return this->sendRawData(data.data(), static_cast<int>(data.size()), endOfStream, flags);
+	}
+
+	int DatagramNetwork::sendRawData(const char* data, int size, bool& endOfStream, int flags)
+	{
+		auto sendFunction = [&]() -> int
+			{
+				int result = this->sendBytes(data, size, endOfStream, flags);
+
+				endOfStream = false;
+
+				return result;
+			};
+
+		return utility::NetworkObserver::isAnyInstalled() ?
+			this->observe(utility::NetworkOperation::sendData, size, endOfStream, sendFunction) :
+			sendFunction();
+	}
+
+	int DatagramNetwork::receiveData(utility::ContainerWrapper& data, bool& endOfStream, int flags)
+	{
+		auto receiveFunction = [&]() -> int
+			{
+				std::string_view datagram = this->receiveDatagram(flags);
+
+				endOfStream = false;
+
+				data.resizeAndOverwrite
+				(
+					datagram.size(),
+					[datagram](char* buffer) -> size_t
+					{
+						std::copy(datagram.begin(), datagram.end(), buffer);
+
+						return datagram.size();
+					}
+				);
+
+				return static_cast<int>(datagram.size());
+			};
+
+		return utility::NetworkObserver::isAnyInstalled() ?
+			this->observe(utility::NetworkOperation::receiveData, static_cast<int>(data.size()), endOfStream, receiveFunction) :
+			receiveFunction();
+	}
+
+	int DatagramNetwork::receiveRawData(char* data, int size, bool& endOfStream, int flags)
+	{
+		auto receiveFunction = [&]() -> int
+			{
+				std::string_view datagram = this->receiveDatagram(flags);
+				size_t copySize = std::min<size_t>(datagram.size(), static_cast<size_t>(size));
+
+				endOfStream = false;
+
+				std::copy_n(datagram.data(), copySize, data);
+
+				return static_cast<int>(copySize);
+			};
+
+		return utility::NetworkObserver::isAnyInstalled() ?
+			this->observe(utility::NetworkOperation::receiveData, size, endOfStream, receiveFunction) :
+			receiveFunction();
+	}
+
+	int DatagramNetwork::sendDatagrams(std::span<const std::string_view> datagrams, int flags)
+	{
+#ifdef __LINUX__
+		std::vector<iovec> chunks(datagrams.size());
+		std::vector<mmsghdr> messages;
+		std::vector<char> control(segmentSize ? datagrams.size() * CMSG_SPACE(sizeof(uint16_t)) : 0);
+		size_t index = 0;
+		int sentDatagrams = 0;
+
+		messages.reserve(datagrams.size());
+
+		for (size_t i = 0; i < datagrams.size(); i++)
+		{
+			chunks[i].iov_base = const_cast<char*>(datagrams[i].data());
+			chunks[i].iov_len = datagrams[i].size();
+		}
+
+		// With segmentation offload consecutive datagrams of segmentSize(last one may be shorter) are coalesced into one message
+		while (index < datagrams.size())
+		{
+			mmsghdr message = {};
+			size_t count = 1;
+
+			if (segmentSize && datagrams[index].size() == segmentSize)
+			{
+				size_t totalSize = segmentSize;
+
+				while (index + count < datagrams.size() && count < maxSegments)
+				{
+					size_t nextSize = datagrams[index + count].size();
+
+					if (!nextSize || nextSize > segmentSize || totalSize + nextSize > maxDatagramSize)
+					{
+						break;
+					}
+
+					totalSize += nextSize;
+					count++;
+
+					if (nextSize != segmentSize)
+					{
+						break;
+					}
+				}
+			}
+
+			message.msg_hdr.msg_iov = &chunks[index];
+			message.msg_hdr.msg_iovlen = count;
+			message.msg_len = static_cast<unsigned int>(count);
+
+			if (count > 1)
+			{
+				message.msg_hdr.msg_control = control.data() + messages.size() * CMSG_SPACE(sizeof(uint16_t));
+				message.msg_hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+
+				cmsghdr* segmentMessage = CMSG_FIRSTHDR(&message.msg_hdr);
+
+				segmentMessage->cmsg_level = SOL_UDP;
+				segmentMessage->cmsg_type = UDP_SEGMENT;
+				segmentMessage->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+
+				std::copy_n(reinterpret_cast<const char*>(&segmentSize), sizeof(segmentSize), reinterpret_cast<char*>(CMSG_DATA(segmentMessage)));
+			}
+
+			messages.push_back(message);
+
+			index += count;
+		}
+
+		for (size_t offset = 0; offset < messages.size();)
+		{
+			unsigned int batchSize = static_cast<unsigned int>(std::min(messages.size() - offset, maxBatchSize));
+			std::vector<unsigned int> segmentsInMessage(batchSize);
+
+			// msg_len is used as segments counter until sendmmsg overwrites it with number of sent bytes
+			for (unsigned int i = 0; i < batchSize; i++)
+			{
+				segmentsInMessage[i] = messages[offset + i].msg_len;
+			}
+
+			int sent = sendmmsg(this->getClientSocket(), messages.data() + offset, batchSize, flags);
+
+			if (sent == SOCKET_ERROR)
+			{
+				if (sentDatagrams)
+				{
+					return sentDatagrams;
+				}
+
+				this->throwException(__LINE__, __FILE__);
+			}
+
+			for (int i = 0; i < sent; i++)
+			{
+				sentDatagrams += segmentsInMessage[i];
+			}
+
+			offset += sent;
+		}
+
+		return sentDatagrams;
+#else
+		int sentDatagrams = 0;
+
+		for (std::string_view datagram : datagrams)
+		{
+			if (this->sendBytesImplementation(datagram.data(), static_cast<int>(datagram.size()), flags) == SOCKET_ERROR)
+			{
+				if (sentDatagrams)
+				{
+					return sentDatagrams;
+				}
+
+				this->throwException(__LINE__, __FILE__);
+			}
+
+			sentDatagrams++;
+		}
+
+		return sentDatagrams;
+#endif // __LINUX__
+	}
+
+	int DatagramNetwork::receiveDatagrams(std::vector<std::string>& datagrams, size_t maxDatagrams, int flags)
+	{
+		if (pendingDatagrams.empty() && this->receiveDatagramsImplementation(maxDatagrams, flags) == SOCKET_ERROR)
+		{
+			this->throwException(__LINE__, __FILE__);
+		}
+
+		size_t count = std::min(maxDatagrams, pendingDatagrams.size());
+
+		datagrams.resize(count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			datagrams[i].assign(pendingDatagrams.front().data);
+
+			pendingDatagrams.pop();
+		}
+
+		return static_cast<int>(count);
+	}
+}
@@ -13,6 +13,22 @@ namespace buffers
 		return gptr() ? egptr() - gptr() : 0;
 	}
 
+	void IOSocketBuffer::prepareBuffer()
+	{
+		this->reclaimBuffer();
+
+		// Allocate buffer on first receive, so empty frame still has valid data pointer
+		inputData.resize(1);
+	}
+
+	void IOSocketBuffer::updateHighWater()
+	{
+		if (reclaimSize && static_cast<size_t>(lastPacketSize) > reclaimSize)
+		{
+			highWaterTime = std::chrono::steady_clock::now();
+		}
+	}
+
 	typename IOSocketBuffer::int_type IOSocketBuffer::overflow(int_type ch)
 	{
 		char character = ch;
@@ -29,15 +45,20 @@ namespace buffers
 
 	typename IOSocketBuffer::int_type IOSocketBuffer::underflow()
 	{
-		web::utility::ContainerWrapper container(inputData);
-
 		if (gptr())
 		{
 			setg(nullptr, nullptr, nullptr);
 
+			// Frame is consumed
+			this->reclaimBuffer();
+
 			return traits_type::eof();
 		}
 
+		this->prepareBuffer();
+
+		web::utility::ContainerWrapper container(inputData);
+
 		lastPacketSize = network->receiveData(container, endOfStream);
 
 		if (endOfStream)
@@ -45,6 +66,13 @@ namespace buffers
 			return traits_type::eof();
 		}
 
+		this->updateHighWater();
+
+		// Get area ends with terminating zero after frame like std::string data, pooled region isn't zero filled
+		inputData.resize(static_cast<size_t>(lastPacketSize) + 1);
+
+		inputData[lastPacketSize] = '\0';
+
 		setg(inputData.data(), inputData.data(), inputData.data() + static_cast<size_t>(lastPacketSize) + 1);
 
 		return *gptr();
@@ -70,9 +98,13 @@ namespace buffers
 	{
 		if (size_t bufferSize = this->getAvailableInputSize(); bufferSize)
 		{
-			network->addReceiveBuffer(inputData.data() + bufferSize);
+			// Unread part of frame without terminating zero is received again by network, so whole get area is consumed
+			if (bufferSize > 1)
+			{
+				network->addReceiveBuffer(std::string_view(gptr(), bufferSize - 1));
+			}
 
-			gbump(std::min<int>(static_cast<int>(bufferSize), static_cast<int>(size)));
+			gbump(static_cast<int>(bufferSize));
 		}
 
 		if (size == (std::numeric_limits<std::streamsize>::max)())
@@ -86,18 +118,97 @@ namespace buffers
 			lastPacketSize = network->receiveRawData(s, static_cast<int>(size), endOfStream);
 		}
 
-		return endOfStream ? traits_type::eof() : lastPacketSize;
+		if (endOfStream)
+		{
+			return traits_type::eof();
+		}
+
+		// Get area was consumed above
+		this->reclaimBuffer();
+
+		return lastPacketSize;
 	}
 
-	IOSocketBuffer::IOSocketBuffer(std::unique_ptr<web::Network>&& networkSubclass) :
-		network(std::move(networkSubclass)),
+	void NetworkDeleter::operator ()(web::Network* network) const noexcept
+	{
+		if (owning)
+		{
+			delete network;
+		}
+	}
+
+	IOSocketBuffer::IOSocketBuffer(NetworkPointer&& network) :
+		network(std::move(network)),
 		lastPacketSize(0),
 		endOfStream(false)
 	{
 
 	}
 
-	const std::unique_ptr<web::Network>& IOSocketBuffer::getNetwork() const noexcept
+	IOSocketBuffer::IOSocketBuffer(std::unique_ptr<web::Network>&& networkSubclass) :
+		IOSocketBuffer(NetworkPointer(networkSubclass.release()))
+	{
+
+	}
+
+	std::string_view IOSocketBuffer::receiveView()
+	{
+		setg(nullptr, nullptr, nullptr);
+
+		this->prepareBuffer();
+
+		web::utility::ContainerWrapper container(inputData);
+
+		lastPacketSize = network->receiveData(container, endOfStream);
+
+		if (endOfStream)
+		{
+			return std::string_view();
+		}
+
+		this->updateHighWater();
+
+		return std::string_view(inputData.data(), static_cast<size_t>(lastPacketSize));
+	}
+
+	bool IOSocketBuffer::releaseBuffer()
+	{
+		setg(nullptr, nullptr, nullptr);
+
+		return inputData.shrink(0);
+	}
+
+	bool IOSocketBuffer::reclaimBuffer()
+	{
+		// Unread characters of frame are in buffer or referenced by receive buffers of network
+		if (!reclaimSize || inputData.size() <= reclaimSize || this->getAvailableInputSize() || network->hasPendingInput() ||
+			std::chrono::steady_clock::now() - highWaterTime < reclaimPeriod)
+		{
+			return false;
+		}
+
+		bool frameEnded = gptr();
+
+		if (!inputData.shrink(reclaimSize))
+		{
+			return false;
+		}
+
+		// Consumed frame still ends with eof on next underflow
+		if (frameEnded)
+		{
+			setg(inputData.data(), inputData.data(), inputData.data());
+		}
+
+		return true;
+	}
+
+	size_t IOSocketBuffer::getBufferSize() const noexcept
+	{
+		return inputData.size();
+	}
+
+	const IOSocketBuffer::NetworkPointer& IOSocketBuffer::getNetwork() const noexcept
 	{
 		return network;
 	}
@@ -12,23 +12,141 @@ namespace streams
 		return buffer->getNetwork()->receiveBytes(value, valueSize, endOfStream);
 	}
 
+	int IOSocketStream::sendVarint(uint64_t value, bool& endOfStream)
+	{
+		char encoded[web::utility::maxVarint64Size];
+
+		return this->sendFundamentalImplementation(encoded, static_cast<int>(web::utility::encodeVarint(value, encoded)), endOfStream);
+	}
+
+	int IOSocketStream::receiveVarint(uint64_t& value, bool& endOfStream)
+	{
+		char encoded[web::utility::maxVarint64Size];
+		int size = 0;
+
+		// Bytes after last one belong to next value, so value is read byte by byte
+		do
+		{
+			if (size == static_cast<int>(web::utility::maxVarint64Size))
+			{
+				throw web::exceptions::WebException(EBADMSG, "Varint is longer than maxVarint64Size", __LINE__, __FILE__);
+			}
+
+			int lastPacketSize = this->receiveFundamentalImplementation(encoded + size, 1, endOfStream);
+
+			if (endOfStream)
+			{
+				return lastPacketSize;
+			}
+
+			size += lastPacketSize;
+		} while (encoded[size - 1] & 0x80);
+
+		web::utility::decodeVarint(encoded, static_cast<size_t>(size), value);
+
+		return size;
+	}
+
+	int IOSocketStream::tryReceiveVarint(uint64_t& value, bool& endOfStream, web::NetworkError& error)
+	{
+		web::Network& network = *buffer->getNetwork();
+		char encoded[web::utility::maxVarint64Size];
+		int size = 0;
+
+		do
+		{
+			if (size == static_cast<int>(web::utility::maxVarint64Size))
+			{
+				error = { EBADMSG, __LINE__, __FILE__, "Varint is longer than maxVarint64Size" };
+
+				return SOCKET_ERROR;
+			}
+
+			int lastPacketSize = network.tryReceiveBytes(encoded + size, 1, endOfStream, error);
+
+			if (lastPacketSize == SOCKET_ERROR)
+			{
+				// Next call starts from first byte of value
+				network.restoreReceivedBytes(std::string_view(encoded, size));
+
+				return SOCKET_ERROR;
+			}
+
+			if (endOfStream)
+			{
+				return lastPacketSize;
+			}
+
+			size += lastPacketSize;
+		} while (encoded[size - 1] & 0x80);
+
+		web::utility::decodeVarint(encoded, static_cast<size_t>(size), value);
+
+		return size;
+	}
+
+	std::ostream& IOSocketStream::sendContainer(const web::utility::ContainerWrapper& container)
+	{
+		constexpr std::streamsize size = (std::numeric_limits<std::streamsize>::max)();
+
+		try
+		{
+			if (buffer->sputn(reinterpret_cast<const char*>(&container), size) == buffers::IOSocketBuffer::traits_type::eof())
+			{
+				setstate(std::ios_base::eofbit);
+			}
+		}
+		catch (const web::exceptions::WebException&)
+		{
+			setstate(std::ios_base::failbit);
+
+			throw;
+		}
+
+		return *this;
+	}
+
+	std::istream& IOSocketStream::receiveContainer(web::utility::ContainerWrapper& container)
+	{
+		constexpr std::streamsize size = (std::numeric_limits<std::streamsize>::max)();
+
+		try
+		{
+			if (buffer->sgetn(reinterpret_cast<char*>(&container), size) == buffers::IOSocketBuffer::traits_type::eof())
+			{
+				setstate(std::ios_base::eofbit);
+			}
+		}
+		catch (const web::exceptions::WebException&)
+		{
+			setstate(std::ios_base::failbit);
+
+			throw;
+		}
+
+		return *this;
+	}
+
 	IOSocketStream::IOSocketStream(std::unique_ptr<buffers::IOSocketBuffer>&& buffer) :
 		std::iostream(nullptr),
-		buffer(std::move(buffer))
+		buffer(std::move(buffer)),
+		integerEncoding(IntegerEncoding::fixed)
 	{
 		std::iostream::rdbuf(this->buffer.get());
 	}
 
 	IOSocketStream::IOSocketStream(std::unique_ptr<web::Network>&& network) :
 		std::iostream(nullptr),
-		buffer(std::make_unique<buffers::IOSocketBuffer>(std::move(network)))
+		buffer(std::make_unique<buffers::IOSocketBuffer>(std::move(network))),
+		integerEncoding(IntegerEncoding::fixed)
 	{
 		std::iostream::rdbuf(buffer.get());
 	}
 
 	IOSocketStream::IOSocketStream(IOSocketStream&& other) noexcept :
 		std::iostream(nullptr),
-		buffer(std::move(other.buffer))
+		buffer(std::move(other.buffer)),
+		integerEncoding(other.integerEncoding)
 	{
 		std::iostream::rdbuf(buffer.get());
 
@@ -38,6 +156,7 @@ namespace streams
 	IOSocketStream& IOSocketStream::operator = (IOSocketStream&& other) noexcept
 	{
 		buffer = std::move(other.buffer);
+		integerEncoding = other.integerEncoding;
 
 		std::iostream::rdbuf(buffer.get());
 
@@ -46,6 +165,62 @@ namespace streams
 		return *this;
 	}
 
+	void IOSocketStream::setIntegerEncoding(IntegerEncoding encoding) noexcept
+	{
+		integerEncoding = encoding;
+	}
+
+	IntegerEncoding IOSocketStream::getIntegerEncoding() const noexcept
+	{
+		return integerEncoding;
+	}
+
+	std::string_view IOSocketStream::receiveView()
+	{
+		try
+		{
+			std::string_view result = buffer->receiveView();
+
+			if (buffer->getEndOfStream())
+			{
+				setstate(std::ios_base::eofbit);
+			}
+
+			return result;
+		}
+		catch (const web::exceptions::WebException&)
+		{
+			setstate(std::ios_base::failbit);
+
+			throw;
+		}
+	}
+
+	bool IOSocketStream::releaseBuffer()
+	{
+		return buffer->releaseBuffer();
+	}
+
+	bool IOSocketStream::reclaimBuffer()
+	{
+		return buffer->reclaimBuffer();
+	}
+
+	size_t IOSocketStream::getBufferSize() const noexcept
+	{
+		return buffer->getBufferSize();
+	}
+
+	web::utility::NetworkStatisticsSnapshot IOSocketStream::getStatistics() const
+	{
+		return this->getNetwork().getStatistics();
+	}
+
+	web::utility::TcpInfo IOSocketStream::getTcpInfo() const
+	{
+		return this->getNetwork().getTcpInfo();
+	}
+
 	std::ostream& IOSocketStream::operator << (bool value)
 	{
 		this->sendFundamental(value);
@@ -1,252 +1,1894 @@
 #include "Network.h"
 
+#include <cerrno>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <typeinfo>
+
+#ifdef __LINUX__
+#include <netinet/tcp.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
+#include <linux/sockios.h>
+
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif // !SO_PREFER_BUSY_POLL
+#else
+#include <mstcpip.h>
+#endif
+
 namespace web
 {
-	int Network::sendBytesImplementation(const char* data, int size, int flags)
+#ifdef __LINUX__
+	/// @brief struct tcp_info layout from linux/tcp.h. glibc netinet/tcp.h lacks newer fields, older kernels fill only known prefix
+	struct KernelTcpInfo
 	{
-		return send(this->getClientSocket(), data, size, flags);
-	}
+		uint8_t state;
+		uint8_t congestionState;
+		uint8_t retransmits;
+		uint8_t probes;
+		uint8_t backoff;
+		uint8_t options;
+		uint8_t windowScale;
+		uint8_t flags;
 
-	int Network::receiveBytesImplementation(char* data, int size, int flags)
-	{
-		return recv(this->getClientSocket(), data, size, flags);
-	}
+		uint32_t rto;
+		uint32_t ato;
+		uint32_t sendMss;
+		uint32_t receiveMss;
 
-	void Network::throwException(int line, std::string_view file) const
+		uint32_t unacked;
+		uint32_t sacked;
+		uint32_t lost;
+		uint32_t retransmitting;
+		uint32_t fackets;
+
+		uint32_t lastDataSent;
+		uint32_t lastAckSent;
+		uint32_t lastDataReceived;
+		uint32_t lastAckReceived;
+
+		uint32_t pmtu;
+		uint32_t receiveSlowStartThreshold;
+		uint32_t rtt;
+		uint32_t rttVariance;
+		uint32_t sendSlowStartThreshold;
+		uint32_t sendCongestionWindow;
+		uint32_t advertisedMss;
+		uint32_t reordering;
+
+		uint32_t receiveRtt;
+		uint32_t receiveSpace;
+
+		uint32_t totalRetransmits;
+
+		uint64_t pacingRate;
+		uint64_t maxPacingRate;
+		uint64_t bytesAcked;
+		uint64_t bytesReceived;
+		uint32_t segmentsOut;
+		uint32_t segmentsIn;
+
+		uint32_t notSentBytes;
+		uint32_t minRtt;
+		uint32_t dataSegmentsIn;
+		uint32_t dataSegmentsOut;
+
+		uint64_t deliveryRate;
+
+		uint64_t busyTime;
+		uint64_t receiveWindowLimited;
+		uint64_t sendBufferLimited;
+
+		uint32_t delivered;
+		uint32_t deliveredCe;
+
+		uint64_t bytesSent;
+		uint64_t bytesRetransmitted;
+	};
+
+	static std::chrono::system_clock::time_point toTimePoint(const timespec& time)
 	{
-		throw exceptions::WebException(line, file);
+		return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec)));
 	}
 
-	void Network::setTimeout(int64_t timeout)
+	static int receiveWithTimestamp(SOCKET socket, utility::TimestampingState& timestamping, char* data, int size, int flags)
 	{
-#ifdef __LINUX__
-		timeval timeoutValue;
+		char control[CMSG_SPACE(sizeof(scm_timestamping))];
+		iovec chunk = { data, static_cast<size_t>(size) };
+		msghdr message = {};
 
-		timeoutValue.tv_sec = timeout / 1000;
-		timeoutValue.tv_usec = (timeout - timeoutValue.tv_sec * 1000) * 1000;
-#else
-		DWORD timeoutValue = static_cast<DWORD>(timeout);
-#endif
+		message.msg_iov = &chunk;
+		message.msg_iovlen = 1;
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
 
-		if (setsockopt(this->getClientSocket(), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeoutValue), sizeof(timeoutValue)) == SOCKET_ERROR)
-		{
-			THROW_WEB_EXCEPTION;
-		}
+		int result = static_cast<int>(recvmsg(socket, &message, flags));
 
-		if (setsockopt(this->getClientSocket(), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeoutValue), sizeof(timeoutValue)) == SOCKET_ERROR)
+		if (result > 0)
 		{
-			THROW_WEB_EXCEPTION;
+			for (cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header))
+			{
+				if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_TIMESTAMPING)
+				{
+					scm_timestamping timestamps;
+
+					std::copy_n(reinterpret_cast<const char*>(CMSG_DATA(header)), sizeof(timestamps), reinterpret_cast<char*>(&timestamps));
+
+					timestamping.frameKernelTimestamp = toTimePoint(timestamps.ts[0]);
+				}
+			}
 		}
+
+		return result;
 	}
+#endif
 
-	Network::Network(std::string_view ip, std::string_view port, int64_t timeout)
+	static void addSendTimestamps(utility::TimestampingState& timestamping, std::chrono::system_clock::time_point user, int size)
 	{
-		SOCKET tempSocket = INVALID_SOCKET;
+		utility::SendTimestamps frame = {};
 
-#ifndef __LINUX__
-		WSADATA wsaData;
+		frame.id = timestamping.sentBytes - 1;
+		frame.size = size;
+		frame.user = user;
 
-		if (WSAStartup(MAKEWORD(2, 2), &wsaData))
+		if (timestamping.pendingFrames.size() == utility::TimestampingState::maxPendingFrames)
 		{
-			THROW_WEB_EXCEPTION;
+			timestamping.pendingFrames.pop_front();
 		}
-#endif // !__LINUX__
 
-		addrinfo* info = nullptr;
-		addrinfo hints = {};
+		timestamping.pendingFrames.push_back(frame);
+	}
 
-		hints.ai_family = AF_INET;
-		hints.ai_socktype = SOCK_STREAM;
-		hints.ai_protocol = IPPROTO_TCP;
+	static void setReceiveTimestamps(utility::TimestampingState& timestamping)
+	{
+		timestamping.lastReceive = utility::ReceiveTimestamps{ timestamping.frameKernelTimestamp, std::chrono::system_clock::now() };
+	}
 
-		if (getaddrinfo(ip.data(), port.data(), &hints, &info))
+	/// @brief Size header in frame checksum mode
+	struct ChecksumFrameHeader
+	{
+		int size;
+		uint32_t checksum;
+		/// @brief Checksum of size and checksum
+		uint32_t headerChecksum;
+	};
+
+	/// @brief Sent by negotiateFrameHeader before preferred format
+	static constexpr char frameHeaderNegotiationMagic[] = { 'S', 'S', 'F', 'H' };
+
+	/**
+	 * @brief First format in this order that either side prefers is negotiated
+	 * large is preferred only by side that needs frames over 2 GiB, so it wins. fixed side may not support varint
+	 */
+	static constexpr FrameHeader frameHeaderNegotiationOrder[] = { FrameHeader::large, FrameHeader::fixed, FrameHeader::varint };
+
+	/// @brief Maximum buffers passed to one recvmsg/WSARecv call
+	static constexpr size_t maxScatterBuffers = 16;
+
+	static constexpr size_t maxFrameHeaderSize = (std::max)({ sizeof(int64_t), sizeof(ChecksumFrameHeader), utility::maxVarint32Size });
+
+	/// @brief Set error that doesn't come from errno/WSAGetLastError
+	/// @return SOCKET_ERROR
+	static int setFrameError(NetworkError& error, int errorCode, std::string_view description, int line, std::string_view file) noexcept
+	{
+		error = { errorCode, line, file, description };
+
+		return SOCKET_ERROR;
+	}
+
+	static void checkFrameChecksum(uint32_t checksum, uint32_t expected)
+	{
+		if (checksum != expected)
 		{
-			THROW_WEB_EXCEPTION;
+			throw exceptions::WebException(EBADMSG, "Frame checksum mismatch", __LINE__, __FILE__);
 		}
+	}
 
-		if (tempSocket = socket(info->ai_family, info->ai_socktype, info->ai_protocol); tempSocket == INVALID_SOCKET)
+	int Network::receiveFramePayload(char* data, int size, bool& endOfStream, int flags, NetworkError& error)
+	{
+		if (!headerOverflowSize)
 		{
-			freeaddrinfo(info);
-
-			THROW_WEB_EXCEPTION;
+			return this->tryReceiveBytes(data, size, endOfStream, error, flags);
 		}
 
-		if (connect(tempSocket, info->ai_addr, static_cast<int>(info->ai_addrlen)) == SOCKET_ERROR)
+		int fromHeader = (std::min)(headerOverflowSize, size);
+
+		std::copy_n(headerOverflow.data(), fromHeader, data);
+
+		// Bytes that don't fit belong to part of frame that is left unread
+		headerOverflowSize = 0;
+
+		if (fromHeader == size)
 		{
-			freeaddrinfo(info);
+			endOfStream = false;
 
-			THROW_WEB_EXCEPTION;
+			return size;
 		}
 
-		handle = std::shared_ptr<SOCKET>(new SOCKET(tempSocket), [](SOCKET* ptr) { closesocket(*ptr); delete ptr; });
+		int lastPacketSize = this->tryReceiveBytes(data + fromHeader, size - fromHeader, endOfStream, error, flags);
 
-		freeaddrinfo(info);
+		if (lastPacketSize == SOCKET_ERROR)
+		{
+			// Goes before bytes restored by tryReceiveBytes
+			this->restoreReceivedBytes(std::string_view(data, fromHeader));
 
-		this->setTimeout(timeout);
+			return SOCKET_ERROR;
+		}
+
+		return endOfStream ? lastPacketSize : fromHeader + lastPacketSize;
 	}
 
-	bool Network::isDataAvailable(int* availableBytes, bool* hasConnection) const
+	int Network::receiveFrameBuffers(std::span<std::span<char>> buffers, bool& endOfStream, int flags)
 	{
-		SOCKET socket = this->getClientSocket();
+		int total = 0;
 
-		if (hasConnection)
+		endOfStream = false;
+
+		if (headerOverflowSize)
 		{
-			char buffer;
-			int result = this->callInNonBlockingMode
-			(
-				std::bind(&Network::receiveBytesImplementation, const_cast<Network*>(this), &buffer, static_cast<int>(sizeof(buffer)), MSG_PEEK)
-			);
+			int offset = 0;
 
-			if (result > 0)
+			for (std::span<char>& buffer : buffers)
 			{
-				*hasConnection = true;
+				int fromHeader = (std::min)(headerOverflowSize - offset, static_cast<int>(buffer.size()));
+
+				std::copy_n(headerOverflow.data() + offset, fromHeader, buffer.data());
+
+				buffer = buffer.subspan(fromHeader);
+				offset += fromHeader;
 			}
-			else if (result < 0)
+
+			total = offset;
+			headerOverflowSize = 0;
+		}
+
+		// Buffers added with addReceiveBuffer are consumed by receiveBytes
+		if (this->buffers.size())
+		{
+			for (std::span<char> buffer : buffers)
 			{
-#ifdef __LINUX__
-				if (errno == EAGAIN || errno == EWOULDBLOCK)
+				while (buffer.size())
 				{
-					*hasConnection = true;
-				}
-				else
-				{
-					if (availableBytes)
+					int lastPacketSize = this->receiveBytes(buffer.data(), static_cast<int>(buffer.size()), endOfStream, flags);
+
+					if (endOfStream)
 					{
-						*availableBytes = 0;
+						return lastPacketSize;
 					}
 
-					*hasConnection = false;
-
-					return false;
-				}
-#else
-				if (int errorCode = WSAGetLastError(); errorCode == WSAEWOULDBLOCK)
-				{
-					*hasConnection = true;
+					buffer = buffer.subspan(lastPacketSize);
+					total += lastPacketSize;
 				}
-				else
-				{
-					if (availableBytes)
-					{
-						*availableBytes = 0;
-					}
+			}
 
-					*hasConnection = false;
+			return total;
+		}
 
-					return false;
-				}
-#endif
+		size_t index = 0;
+		// Frame size is known, so all buffers are usually filled with one call like in receiveBytes
+		int receiveFlags = busyPollTime.count() || flags & MSG_PEEK ? flags : flags | MSG_WAITALL;
+
+		while (true)
+		{
+			while (index < buffers.size() && buffers[index].empty())
+			{
+				index++;
 			}
-			else
+
+			if (index == buffers.size())
 			{
-				if (availableBytes)
-				{
-					*availableBytes = 0;
-				}
+				break;
+			}
 
-				*hasConnection = false;
+			int lastReceive = this->receiveBuffersImplementation(buffers.subspan(index), receiveFlags);
 
-				return false;
+			if (statistics)
+			{
+				statistics->recordReceive(lastReceive, flags);
 			}
-		}
 
-#ifdef __LINUX__
-		int result = 0;
+			if (lastReceive == SOCKET_ERROR)
+			{
+				this->throwException(__LINE__, __FILE__);
+			}
+			else if (!lastReceive)
+			{
+				endOfStream = true;
 
-		if (ioctl(socket, FIONREAD, &result) < 0)
-		{
-			THROW_WEB_EXCEPTION;
-		}
-#else
-		u_long result = 0;
+				return 0;
+			}
 
-		if (ioctlsocket(socket, FIONREAD, &result) == SOCKET_ERROR)
-		{
-			THROW_WEB_EXCEPTION;
-		}
-#endif
+			total += lastReceive;
 
-		if (availableBytes)
-		{
-			*availableBytes = static_cast<int>(result);
+			for (size_t left = static_cast<size_t>(lastReceive); left;)
+			{
+				size_t step = (std::min)(left, buffers[index].size());
+
+				buffers[index] = buffers[index].subspan(step);
+				left -= step;
+
+				if (buffers[index].empty())
+				{
+					index++;
+				}
+			}
 		}
 
-		return result > 0;
+		return total;
 	}
 
-	int Network::sendData(const utility::ContainerWrapper& data, bool& endOfStream, int flags)
+	int Network::sendBytesImplementation(const char* data, int size, int flags)
 	{
-		int size = static_cast<int>(data.size());
-		int lastPacketSize = this->sendBytes(&size, sizeof(size), endOfStream, flags);
+		int result = send(this->getClientSocket(), data, size, flags);
 
-		if (endOfStream)
+		if (timestamping && result > 0)
 		{
-			return lastPacketSize;
+			timestamping->sentBytes += static_cast<uint32_t>(result);
 		}
 
-		return this->sendBytes(data.data(), size, endOfStream, flags);
+		return result;
 	}
 
-	int Network::sendRawData(const char* data, int size, bool& endOfStream, int flags)
+	int Network::receiveBytesImplementation(char* data, int size, int flags)
 	{
-		int lastPacketSize = this->sendBytes(&size, sizeof(size), endOfStream, flags);
+		auto receiveFunction = [this, data, size](int receiveFlags) -> int
+			{
+#ifdef __LINUX__
+				if (timestamping)
+				{
+					return receiveWithTimestamp(this->getClientSocket(), *timestamping, data, size, receiveFlags);
+				}
+#endif
 
-		if (endOfStream)
+				return recv(this->getClientSocket(), data, size, receiveFlags);
+			};
+
+#ifdef __LINUX__
+		if (busyPollTime.count() && !(flags & (MSG_PEEK | MSG_DONTWAIT)))
+#else
+		if (busyPollTime.count() && !(flags & MSG_PEEK))
+#endif
 		{
-			return lastPacketSize;
+			std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + busyPollTime;
+
+			do
+			{
+#ifdef __LINUX__
+				int result = receiveFunction(flags | MSG_DONTWAIT);
+
+				if (result != SOCKET_ERROR || (errno != EAGAIN && errno != EWOULDBLOCK))
+				{
+					return result;
+				}
+#else
+				int result = this->callInNonBlockingMode(receiveFunction, flags);
+
+				if (result != SOCKET_ERROR || WSAGetLastError() != WSAEWOULDBLOCK)
+				{
+					return result;
+				}
+#endif
+			} while (std::chrono::steady_clock::now() < deadline);
 		}
 
-		return this->sendBytes(data, size, endOfStream, flags);
+		return receiveFunction(flags);
 	}
 
-	int Network::receiveData(utility::ContainerWrapper& data, bool& endOfStream, int flags)
+	int Network::receiveBuffersImplementation(std::span<const std::span<char>> buffers, int flags)
 	{
-		int size = 0;
-		int lastPacketSize = this->receiveBytes(&size, sizeof(size), endOfStream, flags);
-
-		if (endOfStream)
+		// Subclass may override receiveBytesImplementation, timestamps and busy polling are handled there too
+		if (timestamping || busyPollTime.count() || typeid(*this) != typeid(Network))
 		{
-			return lastPacketSize;
+			int total = 0;
+
+			for (std::span<char> buffer : buffers)
+			{
+				int lastReceive = this->receiveBytesImplementation(buffer.data(), static_cast<int>(buffer.size()), flags);
+
+				if (lastReceive <= 0)
+				{
+					return total ? total : lastReceive;
+				}
+
+				total += lastReceive;
+
+				// Peeking next buffer would return same bytes again
+				if (static_cast<size_t>(lastReceive) < buffer.size() || flags & MSG_PEEK)
+				{
+					break;
+				}
+			}
+
+			return total;
 		}
 
-		if (data.size() < size)
+		size_t count = (std::min)(buffers.size(), maxScatterBuffers);
+
+#ifdef __LINUX__
+		std::array<iovec, maxScatterBuffers> vectors;
+		msghdr message = {};
+
+		for (size_t i = 0; i < count; i++)
 		{
-			data.resize(static_cast<size_t>(size));
+			vectors[i].iov_base = buffers[i].data();
+			vectors[i].iov_len = buffers[i].size();
 		}
 
-		return this->receiveBytes(data.data(), size, endOfStream, flags);
-	}
+		message.msg_iov = vectors.data();
+		message.msg_iovlen = count;
 
-	int Network::receiveRawData(char* data, int size, bool& endOfStream, int flags)
-	{
-		int inputSize = 0;
-		int lastPacketSize = this->receiveBytes(&inputSize, sizeof(inputSize), endOfStream, flags);
+		return static_cast<int>(recvmsg(this->getClientSocket(), &message, flags));
+#else
+		std::array<WSABUF, maxScatterBuffers> vectors;
+		DWORD received = 0;
+		DWORD receiveFlags = static_cast<DWORD>(flags);
 
-		if (endOfStream)
+		for (size_t i = 0; i < count; i++)
 		{
-			return lastPacketSize;
+			vectors[i].buf = buffers[i].data();
+			vectors[i].len = static_cast<ULONG>(buffers[i].size());
 		}
 
-		if (size < inputSize)
+		if (WSARecv(this->getClientSocket(), vectors.data(), static_cast<DWORD>(count), &received, &receiveFlags, nullptr, nullptr) == SOCKET_ERROR)
 		{
-			std::cerr << "In " << __FUNCTION__ << " passed size(" << size << ") < actual data size(" << inputSize << ')' << std::endl;
+			return SOCKET_ERROR;
 		}
 
-		return this->receiveBytes(data, size, endOfStream, flags);
+		return static_cast<int>(received);
+#endif
 	}
 
-	void Network::addReceiveBuffer(std::string_view buffer)
+	bool Network::isStreamOriented() const noexcept
 	{
-		buffers.push(buffer);
+		return true;
 	}
 
-	SOCKET Network::getClientSocket() const
+	void Network::throwException(int line, std::string_view file) const
 	{
-		if (handle)
+		throw exceptions::WebException(line, file);
+	}
+
+	void Network::throwException(const NetworkError& error) const
+	{
+		if (error.description.size())
 		{
-			return *handle;
+			throw exceptions::WebException(error.errorCode, error.description, error.line, error.file);
 		}
 
-		return INVALID_SOCKET;
+		error.setLastError();
+
+		this->throwException(error.line, error.file);
+
+		// Overridden throwException must throw
+		throw exceptions::WebException(error.line, error.file);
+	}
+
+	int Network::sendBytesWithoutException(const char* data, int size, bool& endOfStream, int flags, NetworkError& error)
+	{
+		int lastSend = 0;
+		int totalSent = 0;
+		utility::NetworkStatistics::clock::time_point start = statistics ? utility::NetworkStatistics::clock::now() : utility::NetworkStatistics::clock::time_point();
+
+		endOfStream = false;
+
+		do
+		{
+			lastSend = this->sendBytesImplementation(data + totalSent, size - totalSent, flags);
+
+			if (statistics)
+			{
+				statistics->recordSend(lastSend, size - totalSent, flags);
+			}
+
+			if (lastSend == SOCKET_ERROR)
+			{
+				error = NetworkError::fromLastError(__LINE__, __FILE__);
+
+				return SOCKET_ERROR;
+			}
+			else if (!lastSend)
+			{
+				endOfStream = true;
+
+				break;
+			}
+
+			totalSent += lastSend;
+		} while (totalSent < size);
+
+		if (statistics)
+		{
+			statistics->recordSendLatency(start);
+		}
+
+		return totalSent;
+	}
+
+	int Network::receiveBytesWithoutException(char* data, int size, bool& endOfStream, int flags, NetworkError& error)
+	{
+		int receive = 0;
+		char* actualData = data;
+		utility::NetworkStatistics::clock::time_point start = statistics ? utility::NetworkStatistics::clock::now() : utility::NetworkStatistics::clock::time_point();
+
+		while (size && buffers.size())
+		{
+			std::string_view& receiveBuffer = buffers.front();
+			int fromBufferSize = std::min<int>(static_cast<int>(receiveBuffer.size()), size);
+
+			std::copy(receiveBuffer.data(), receiveBuffer.data() + fromBufferSize, actualData);
+
+			receiveBuffer = std::string_view(receiveBuffer.data() + fromBufferSize, receiveBuffer.size() - fromBufferSize);
+
+			actualData += fromBufferSize;
+			receive += fromBufferSize;
+			size -= fromBufferSize;
+
+			if (receiveBuffer.empty())
+			{
+				buffers.pop();
+			}
+		}
+
+		if (size)
+		{
+#ifdef __LINUX__
+			bool exact = this->isStreamOriented() && !(flags & (MSG_PEEK | MSG_DONTWAIT));
+#else
+			bool exact = this->isStreamOriented() && !(flags & MSG_PEEK);
+#endif
+			// MSG_WAITALL usually fills data with one call, loop finishes after signal, timeout or busy polling
+			int receiveFlags = exact && !busyPollTime.count() ? flags | MSG_WAITALL : flags;
+
+			do
+			{
+				int lastReceive = this->receiveBytesImplementation(actualData, size, receiveFlags);
+
+				if (statistics)
+				{
+					statistics->recordReceive(lastReceive, flags);
+				}
+
+				if (lastReceive == SOCKET_ERROR)
+				{
+					error = NetworkError::fromLastError(__LINE__, __FILE__);
+
+					// Timeout in the middle of data doesn't lose already received part, repeated call gets it first
+					this->restoreReceivedBytes(std::string_view(data, receive));
+
+					return SOCKET_ERROR;
+				}
+
+				if (!lastReceive)
+				{
+					// Connection closed in the middle of data, partially received data is lost
+					receive = 0;
+
+					break;
+				}
+
+				actualData += lastReceive;
+				receive += lastReceive;
+				size -= lastReceive;
+			} while (exact && size);
+		}
+
+		endOfStream = !static_cast<bool>(receive);
+
+		if (statistics)
+		{
+			statistics->recordReceiveLatency(start);
+		}
+
+		return receive;
+	}
+
+	int Network::sendFrameWithoutException(const char* data, int size, bool& endOfStream, int flags, NetworkError& error)
+	{
+		std::chrono::system_clock::time_point start = timestamping ? std::chrono::system_clock::now() : std::chrono::system_clock::time_point();
+		int lastPacketSize = this->sendFrameHeader(data, size, endOfStream, flags, error);
+
+		if (lastPacketSize == SOCKET_ERROR || endOfStream)
+		{
+			return lastPacketSize;
+		}
+
+		lastPacketSize = this->trySendBytes(data, size, endOfStream, error, flags);
+
+		if (timestamping && lastPacketSize != SOCKET_ERROR && !endOfStream)
+		{
+			addSendTimestamps(*timestamping, start, size);
+		}
+
+		return lastPacketSize;
+	}
+
+	int Network::receiveFrameWithoutException(utility::ContainerWrapper& data, bool& endOfStream, int flags, NetworkError& error)
+	{
+		int size = 0;
+		uint32_t checksum = 0;
+
+		if (timestamping)
+		{
+			timestamping->frameKernelTimestamp.reset();
+		}
+
+		int lastPacketSize = this->receiveFrameHeader(size, checksum, endOfStream, flags, error);
+
+		if (lastPacketSize == SOCKET_ERROR || endOfStream)
+		{
+			return lastPacketSize;
+		}
+
+		if (this->checkFrameSize(size, size, flags, error) == SOCKET_ERROR)
+		{
+			return SOCKET_ERROR;
+		}
+
+		data.resizeAndOverwrite
+		(
+			static_cast<size_t>(size),
+			[&](char* buffer) -> size_t
+			{
+				lastPacketSize = this->receiveFramePayload(buffer, size, endOfStream, flags, error);
+
+				return lastPacketSize == SOCKET_ERROR || endOfStream ? 0 : static_cast<size_t>(size);
+			}
+		);
+
+		if (lastPacketSize == SOCKET_ERROR)
+		{
+			// Received part of payload is already restored, so repeated call receives whole frame
+			this->restoreFrameHeader(size, checksum);
+
+			return SOCKET_ERROR;
+		}
+
+		if (endOfStream)
+		{
+			return lastPacketSize;
+		}
+
+		if (frameChecksum && utility::crc32c(data.data(), static_cast<size_t>(size)) != checksum)
+		{
+			return setFrameError(error, EBADMSG, "Frame checksum mismatch", __LINE__, __FILE__);
+		}
+
+		if (timestamping)
+		{
+			setReceiveTimestamps(*timestamping);
+		}
+
+		return lastPacketSize;
+	}
+
+	int Network::trySendFrame(const char* data, int size, bool& endOfStream, NetworkError& error, int flags)
+	{
+		auto sendFunction = [&]() -> int
+			{
+				return this->sendFrameWithoutException(data, size, endOfStream, flags, error);
+			};
+
+		return utility::NetworkObserver::isAnyInstalled() ?
+			this->observe(utility::NetworkOperation::sendData, size, endOfStream, sendFunction, &error) :
+			sendFunction();
+	}
+
+	int Network::tryReceiveFrame(utility::ContainerWrapper& data, bool& endOfStream, NetworkError& error, int flags)
+	{
+		auto receiveFunction = [&]() -> int
+			{
+				return this->receiveFrameWithoutException(data, endOfStream, flags, error);
+			};
+
+		return utility::NetworkObserver::isAnyInstalled() ?
+			this->observe(utility::NetworkOperation::receiveData, static_cast<int>(data.size()), endOfStream, receiveFunction, &error) :
+			receiveFunction();
+	}
+
+	utility::TcpInfo Network::getTcpInfo(SOCKET socket)
+	{
+		utility::TcpInfo result = {};
+
+#ifdef __LINUX__
+		KernelTcpInfo info = {};
+		socklen_t size = sizeof(info);
+
+		if (getsockopt(socket, IPPROTO_TCP, TCP_INFO, &info, &size) == SOCKET_ERROR)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+
+		result.rtt = std::chrono::microseconds(info.rtt);
+		result.rttVariance = std::chrono::microseconds(info.rttVariance);
+		result.minRtt = std::chrono::microseconds(info.minRtt);
+		result.congestionWindow = info.sendCongestionWindow;
+		result.slowStartThreshold = info.sendSlowStartThreshold;
+		result.mss = info.sendMss;
+		result.unacked = info.unacked;
+		result.lost = info.lost;
+		result.retransmitting = info.retransmitting;
+		result.totalRetransmits = info.totalRetransmits;
+		result.notSentBytes = info.notSentBytes;
+		result.deliveryRate = info.deliveryRate;
+		result.bytesSent = info.bytesSent;
+		result.bytesRetransmitted = info.bytesRetransmitted;
+		result.bytesReceived = info.bytesReceived;
+		result.busyTime = std::chrono::microseconds(info.busyTime);
+		result.receiveWindowLimited = std::chrono::microseconds(info.receiveWindowLimited);
+		result.sendBufferLimited = std::chrono::microseconds(info.sendBufferLimited);
+#else
+		DWORD version = 0;
+		DWORD bytesReturned = 0;
+		TCP_INFO_v0 info = {};
+
+		if (WSAIoctl(socket, SIO_TCP_INFO, &version, sizeof(version), &info, sizeof(info), &bytesReturned, nullptr, nullptr) == SOCKET_ERROR)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+
+		// Windows reports congestion window and bytes in flight in bytes
+		ULONG mss = info.Mss ? info.Mss : 1;
+
+		result.rtt = std::chrono::microseconds(info.RttUs);
+		result.minRtt = std::chrono::microseconds(info.MinRttUs);
+		result.congestionWindow = info.Cwnd / mss;
+		result.mss = info.Mss;
+		result.unacked = info.BytesInFlight / mss;
+		result.totalRetransmits = info.FastRetrans + info.TimeoutEpisodes;
+		result.bytesSent = info.BytesOut;
+		result.bytesRetransmitted = info.BytesRetrans;
+		result.bytesReceived = info.BytesIn;
+#endif
+
+		return result;
+	}
+
+	std::shared_ptr<utility::NetworkObserver> Network::getActiveObserver() const
+	{
+		return observer ? observer : utility::NetworkObserver::getGlobal();
+	}
+
+	size_t Network::encodeSizeHeader(int64_t size, char* header) const noexcept
+	{
+		if (frameHeader == FrameHeader::large)
+		{
+			std::memcpy(header, &size, sizeof(size));
+
+			return sizeof(size);
+		}
+
+		if (frameHeader == FrameHeader::varint)
+		{
+			return utility::encodeVarint(static_cast<uint64_t>(size), header);
+		}
+
+		int fixedSize = static_cast<int>(size);
+
+		std::memcpy(header, &fixedSize, sizeof(fixedSize));
+
+		return sizeof(fixedSize);
+	}
+
+	int Network::sendSizeHeader(int64_t size, bool& endOfStream, int flags)
+	{
+		char header[maxFrameHeaderSize];
+
+		if (frameHeader != FrameHeader::large && (size < 0 || size > (std::numeric_limits<int>::max)()))
+		{
+			throw exceptions::WebException(EMSGSIZE, "Frame size doesn't fit frame header, use FrameHeader::large", __LINE__, __FILE__);
+		}
+
+		return this->sendBytes(header, static_cast<int>(this->encodeSizeHeader(size, header)), endOfStream, flags);
+	}
+
+	int Network::receiveSizeHeader(int64_t& size, bool& endOfStream, int flags, NetworkError& error)
+	{
+		if (frameHeader == FrameHeader::large)
+		{
+			int lastPacketSize = this->tryReceiveBytes(&size, sizeof(size), endOfStream, error, flags);
+
+			if (lastPacketSize != SOCKET_ERROR && !endOfStream && size < 0)
+			{
+				return setFrameError(error, EBADMSG, "Invalid large frame header", __LINE__, __FILE__);
+			}
+
+			return lastPacketSize;
+		}
+
+		if (frameHeader == FrameHeader::fixed)
+		{
+			int fixedSize = 0;
+			int lastPacketSize = this->tryReceiveBytes(&fixedSize, sizeof(fixedSize), endOfStream, error, flags);
+
+			if (lastPacketSize != SOCKET_ERROR && !endOfStream && fixedSize < 0)
+			{
+				return setFrameError(error, EBADMSG, "Invalid fixed frame header", __LINE__, __FILE__);
+			}
+
+			size = fixedSize;
+
+			return lastPacketSize;
+		}
+
+		// Not received bytes have high bit set, so they never end value
+		char header[sizeof(uint64_t)];
+		int received = 0;
+		uint64_t value = 0;
+		size_t headerSize = 0;
+
+		std::fill(std::begin(header), std::end(header), static_cast<char>(0x80));
+
+		do
+		{
+			// Multi byte header is followed by at least 128 bytes of payload, so rest of header is requested at once without waiting for next frame
+			int lastPacketSize = this->tryReceiveBytes(header + received, received ? static_cast<int>(utility::maxVarint32Size) - received : 1, endOfStream, error, flags);
+
+			if (lastPacketSize == SOCKET_ERROR)
+			{
+				// Next call starts from first byte of header
+				this->restoreReceivedBytes(std::string_view(header, received));
+
+				return SOCKET_ERROR;
+			}
+
+			if (endOfStream)
+			{
+				return lastPacketSize;
+			}
+
+			received += lastPacketSize;
+		} while (!(headerSize = utility::decodeVarint32(header, value)) && received < static_cast<int>(utility::maxVarint32Size));
+
+		if (!headerSize || value > static_cast<uint64_t>((std::numeric_limits<int>::max)()))
+		{
+			return setFrameError(error, EBADMSG, "Invalid varint frame header", __LINE__, __FILE__);
+		}
+
+		size = static_cast<int64_t>(value);
+		headerOverflowSize = received - static_cast<int>(headerSize);
+
+		std::copy_n(header + headerSize, headerOverflowSize, headerOverflow.data());
+
+		return static_cast<int>(headerSize);
+	}
+
+	int Network::sendFrameHeader(const char* data, int size, bool& endOfStream, int flags, NetworkError& error)
+	{
+		if (!frameChecksum)
+		{
+			char header[maxFrameHeaderSize];
+
+			return this->trySendBytes(header, static_cast<int>(this->encodeSizeHeader(size, header)), endOfStream, error, flags);
+		}
+
+		// Payload checksum goes in header, so frame takes as many send calls as without checksum
+		ChecksumFrameHeader header = { size, utility::crc32c(data, static_cast<size_t>(size)), 0 };
+
+		header.headerChecksum = utility::crc32c(&header, offsetof(ChecksumFrameHeader, headerChecksum));
+
+		return this->trySendBytes(&header, sizeof(header), endOfStream, error, flags);
+	}
+
+	int Network::receiveFrameHeader(int& size, uint32_t& checksum, bool& endOfStream, int flags, NetworkError& error)
+	{
+		if (!frameChecksum)
+		{
+			int64_t frameSize = 0;
+			int lastPacketSize = this->receiveSizeHeader(frameSize, endOfStream, flags, error);
+
+			if (lastPacketSize == SOCKET_ERROR || endOfStream)
+			{
+				return lastPacketSize;
+			}
+
+			if (frameSize > (std::numeric_limits<int>::max)())
+			{
+				return setFrameError(error, EMSGSIZE, "Frame is larger than 2 GiB, use receiveChunkedData", __LINE__, __FILE__);
+			}
+
+			size = static_cast<int>(frameSize);
+
+			return lastPacketSize;
+		}
+
+		ChecksumFrameHeader header = {};
+		int lastPacketSize = this->tryReceiveBytes(&header, sizeof(header), endOfStream, error, flags);
+
+		if (lastPacketSize == SOCKET_ERROR || endOfStream)
+		{
+			return lastPacketSize;
+		}
+
+		if (utility::crc32c(&header, offsetof(ChecksumFrameHeader, headerChecksum)) != header.headerChecksum || header.size < 0)
+		{
+			return setFrameError(error, EBADMSG, "Frame header checksum mismatch", __LINE__, __FILE__);
+		}
+
+		size = header.size;
+		checksum = header.checksum;
+
+		return lastPacketSize;
+	}
+
+	void Network::restoreFrameHeader(int size, uint32_t checksum)
+	{
+		if (frameChecksum)
+		{
+			ChecksumFrameHeader header = { size, checksum, 0 };
+
+			header.headerChecksum = utility::crc32c(&header, offsetof(ChecksumFrameHeader, headerChecksum));
+
+			this->restoreReceivedBytes(std::string_view(reinterpret_cast<const char*>(&header), sizeof(header)));
+
+			return;
+		}
+
+		char header[maxFrameHeaderSize];
+
+		this->restoreReceivedBytes(std::string_view(header, this->encodeSizeHeader(size, header)));
+	}
+
+	void Network::checkChunkedMode() const
+	{
+		if (frameChecksum)
+		{
+			throw exceptions::WebException(EOPNOTSUPP, "Frame checksum needs whole payload and doesn't support chunked frames", __LINE__, __FILE__);
+		}
+	}
+
+	std::shared_ptr<SOCKET> Network::createHandle(SOCKET socket)
+	{
+		struct SocketHandle
+		{
+			SOCKET socket;
+
+			SocketHandle(SOCKET socket) :
+				socket(socket)
+			{
+
+			}
+
+			~SocketHandle()
+			{
+				closesocket(socket);
+			}
+		};
+
+		std::shared_ptr<SocketHandle> owner = std::make_shared<SocketHandle>(socket);
+
+		return std::shared_ptr<SOCKET>(owner, &owner->socket);
+	}
+
+	int Network::checkFrameSize(int64_t size, int64_t payloadSize, int flags, NetworkError& error)
+	{
+		if (size < 0)
+		{
+			return setFrameError(error, EBADMSG, "Negative frame size", __LINE__, __FILE__);
+		}
+
+		if (size > maxFrameSize)
+		{
+			bool endOfStream = false;
+
+			// Keep stream in sync with next frame
+			if (this->dropFramePayload(payloadSize, endOfStream, flags, error) == SOCKET_ERROR)
+			{
+				return SOCKET_ERROR;
+			}
+
+			return setFrameError(error, EMSGSIZE, "Frame is larger than maximum frame size, use receiveChunkedData", __LINE__, __FILE__);
+		}
+
+		return 0;
+	}
+
+	void Network::checkFrameSize(int64_t size, int64_t payloadSize, int flags)
+	{
+		NetworkError error = {};
+
+		if (this->checkFrameSize(size, payloadSize, flags, error) == SOCKET_ERROR)
+		{
+			this->throwException(error);
+		}
+	}
+
+	int Network::dropFramePayload(int64_t size, bool& endOfStream, int flags, NetworkError& error)
+	{
+		std::array<char, 16 * 1024> chunk;
+
+		endOfStream = false;
+
+		while (size)
+		{
+			int lastPacketSize = this->receiveFramePayload(chunk.data(), static_cast<int>((std::min)(size, static_cast<int64_t>(chunk.size()))), endOfStream, flags, error);
+
+			if (lastPacketSize == SOCKET_ERROR)
+			{
+				return SOCKET_ERROR;
+			}
+
+			if (endOfStream)
+			{
+				break;
+			}
+
+			size -= lastPacketSize;
+		}
+
+		return 0;
+	}
+
+	void Network::setTimeout(int64_t timeout)
+	{
+#ifdef __LINUX__
+		timeval timeoutValue;
+
+		timeoutValue.tv_sec = timeout / 1000;
+		timeoutValue.tv_usec = (timeout - timeoutValue.tv_sec * 1000) * 1000;
+#else
+		DWORD timeoutValue = static_cast<DWORD>(timeout);
+#endif
+
+		if (setsockopt(this->getClientSocket(), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeoutValue), sizeof(timeoutValue)) == SOCKET_ERROR)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+
+		if (setsockopt(this->getClientSocket(), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeoutValue), sizeof(timeoutValue)) == SOCKET_ERROR)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+	}
+
+	Network::Network(std::string_view ip, std::string_view port, int64_t timeout)
+	{
+		SOCKET tempSocket = INVALID_SOCKET;
+
+#ifndef __LINUX__
+		WSADATA wsaData;
+
+		if (WSAStartup(MAKEWORD(2, 2), &wsaData))
+		{
+			THROW_WEB_EXCEPTION;
+		}
+#endif // !__LINUX__
+
+		addrinfo* info = nullptr;
+		addrinfo hints = {};
+
+		hints.ai_family = AF_INET;
+		hints.ai_socktype = SOCK_STREAM;
+		hints.ai_protocol = IPPROTO_TCP;
+
+		if (getaddrinfo(ip.data(), port.data(), &hints, &info))
+		{
+			THROW_WEB_EXCEPTION;
+		}
+
+		if (tempSocket = socket(info->ai_family, info->ai_socktype, info->ai_protocol); tempSocket == INVALID_SOCKET)
+		{
+			freeaddrinfo(info);
+
+			THROW_WEB_EXCEPTION;
+		}
+
+		if (connect(tempSocket, info->ai_addr, static_cast<int>(info->ai_addrlen)) == SOCKET_ERROR)
+		{
+			freeaddrinfo(info);
+
+			THROW_WEB_EXCEPTION;
+		}
+
+		handle = Network::createHandle(tempSocket);
+
+		freeaddrinfo(info);
+
+		this->setTimeout(timeout);
+	}
+
+	bool Network::isDataAvailable(int* availableBytes, bool* hasConnection) const
+	{
+		SOCKET socket = this->getClientSocket();
+
+		if (hasConnection)
+		{
+			char buffer;
+			int result = this->callInNonBlockingMode
+			(
+				std::bind(&Network::receiveBytesImplementation, const_cast<Network*>(this), &buffer, static_cast<int>(sizeof(buffer)), MSG_PEEK)
+			);
+
+			if (result > 0)
+			{
+				*hasConnection = true;
+			}
+			else if (result < 0)
+			{
+#ifdef __LINUX__
+				if (errno == EAGAIN || errno == EWOULDBLOCK)
+				{
+					*hasConnection = true;
+				}
+				else
+				{
+					if (availableBytes)
+					{
+						*availableBytes = 0;
+					}
+
+					*hasConnection = false;
+
+					return false;
+				}
+#else
+				if (int errorCode = WSAGetLastError(); errorCode == WSAEWOULDBLOCK)
+				{
+					*hasConnection = true;
+				}
+				else
+				{
+					if (availableBytes)
+					{
+						*availableBytes = 0;
+					}
+
+					*hasConnection = false;
+
+					return false;
+				}
+#endif
+			}
+			else
+			{
+				if (availableBytes)
+				{
+					*availableBytes = 0;
+				}
+
+				*hasConnection = false;
+
+				return false;
+			}
+		}
+
+#ifdef __LINUX__
+		int result = 0;
+
+		if (ioctl(socket, FIONREAD, &result) < 0)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+#else
+		u_long result = 0;
+
+		if (ioctlsocket(socket, FIONREAD, &result) == SOCKET_ERROR)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+#endif
+
+		if (availableBytes)
+		{
+			*availableBytes = static_cast<int>(result);
+		}
+
+		return result > 0;
+	}
+
+	int Network::sendData(const utility::ContainerWrapper& data, bool& endOfStream, int flags)
+	{
+		NetworkError error = {};
+		int result = this->trySendFrame(data.data(), static_cast<int>(data.size()), endOfStream, error, flags);
+
+		if (result == SOCKET_ERROR)
+		{
+			this->throwException(error);
+		}
+
+		return result;
+	}
+
+	int Network::sendRawData(const char* data, int size, bool& endOfStream, int flags)
+	{
+		NetworkError error = {};
+		int result = this->trySendFrame(data, size, endOfStream, error, flags);
+
+		if (result == SOCKET_ERROR)
+		{
+			this->throwException(error);
+		}
+
+		return result;
+	}
+
+	int Network::receiveData(utility::ContainerWrapper& data, bool& endOfStream, int flags)
+	{
+		NetworkError error = {};
+		int result = this->tryReceiveFrame(data, endOfStream, error, flags);
+
+		if (result == SOCKET_ERROR)
+		{
+			this->throwException(error);
+		}
+
+		return result;
+	}
+
+	int Network::trySendData(const utility::ContainerWrapper& data, bool& endOfStream, NetworkError& error, int flags)
+	{
+		// Subclass may override sendData
+		if (typeid(*this) == typeid(Network))
+		{
+			return this->trySendFrame(data.data(), static_cast<int>(data.size()), endOfStream, error, flags);
+		}
+
+		try
+		{
+			return this->sendData(data, endOfStream, flags);
+		}
+		catch (const exceptions::WebException& e)
+		{
+			error = { e.getErrorCode(), e.getLine(), e.getFile() };
+
+			return SOCKET_ERROR;
+		}
+	}
+
+	int Network::tryReceiveData(utility::ContainerWrapper& data, bool& endOfStream, NetworkError& error, int flags)
+	{
+		// Subclass may override receiveData
+		if (typeid(*this) == typeid(Network))
+		{
+			return this->tryReceiveFrame(data, endOfStream, error, flags);
+		}
+
+		try
+		{
+			// Routine timeout before frame arrived doesn't throw inside overridden receiveData
+			if (!this->hasPendingInput())
+			{
+				char first = 0;
+				int result = this->tryReceiveBytes(&first, 1, endOfStream, error, flags | MSG_PEEK);
+
+				// Empty datagram isn't end of stream
+				if (result == SOCKET_ERROR || (endOfStream && this->isStreamOriented()))
+				{
+					return result;
+				}
+			}
+
+			return this->receiveData(data, endOfStream, flags);
+		}
+		catch (const exceptions::WebException& e)
+		{
+			error = { e.getErrorCode(), e.getLine(), e.getFile() };
+
+			return SOCKET_ERROR;
+		}
+	}
+
+	int Network::receiveScatteredData(std::span<char> header, utility::ContainerWrapper& body, bool& endOfStream, int flags)
+	{
+		auto receiveFunction = [&]() -> int
+			{
+				int size = 0;
+				uint32_t checksum = 0;
+
+				if (timestamping)
+				{
+					timestamping->frameKernelTimestamp.reset();
+				}
+
+				NetworkError error = {};
+				int lastPacketSize = this->receiveFrameHeader(size, checksum, endOfStream, flags, error);
+
+				if (lastPacketSize == SOCKET_ERROR)
+				{
+					this->throwException(error);
+				}
+
+				if (endOfStream)
+				{
+					return lastPacketSize;
+				}
+
+				if (static_cast<size_t>(size) < header.size())
+				{
+					throw exceptions::WebException(EBADMSG, "Frame is smaller than header", __LINE__, __FILE__);
+				}
+
+				this->checkFrameSize(size, size, flags);
+
+				size_t bodySize = static_cast<size_t>(size) - header.size();
+
+				body.resizeAndOverwrite
+				(
+					bodySize,
+					[&](char* buffer) -> size_t
+					{
+						std::array<std::span<char>, 2> buffers = { header, std::span<char>(buffer, bodySize) };
+
+						lastPacketSize = this->receiveFrameBuffers(buffers, endOfStream, flags);
+
+						return endOfStream ? 0 : bodySize;
+					}
+				);
+
+				if (endOfStream)
+				{
+					return lastPacketSize;
+				}
+
+				if (frameChecksum)
+				{
+					checkFrameChecksum(utility::crc32c(body.data(), bodySize, utility::crc32c(header.data(), header.size())), checksum);
+				}
+
+				if (timestamping)
+				{
+					setReceiveTimestamps(*timestamping);
+				}
+
+				return size;
+			};
+
+		return utility::NetworkObserver::isAnyInstalled() ?
+			this->observe(utility::NetworkOperation::receiveData, static_cast<int>(header.size() + body.size()), endOfStream, receiveFunction) :
+			receiveFunction();
+	}
+
+	int Network::receiveRawData(char* data, int size, bool& endOfStream, int flags)
+	{
+		auto receiveFunction = [&]() -> int
+			{
+				int inputSize = 0;
+				uint32_t checksum = 0;
+
+				if (timestamping)
+				{
+					timestamping->frameKernelTimestamp.reset();
+				}
+
+				NetworkError error = {};
+				int lastPacketSize = this->receiveFrameHeader(inputSize, checksum, endOfStream, flags, error);
+
+				if (lastPacketSize == SOCKET_ERROR)
+				{
+					this->throwException(error);
+				}
+
+				if (endOfStream)
+				{
+					return lastPacketSize;
+				}
+
+				if (size < inputSize)
+				{
+					std::cerr << "In " << __FUNCTION__ << " passed size(" << size << ") < actual data size(" << inputSize << ')' << std::endl;
+				}
+
+				if (frameChecksum)
+				{
+					// Whole frame is needed for checksum, data that doesn't fit is dropped
+					int payloadSize = (std::min)(size, inputSize);
+
+					lastPacketSize = this->receiveFramePayload(data, payloadSize, endOfStream, flags, error);
+
+					if (lastPacketSize == SOCKET_ERROR)
+					{
+						this->throwException(error);
+					}
+
+					if (endOfStream)
+					{
+						return lastPacketSize;
+					}
+
+					uint32_t actualChecksum = utility::crc32c(data, static_cast<size_t>(payloadSize));
+
+					if (payloadSize < inputSize)
+					{
+						std::vector<char> rest(static_cast<size_t>(inputSize - payloadSize));
+
+						if (this->receiveFramePayload(rest.data(), static_cast<int>(rest.size()), endOfStream, flags, error) == SOCKET_ERROR)
+						{
+							this->throwException(error);
+						}
+
+						if (endOfStream)
+						{
+							return 0;
+						}
+
+						actualChecksum = utility::crc32c(rest.data(), rest.size(), actualChecksum);
+					}
+
+					checkFrameChecksum(actualChecksum, checksum);
+				}
+				else
+				{
+					lastPacketSize = this->receiveFramePayload(data, size, endOfStream, flags, error);
+
+					if (lastPacketSize == SOCKET_ERROR)
+					{
+						this->throwException(error);
+					}
+				}
+
+				if (timestamping && !endOfStream)
+				{
+					setReceiveTimestamps(*timestamping);
+				}
+
+				return lastPacketSize;
+			};
+
+		return utility::NetworkObserver::isAnyInstalled() ?
+			this->observe(utility::NetworkOperation::receiveData, size, endOfStream, receiveFunction) :
+			receiveFunction();
+	}
+
+	void Network::addReceiveBuffer(std::string_view buffer)
+	{
+		buffers.push(buffer);
+	}
+
+	void Network::restoreReceivedBytes(std::string_view data)
+	{
+		if (data.empty())
+		{
+			return;
+		}
+
+		// Pending buffers may point into restoredBytes, so they are copied after data before it's replaced
+		std::string restored(data);
+
+		while (buffers.size())
+		{
+			restored += buffers.front();
+
+			buffers.pop();
+		}
+
+		restoredBytes = std::move(restored);
+
+		buffers.push(restoredBytes);
+	}
+
+	bool Network::hasPendingInput() const noexcept
+	{
+		return buffers.size() || headerOverflowSize;
+	}
+
+	SOCKET Network::getClientSocket() const
+	{
+		if (handle)
+		{
+			return *handle;
+		}
+
+		return INVALID_SOCKET;
+	}
+
+	bool Network::enableStatistics([[maybe_unused]] bool enable)
+	{
+#ifdef SOCKET_STREAMS_STATISTICS
+		if (!enable)
+		{
+			statistics.reset();
+		}
+		else if (!statistics)
+		{
+			statistics = std::make_shared<utility::NetworkStatistics>();
+		}
+
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool Network::isStatisticsEnabled() const noexcept
+	{
+		return static_cast<bool>(statistics);
+	}
+
+	utility::NetworkStatisticsSnapshot Network::getStatistics() const
+	{
+		if (statistics)
+		{
+			return statistics->getSnapshot();
+		}
+
+		return utility::NetworkStatisticsSnapshot();
+	}
+
+	utility::TcpInfo Network::getTcpInfo() const
+	{
+		return Network::getTcpInfo(this->getClientSocket());
+	}
+
+	void Network::setObserver(const std::shared_ptr<utility::NetworkObserver>& observer)
+	{
+		this->observer = utility::NetworkObserver::install(observer);
+	}
+
+	std::shared_ptr<utility::NetworkObserver> Network::getObserver() const
+	{
+		return observer;
+	}
+
+	bool Network::enableTimestamping(bool enable)
+	{
+#ifdef __LINUX__
+		if (enable == static_cast<bool>(timestamping))
+		{
+			return true;
+		}
+
+		int flags = enable ?
+			SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_TX_SCHED | SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_TX_ACK | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY :
+			0;
+
+		if (setsockopt(this->getClientSocket(), SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == SOCKET_ERROR)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+
+		if (!enable)
+		{
+			timestamping.reset();
+
+			return true;
+		}
+
+		int queuedBytes = 0;
+
+		// OPT_ID key of TCP socket counts from first unacknowledged byte, so already queued bytes are counted too
+		if (ioctl(this->getClientSocket(), SIOCOUTQ, &queuedBytes) == SOCKET_ERROR)
+		{
+			queuedBytes = 0;
+		}
+
+		timestamping = std::make_shared<utility::TimestampingState>();
+
+		timestamping->sentBytes = static_cast<uint32_t>(queuedBytes);
+
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void Network::setBusyPoll(std::chrono::microseconds spinTime, bool kernelBusyPoll)
+	{
+		if (kernelBusyPoll)
+		{
+#ifdef __LINUX__
+			int busyPoll = static_cast<int>(spinTime.count());
+			int preferBusyPoll = busyPoll > 0;
+
+			if (setsockopt(this->getClientSocket(), SOL_SOCKET, SO_BUSY_POLL, &busyPoll, sizeof(busyPoll)) == SOCKET_ERROR)
+			{
+				THROW_WEB_EXCEPTION;
+			}
+
+			if (setsockopt(this->getClientSocket(), SOL_SOCKET, SO_PREFER_BUSY_POLL, &preferBusyPoll, sizeof(preferBusyPoll)) == SOCKET_ERROR)
+			{
+				THROW_WEB_EXCEPTION;
+			}
+#else
+			WSASetLastError(WSAEOPNOTSUPP);
+
+			THROW_WEB_EXCEPTION;
+#endif
+		}
+
+		busyPollTime = (std::max)(spinTime, std::chrono::microseconds(0));
+	}
+
+	std::chrono::microseconds Network::getBusyPoll() const noexcept
+	{
+		return busyPollTime;
+	}
+
+	bool Network::enableFrameChecksum(bool enable)
+	{
+		frameChecksum = enable;
+
+		return true;
+	}
+
+	bool Network::isFrameChecksumEnabled() const noexcept
+	{
+		return frameChecksum;
+	}
+
+	bool Network::setFrameHeader(FrameHeader header)
+	{
+		frameHeader = header;
+
+		return true;
+	}
+
+	FrameHeader Network::getFrameHeader() const noexcept
+	{
+		return frameHeader;
+	}
+
+	void Network::setMaxFrameSize(int maxFrameSize) noexcept
+	{
+		this->maxFrameSize = maxFrameSize;
+	}
+
+	int Network::getMaxFrameSize() const noexcept
+	{
+		return maxFrameSize;
+	}
+
+	FrameHeader Network::negotiateFrameHeader(FrameHeader preferred)
+	{
+		char request[sizeof(frameHeaderNegotiationMagic) + 1];
+		char response[sizeof(request)];
+		bool endOfStream = false;
+
+		if (!this->setFrameHeader(preferred))
+		{
+			preferred = FrameHeader::fixed;
+		}
+
+		std::copy_n(frameHeaderNegotiationMagic, sizeof(frameHeaderNegotiationMagic), request);
+
+		request[sizeof(frameHeaderNegotiationMagic)] = static_cast<char>(preferred);
+
+		this->sendBytes(request, sizeof(request), endOfStream);
+
+		if (!endOfStream)
+		{
+			this->receiveBytes(response, sizeof(response), endOfStream);
+		}
+
+		if (endOfStream)
+		{
+			throw exceptions::WebException(ECONNRESET, "Connection closed during frame header negotiation", __LINE__, __FILE__);
+		}
+
+		if (!std::equal(std::begin(frameHeaderNegotiationMagic), std::end(frameHeaderNegotiationMagic), response))
+		{
+			throw exceptions::WebException(EPROTO, "Peer doesn't support frame header negotiation", __LINE__, __FILE__);
+		}
+
+		FrameHeader peerPreferred = static_cast<FrameHeader>(response[sizeof(frameHeaderNegotiationMagic)]);
+
+		if (std::ranges::find(frameHeaderNegotiationOrder, peerPreferred) == std::end(frameHeaderNegotiationOrder))
+		{
+			throw exceptions::WebException(EPROTO, "Unknown frame header format of peer", __LINE__, __FILE__);
+		}
+
+		FrameHeader result = *std::ranges::find_if(frameHeaderNegotiationOrder, [preferred, peerPreferred](FrameHeader header) { return header == preferred || header == peerPreferred; });
+
+		if (!this->setFrameHeader(result))
+		{
+			throw exceptions::WebException(EPROTO, "Negotiated frame header isn't supported", __LINE__, __FILE__);
+		}
+
+		return result;
+	}
+
+	int64_t Network::sendLargeData(const char* data, int64_t size, bool& endOfStream, int flags)
+	{
+		// sendBytes takes int size
+		constexpr int64_t maxPieceSize = 1 << 30;
+
+		int lastPacketSize = this->sendFrameSize(size, endOfStream, flags);
+		int64_t totalSent = 0;
+
+		if (endOfStream)
+		{
+			return lastPacketSize;
+		}
+
+		while (totalSent < size)
+		{
+			lastPacketSize = this->sendBytes(data + totalSent, static_cast<int>((std::min)(size - totalSent, maxPieceSize)), endOfStream, flags);
+
+			if (endOfStream)
+			{
+				break;
+			}
+
+			totalSent += lastPacketSize;
+		}
+
+		return totalSent;
+	}
+
+	int Network::sendFrameSize(int64_t size, bool& endOfStream, int flags)
+	{
+		this->checkChunkedMode();
+
+		return this->sendSizeHeader(size, endOfStream, flags);
+	}
+
+	int64_t Network::receiveFrameSize(bool& endOfStream, int flags)
+	{
+		int64_t size = 0;
+		NetworkError error = {};
+
+		this->checkChunkedMode();
+
+		if (this->receiveSizeHeader(size, endOfStream, flags, error) == SOCKET_ERROR)
+		{
+			this->throwException(error);
+		}
+
+		return endOfStream ? 0 : size;
+	}
+
+	int64_t Network::receiveFrameChunks(int64_t size, const std::function<void(std::string_view)>& callback, bool& endOfStream, int64_t chunkSize, int flags)
+	{
+		// Chunk must hold payload bytes received together with varint header
+		chunkSize = std::clamp<int64_t>(chunkSize, headerOverflow.size(), (std::numeric_limits<int>::max)());
+
+		std::vector<char> chunk(static_cast<size_t>((std::min)(size, chunkSize)));
+		int64_t totalReceived = 0;
+		NetworkError error = {};
+
+		endOfStream = false;
+
+		while (totalReceived < size)
+		{
+			int lastPacketSize = this->receiveFramePayload(chunk.data(), static_cast<int>((std::min)(size - totalReceived, chunkSize)), endOfStream, flags, error);
+
+			if (lastPacketSize == SOCKET_ERROR)
+			{
+				this->throwException(error);
+			}
+
+			if (endOfStream)
+			{
+				break;
+			}
+
+			callback(std::string_view(chunk.data(), static_cast<size_t>(lastPacketSize)));
+
+			totalReceived += lastPacketSize;
+		}
+
+		return totalReceived;
+	}
+
+	int64_t Network::receiveChunkedData(const std::function<void(std::string_view)>& callback, bool& endOfStream, int64_t chunkSize, int flags)
+	{
+		int64_t size = this->receiveFrameSize(endOfStream, flags);
+
+		if (endOfStream)
+		{
+			return 0;
+		}
+
+		return this->receiveFrameChunks(size, callback, endOfStream, chunkSize, flags);
+	}
+
+	bool Network::isTimestampingEnabled() const noexcept
+	{
+		return static_cast<bool>(timestamping);
+	}
+
+	std::optional<utility::ReceiveTimestamps> Network::getReceiveTimestamps() const
+	{
+		if (timestamping)
+		{
+			return timestamping->lastReceive;
+		}
+
+		return std::nullopt;
+	}
+
+	std::vector<utility::SendTimestamps> Network::getSendTimestamps()
+	{
+		std::vector<utility::SendTimestamps> result;
+
+		if (!timestamping)
+		{
+			return result;
+		}
+
+#ifdef __LINUX__
+		std::deque<utility::SendTimestamps>& pendingFrames = timestamping->pendingFrames;
+
+		while (true)
+		{
+			char control[CMSG_SPACE(sizeof(scm_timestamping)) + CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+			msghdr message = {};
+			std::optional<std::chrono::system_clock::time_point> timestamp;
+			sock_extended_err error = {};
+
+			message.msg_control = control;
+			message.msg_controllen = sizeof(control);
+
+			if (recvmsg(this->getClientSocket(), &message, MSG_ERRQUEUE | MSG_DONTWAIT) == SOCKET_ERROR)
+			{
+				if (errno == EAGAIN || errno == EWOULDBLOCK)
+				{
+					break;
+				}
+
+				THROW_WEB_EXCEPTION;
+			}
+
+			for (cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header))
+			{
+				if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_TIMESTAMPING)
+				{
+					scm_timestamping timestamps;
+
+					std::copy_n(reinterpret_cast<const char*>(CMSG_DATA(header)), sizeof(timestamps), reinterpret_cast<char*>(&timestamps));
+
+					timestamp = toTimePoint(timestamps.ts[0]);
+				}
+				else if ((header->cmsg_level == IPPROTO_IP && header->cmsg_type == IP_RECVERR) || (header->cmsg_level == IPPROTO_IPV6 && header->cmsg_type == IPV6_RECVERR))
+				{
+					std::copy_n(reinterpret_cast<const char*>(CMSG_DATA(header)), sizeof(error), reinterpret_cast<char*>(&error));
+				}
+			}
+
+			if (!timestamp || error.ee_errno != ENOMSG || error.ee_origin != SO_EE_ORIGIN_TIMESTAMPING)
+			{
+				continue;
+			}
+
+			// Every send call reports its last byte, header sends and frames dropped from pending queue don't match any frame
+			auto it = std::find_if(pendingFrames.begin(), pendingFrames.end(), [&error](const utility::SendTimestamps& frame) { return frame.id == error.ee_data; });
+
+			if (it == pendingFrames.end())
+			{
+				continue;
+			}
+
+			switch (error.ee_info)
+			{
+			case SCM_TSTAMP_SCHED:
+				it->scheduled = timestamp;
+
+				break;
+
+			case SCM_TSTAMP_SND:
+				it->software = timestamp;
+
+				break;
+
+			case SCM_TSTAMP_ACK:
+				it->acknowledged = timestamp;
+
+				break;
+			}
+		}
+
+		// TCP acknowledges cumulatively, so all frames before last acknowledged one are acknowledged too
+		auto lastAcknowledged = std::find_if(pendingFrames.rbegin(), pendingFrames.rend(), [](const utility::SendTimestamps& frame) { return frame.acknowledged.has_value(); });
+
+		if (lastAcknowledged != pendingFrames.rend())
+		{
+			auto end = lastAcknowledged.base();
+
+			result.assign(std::make_move_iterator(pendingFrames.begin()), std::make_move_iterator(end));
+
+			pendingFrames.erase(pendingFrames.begin(), end);
+		}
+#endif
+
+		return result;
+	}
+
+	void Network::resetStatistics()
+	{
+		if (statistics)
+		{
+			statistics->reset();
+		}
 	}
 }
@@ -0,0 +1,37 @@
+#include "NetworkError.h"
+
+#ifdef __LINUX__
+#include <cerrno>
+#else
+#include <WinSock2.h>
+#endif // __LINUX__
+
+namespace web
+{
+	NetworkError NetworkError::fromLastError(int line, std::string_view file) noexcept
+	{
+#ifdef __LINUX__
+		return { errno, line, file };
+#else
+		return { WSAGetLastError(), line, file };
+#endif // __LINUX__
+	}
+
+	bool NetworkError::isTimeout() const noexcept
+	{
+#ifdef __LINUX__
+		return errorCode == EAGAIN || errorCode == EWOULDBLOCK;
+#else
+		return errorCode == WSAETIMEDOUT || errorCode == WSAEWOULDBLOCK;
+#endif // __LINUX__
+	}
+
+	void NetworkError::setLastError() const noexcept
+	{
+#ifdef __LINUX__
+		errno = errorCode;
+#else
+		WSASetLastError(errorCode);
+#endif // __LINUX__
+	}
+}
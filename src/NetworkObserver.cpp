@@ -0,0 +1,223 @@
+#include "NetworkObserver.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace web::utility
+{
+	/// @brief Counts observer as installed during its life
+	struct ObserverRegistration
+	{
+		std::shared_ptr<NetworkObserver> observer;
+
+		ObserverRegistration(const std::shared_ptr<NetworkObserver>& observer);
+
+		~ObserverRegistration();
+	};
+
+	static std::atomic<uint64_t> nextRingBufferObserverId = 1;
+
+	/// @brief Rings of recently used observers on this thread, so alternating between few observers does not lock
+	static constexpr size_t cachedRingsCount = 4;
+
+	std::atomic<size_t> NetworkObserver::installedObservers = 0;
+	std::atomic<std::shared_ptr<NetworkObserver>> NetworkObserver::globalObserver;
+
+	ObserverRegistration::ObserverRegistration(const std::shared_ptr<NetworkObserver>& observer) :
+		observer(observer)
+	{
+		NetworkObserver::installedObservers.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	ObserverRegistration::~ObserverRegistration()
+	{
+		NetworkObserver::installedObservers.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	std::string_view getNetworkOperationName(NetworkOperation operation) noexcept
+	{
+		switch (operation)
+		{
+		case NetworkOperation::sendBytes:
+			return "sendBytes";
+
+		case NetworkOperation::receiveBytes:
+			return "receiveBytes";
+
+		case NetworkOperation::sendData:
+			return "sendData";
+
+		case NetworkOperation::receiveData:
+			return "receiveData";
+
+		default:
+			return "unknown";
+		}
+	}
+
+	std::shared_ptr<NetworkObserver> NetworkObserver::install(const std::shared_ptr<NetworkObserver>& observer)
+	{
+		if (!observer)
+		{
+			return nullptr;
+		}
+
+		std::shared_ptr<ObserverRegistration> registration = std::make_shared<ObserverRegistration>(observer);
+
+		return std::shared_ptr<NetworkObserver>(registration, registration->observer.get());
+	}
+
+	void NetworkObserver::setGlobal(const std::shared_ptr<NetworkObserver>& observer)
+	{
+		globalObserver.store(NetworkObserver::install(observer));
+	}
+
+	std::shared_ptr<NetworkObserver> NetworkObserver::getGlobal()
+	{
+		return globalObserver.load();
+	}
+
+	RingBufferNetworkObserver::Ring::Ring(size_t capacity) :
+		slots(capacity),
+		head(0),
+		thread(std::this_thread::get_id())
+	{
+
+	}
+
+	RingBufferNetworkObserver::Ring& RingBufferNetworkObserver::getRing()
+	{
+		// Observer id instead of address so ring of destroyed observer never matches new one
+		thread_local std::array<std::pair<uint64_t, Ring*>, cachedRingsCount> cachedRings = {};
+		thread_local size_t nextCachedRing = 0;
+
+		for (const auto& [cachedId, cachedRing] : cachedRings)
+		{
+			if (cachedId == id)
+			{
+				return *cachedRing;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		std::thread::id thread = std::this_thread::get_id();
+		auto it = std::find_if(rings.begin(), rings.end(), [thread](const std::shared_ptr<Ring>& ring) { return ring->thread == thread; });
+
+		if (it == rings.end())
+		{
+			it = rings.insert(rings.end(), std::make_shared<Ring>(capacity));
+		}
+
+		cachedRings[nextCachedRing] = { id, it->get() };
+		nextCachedRing = (nextCachedRing + 1) % cachedRingsCount;
+
+		return **it;
+	}
+
+	void RingBufferNetworkObserver::push(const NetworkEvent& event, bool begin)
+	{
+		static_assert(std::is_trivially_copyable_v<Record>, "Record is copied through atomic words");
+
+		Ring& ring = this->getRing();
+		uint64_t position = ring.head.load(std::memory_order_relaxed);
+		Slot& slot = ring.slots[position & (capacity - 1)];
+		Record record = { event, ring.thread, begin };
+		std::array<uint64_t, recordWords> words = {};
+		uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+		std::memcpy(words.data(), &record, sizeof(record));
+
+		slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for (size_t i = 0; i < recordWords; i++)
+		{
+			slot.words[i].store(words[i], std::memory_order_relaxed);
+		}
+
+		slot.sequence.store(sequence + 2, std::memory_order_release);
+
+		ring.head.store(position + 1, std::memory_order_release);
+	}
+
+	RingBufferNetworkObserver::RingBufferNetworkObserver(size_t capacity) :
+		capacity(std::bit_ceil(std::max<size_t>(capacity, 1))),
+		id(nextRingBufferObserverId.fetch_add(1, std::memory_order_relaxed))
+	{
+
+	}
+
+	void RingBufferNetworkObserver::onBegin(const NetworkEvent& event)
+	{
+		this->push(event, true);
+	}
+
+	void RingBufferNetworkObserver::onEnd(const NetworkEvent& event)
+	{
+		this->push(event, false);
+	}
+
+	std::vector<RingBufferNetworkObserver::Record> RingBufferNetworkObserver::getRecords() const
+	{
+		std::vector<Record> result;
+		std::lock_guard<std::mutex> lock(ringsMutex);
+
+		for (const std::shared_ptr<Ring>& ring : rings)
+		{
+			uint64_t end = ring->head.load(std::memory_order_acquire);
+			uint64_t start = end > capacity ? end - capacity : 0;
+
+			for (uint64_t i = start; i < end; i++)
+			{
+				const Slot& slot = ring->slots[i & (capacity - 1)];
+				// Slot of position i is complete after its (i / capacity + 1)-th write
+				uint64_t expectedSequence = 2 * (i / capacity + 1);
+				std::array<uint64_t, recordWords> words;
+
+				if (slot.sequence.load(std::memory_order_acquire) != expectedSequence)
+				{
+					continue;
+				}
+
+				for (size_t j = 0; j < recordWords; j++)
+				{
+					words[j] = slot.words[j].load(std::memory_order_relaxed);
+				}
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				// Owner thread continues writing, records overwritten during copy are dropped
+				if (slot.sequence.load(std::memory_order_relaxed) != expectedSequence)
+				{
+					continue;
+				}
+
+				Record& record = result.emplace_back();
+
+				std::memcpy(static_cast<void*>(&record), words.data(), sizeof(record));
+			}
+		}
+
+		std::stable_sort(result.begin(), result.end(), [](const Record& first, const Record& second) { return first.event.timestamp < second.event.timestamp; });
+
+		return result;
+	}
+
+	void RingBufferNetworkObserver::dump(std::ostream& stream) const
+	{
+		for (const Record& record : this->getRecords())
+		{
+			const NetworkEvent& event = record.event;
+
+			stream << std::chrono::duration_cast<std::chrono::nanoseconds>(event.timestamp.time_since_epoch()).count() << ' '
+				<< record.thread << ' '
+				<< getNetworkOperationName(event.operation) << ' '
+				<< (record.begin ? "begin" : "end") << ' '
+				<< event.socket << ' '
+				<< event.bytes << ' '
+				<< event.errorCode << '\n';
+		}
+	}
+}
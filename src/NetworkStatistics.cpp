@@ -0,0 +1,309 @@
+#include "NetworkStatistics.h"
+
+#include <bit>
+#include <format>
+#include <algorithm>
+#include <cmath>
+
+#ifdef __LINUX__
+#include <cerrno>
+#include <sys/socket.h>
+#else
+#include <WinSock2.h>
+#endif
+
+namespace web::utility
+{
+	size_t LatencyHistogramSnapshot::getIndex(uint64_t value) noexcept
+	{
+		if (value < subBuckets)
+		{
+			return static_cast<size_t>(value);
+		}
+
+		size_t magnitude = std::bit_width(value) - 1;
+
+		if (magnitude >= maxMagnitude)
+		{
+			return bucketsCount - 1;
+		}
+
+		size_t subBucket = static_cast<size_t>(value >> (magnitude - subBucketsBits)) & (subBuckets - 1);
+
+		return (magnitude - subBucketsBits + 1) * subBuckets + subBucket;
+	}
+
+	uint64_t LatencyHistogramSnapshot::getUpperBound(size_t index) noexcept
+	{
+		if (index < subBuckets)
+		{
+			return index + 1;
+		}
+
+		size_t magnitude = index / subBuckets + subBucketsBits - 1;
+		uint64_t subBucket = index % subBuckets;
+
+		return (uint64_t(1) << magnitude) + ((subBucket + 1) << (magnitude - subBucketsBits));
+	}
+
+	uint64_t LatencyHistogramSnapshot::getValueAtPercentile(double percentile) const noexcept
+	{
+		if (!count)
+		{
+			return 0;
+		}
+
+		uint64_t target = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * count)), 1);
+		uint64_t total = 0;
+
+		for (size_t i = 0; i < bucketsCount; i++)
+		{
+			total += buckets[i];
+
+			if (total >= target)
+			{
+				return LatencyHistogramSnapshot::getUpperBound(i);
+			}
+		}
+
+		return LatencyHistogramSnapshot::getUpperBound(bucketsCount - 1);
+	}
+
+	LatencyHistogramSnapshot& LatencyHistogramSnapshot::operator += (const LatencyHistogramSnapshot& other) noexcept
+	{
+		for (size_t i = 0; i < bucketsCount; i++)
+		{
+			buckets[i] += other.buckets[i];
+		}
+
+		count += other.count;
+		sum += other.sum;
+
+		return *this;
+	}
+
+	NetworkStatisticsSnapshot& NetworkStatisticsSnapshot::operator += (const NetworkStatisticsSnapshot& other) noexcept
+	{
+		bytesSent += other.bytesSent;
+		bytesReceived += other.bytesReceived;
+		sendCalls += other.sendCalls;
+		receiveCalls += other.receiveCalls;
+		partialSends += other.partialSends;
+		timeouts += other.timeouts;
+		wouldBlock += other.wouldBlock;
+		errors += other.errors;
+		sendLatency += other.sendLatency;
+		receiveLatency += other.receiveLatency;
+
+		return *this;
+	}
+
+	std::string NetworkStatisticsSnapshot::toPrometheus(std::string_view prefix, std::string_view labels) const
+	{
+		std::string result;
+		std::string labelsWithBraces = labels.empty() ? std::string() : std::format("{{{}}}", labels);
+		std::string labelsSeparator = labels.empty() ? std::string() : std::format("{},", labels);
+
+		auto counter = [&](std::string_view name, std::string_view help, uint64_t value)
+			{
+				result += std::format("# HELP {0}_{1} {2}\n# TYPE {0}_{1} counter\n{0}_{1}{3} {4}\n", prefix, name, help, labelsWithBraces, value);
+			};
+		auto histogram = [&](std::string_view name, std::string_view help, const LatencyHistogramSnapshot& snapshot)
+			{
+				uint64_t total = 0;
+
+				result += std::format("# HELP {0}_{1} {2}\n# TYPE {0}_{1} histogram\n", prefix, name, help);
+
+				// Only power of two boundaries are exported to keep exposition small
+				for (size_t i = 0; i < LatencyHistogramSnapshot::bucketsCount; i++)
+				{
+					total += snapshot.buckets[i];
+
+					if ((i + 1) % LatencyHistogramSnapshot::subBuckets == 0)
+					{
+						result += std::format("{}_{}_bucket{{{}le=\"{:.9f}\"}} {}\n", prefix, name, labelsSeparator, LatencyHistogramSnapshot::getUpperBound(i) / 1e9, total);
+					}
+				}
+
+				result += std::format("{}_{}_bucket{{{}le=\"+Inf\"}} {}\n", prefix, name, labelsSeparator, snapshot.count);
+				result += std::format("{}_{}_sum{} {:.9f}\n", prefix, name, labelsWithBraces, snapshot.sum / 1e9);
+				result += std::format("{}_{}_count{} {}\n", prefix, name, labelsWithBraces, snapshot.count);
+			};
+
+		counter("sent_bytes_total", "Bytes sent", bytesSent);
+		counter("received_bytes_total", "Bytes received", bytesReceived);
+		counter("send_calls_total", "Send system calls", sendCalls);
+		counter("receive_calls_total", "Receive system calls", receiveCalls);
+		counter("partial_sends_total", "Send system calls that sent less than requested", partialSends);
+		counter("timeouts_total", "Send/receive calls failed by timeout", timeouts);
+		counter("would_block_total", "Non blocking send/receive calls failed with EAGAIN", wouldBlock);
+		counter("errors_total", "Other failed send/receive calls", errors);
+		histogram("send_duration_seconds", "sendBytes latency", sendLatency);
+		histogram("receive_duration_seconds", "receiveBytes latency", receiveLatency);
+
+		return result;
+	}
+
+	NetworkStatistics::LatencyHistogram::LatencyHistogram() :
+		count(0),
+		sum(0)
+	{
+		for (std::atomic<uint64_t>& bucket : buckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void NetworkStatistics::LatencyHistogram::record(uint64_t value) noexcept
+	{
+		buckets[LatencyHistogramSnapshot::getIndex(value)].fetch_add(1, std::memory_order_relaxed);
+		count.fetch_add(1, std::memory_order_relaxed);
+		sum.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	LatencyHistogramSnapshot NetworkStatistics::LatencyHistogram::getSnapshot() const noexcept
+	{
+		LatencyHistogramSnapshot result;
+
+		for (size_t i = 0; i < LatencyHistogramSnapshot::bucketsCount; i++)
+		{
+			result.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+			result.count += result.buckets[i];
+		}
+
+		result.sum = sum.load(std::memory_order_relaxed);
+
+		return result;
+	}
+
+	void NetworkStatistics::LatencyHistogram::reset() noexcept
+	{
+		for (std::atomic<uint64_t>& bucket : buckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+
+		count.store(0, std::memory_order_relaxed);
+		sum.store(0, std::memory_order_relaxed);
+	}
+
+	void NetworkStatistics::recordError(int flags) noexcept
+	{
+#ifdef __LINUX__
+		int errorCode = errno;
+
+		if (errorCode == EAGAIN || errorCode == EWOULDBLOCK)
+		{
+			// Blocking socket returns EAGAIN only when SO_SNDTIMEO/SO_RCVTIMEO expired
+			(flags & MSG_DONTWAIT ? wouldBlock : timeouts).fetch_add(1, std::memory_order_relaxed);
+		}
+		else if (errorCode == ETIMEDOUT)
+		{
+			timeouts.fetch_add(1, std::memory_order_relaxed);
+		}
+#else
+		int errorCode = WSAGetLastError();
+
+		if (errorCode == WSAEWOULDBLOCK)
+		{
+			wouldBlock.fetch_add(1, std::memory_order_relaxed);
+		}
+		else if (errorCode == WSAETIMEDOUT)
+		{
+			timeouts.fetch_add(1, std::memory_order_relaxed);
+		}
+#endif
+		else
+		{
+			errors.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	NetworkStatistics::NetworkStatistics() :
+		bytesSent(0),
+		bytesReceived(0),
+		sendCalls(0),
+		receiveCalls(0),
+		partialSends(0),
+		timeouts(0),
+		wouldBlock(0),
+		errors(0)
+	{
+
+	}
+
+	void NetworkStatistics::recordSend(int result, int requested, int flags) noexcept
+	{
+		sendCalls.fetch_add(1, std::memory_order_relaxed);
+
+		if (result < 0)
+		{
+			this->recordError(flags);
+
+			return;
+		}
+
+		bytesSent.fetch_add(static_cast<uint64_t>(result), std::memory_order_relaxed);
+
+		if (result < requested)
+		{
+			partialSends.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void NetworkStatistics::recordReceive(int result, int flags) noexcept
+	{
+		receiveCalls.fetch_add(1, std::memory_order_relaxed);
+
+		if (result < 0)
+		{
+			this->recordError(flags);
+
+			return;
+		}
+
+		bytesReceived.fetch_add(static_cast<uint64_t>(result), std::memory_order_relaxed);
+	}
+
+	void NetworkStatistics::recordSendLatency(clock::time_point start) noexcept
+	{
+		sendLatency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()));
+	}
+
+	void NetworkStatistics::recordReceiveLatency(clock::time_point start) noexcept
+	{
+		receiveLatency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()));
+	}
+
+	NetworkStatisticsSnapshot NetworkStatistics::getSnapshot() const noexcept
+	{
+		NetworkStatisticsSnapshot result;
+
+		result.bytesSent = bytesSent.load(std::memory_order_relaxed);
+		result.bytesReceived = bytesReceived.load(std::memory_order_relaxed);
+		result.sendCalls = sendCalls.load(std::memory_order_relaxed);
+		result.receiveCalls = receiveCalls.load(std::memory_order_relaxed);
+		result.partialSends = partialSends.load(std::memory_order_relaxed);
+		result.timeouts = timeouts.load(std::memory_order_relaxed);
+		result.wouldBlock = wouldBlock.load(std::memory_order_relaxed);
+		result.errors = errors.load(std::memory_order_relaxed);
+		result.sendLatency = sendLatency.getSnapshot();
+		result.receiveLatency = receiveLatency.getSnapshot();
+
+		return result;
+	}
+
+	void NetworkStatistics::reset() noexcept
+	{
+		bytesSent.store(0, std::memory_order_relaxed);
+		bytesReceived.store(0, std::memory_order_relaxed);
+		sendCalls.store(0, std::memory_order_relaxed);
+		receiveCalls.store(0, std::memory_order_relaxed);
+		partialSends.store(0, std::memory_order_relaxed);
+		timeouts.store(0, std::memory_order_relaxed);
+		wouldBlock.store(0, std::memory_order_relaxed);
+		errors.store(0, std::memory_order_relaxed);
+		sendLatency.reset();
+		receiveLatency.reset();
+	}
+}
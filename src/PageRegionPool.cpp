@@ -0,0 +1,472 @@
+#include "PageRegionPool.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <limits>
+#include <new>
+
+#ifdef __LINUX__
+#include <fstream>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#include <Windows.h>
+#endif
+
+#include "WebException.h"
+
+namespace buffers
+{
+	/// @brief Set when thread cache of this thread is destroyed. Trivially destructible, so it can be read by destructors that run after cache, like ones of statics after main
+	static thread_local bool threadCacheDestroyed = false;
+
+	struct PageRegionPool::ThreadCache
+	{
+		std::array<std::vector<void*>, sizeClassesCount> regions;
+
+		ThreadCache()
+		{
+			for (std::vector<void*>& cached : regions)
+			{
+				cached.reserve(threadCacheRegions);
+			}
+		}
+
+		~ThreadCache()
+		{
+			threadCacheDestroyed = true;
+
+			PageRegionPool::get().flush(*this);
+		}
+	};
+
+	PageRegionPool::ThreadCache* PageRegionPool::getThreadCache()
+	{
+		if (threadCacheDestroyed)
+		{
+			return nullptr;
+		}
+
+		thread_local ThreadCache cache;
+
+		return &cache;
+	}
+
+	/// @brief Default huge page size from /proc/meminfo
+	static size_t getSystemHugePageSize()
+	{
+#ifdef __LINUX__
+		std::ifstream meminfo("/proc/meminfo");
+		std::string key;
+
+		while (meminfo >> key)
+		{
+			if (key == "Hugepagesize:")
+			{
+				size_t kilobytes = 0;
+
+				meminfo >> kilobytes;
+
+				return kilobytes * 1024;
+			}
+
+			meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+		}
+
+		return 0;
+#else
+		return GetLargePageMinimum();
+#endif
+	}
+
+	void* PageRegionPool::mapHugePages(size_t size) noexcept
+	{
+#ifdef __LINUX__
+		bool prefault = this->prefault.load(std::memory_order_relaxed);
+		void* region = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (prefault ? MAP_POPULATE : 0), -1, 0);
+
+		if (region != MAP_FAILED)
+		{
+			hugePageRegions.fetch_add(1, std::memory_order_relaxed);
+
+			return region;
+		}
+
+		// No reserved huge pages, map bigger region and trim it to huge page alignment, so transparent huge pages can back it
+		char* start = static_cast<char*>(mmap(NULL, size + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+
+		if (start == MAP_FAILED)
+		{
+			return nullptr;
+		}
+
+		char* aligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(start) + hugePageSize - 1) & ~(hugePageSize - 1));
+
+		if (aligned != start)
+		{
+			munmap(start, aligned - start);
+		}
+
+		munmap(aligned + size, start + hugePageSize - aligned);
+
+		if (!madvise(aligned, size, MADV_HUGEPAGE))
+		{
+			hugePageRegions.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		if (prefault)
+		{
+#ifdef MADV_POPULATE_WRITE
+			if (!madvise(aligned, size, MADV_POPULATE_WRITE))
+			{
+				return aligned;
+			}
+#endif
+
+			for (size_t offset = 0; offset < size; offset += pageSize)
+			{
+				aligned[offset] = 0;
+			}
+		}
+
+		return aligned;
+#else
+		// Large pages are always committed, so they don't need prefault
+		void* region = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+
+		if (region)
+		{
+			hugePageRegions.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		return region;
+#endif
+	}
+
+	void* PageRegionPool::map(size_t size)
+	{
+		if (size_t threshold = hugePageThreshold.load(std::memory_order_relaxed); hugePageSize && threshold && size >= threshold && !(size % hugePageSize))
+		{
+			if (void* region = this->mapHugePages(size))
+			{
+				return region;
+			}
+		}
+
+#ifdef __LINUX__
+		void* region = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (region == MAP_FAILED)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+#else
+		void* region = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+		if (!region)
+		{
+			THROW_WEB_EXCEPTION;
+		}
+#endif
+
+		return region;
+	}
+
+	void PageRegionPool::unmap(void* region, size_t size) noexcept
+	{
+#ifdef __LINUX__
+		munmap(region, size);
+#else
+		VirtualFree(region, 0, MEM_RELEASE);
+#endif
+	}
+
+	size_t PageRegionPool::getSizeClass(size_t size) const noexcept
+	{
+		size_t pages = size / pageSize;
+
+		if (size % pageSize || !std::has_single_bit(pages))
+		{
+			return sizeClassesCount;
+		}
+
+		return std::min(static_cast<size_t>(std::countr_zero(pages)), sizeClassesCount);
+	}
+
+	/// @brief Add size to counter if result doesn't exceed limit
+	static bool reserve(std::atomic<uint64_t>& counter, size_t size, size_t limit) noexcept
+	{
+		uint64_t current = counter.load(std::memory_order_relaxed);
+
+		do
+		{
+			if (current + size > limit)
+			{
+				return false;
+			}
+		} while (!counter.compare_exchange_weak(current, current + size, std::memory_order_relaxed));
+
+		return true;
+	}
+
+	void PageRegionPool::flush(ThreadCache& cache) noexcept
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		for (size_t sizeClass = 0; sizeClass < sizeClassesCount; sizeClass++)
+		{
+			size_t size = pageSize << sizeClass;
+
+			for (void* region : cache.regions[sizeClass])
+			{
+				try
+				{
+					regions[sizeClass].push_back(region);
+				}
+				catch (const std::bad_alloc&)
+				{
+					retainedBytes.fetch_sub(size, std::memory_order_relaxed);
+
+					PageRegionPool::unmap(region, size);
+				}
+			}
+
+			cache.regions[sizeClass].clear();
+		}
+	}
+
+	PageRegionPool::PageRegionPool() :
+		hugePageSize(getSystemHugePageSize()),
+		maxRetainedBytes(defaultMaxRetainedBytes),
+		maxUsedBytes((std::numeric_limits<size_t>::max)()),
+		hugePageThreshold(defaultHugePageThreshold),
+		prefault(false),
+		hits(0),
+		misses(0),
+		retainedBytes(0),
+		hugePageRegions(0),
+		usedBytes(0)
+	{
+#ifdef __LINUX__
+		pageSize = sysconf(_SC_PAGESIZE);
+#else
+		SYSTEM_INFO sysInfo;
+
+		GetSystemInfo(&sysInfo);
+
+		pageSize = sysInfo.dwPageSize;
+#endif
+	}
+
+	PageRegionPool& PageRegionPool::get()
+	{
+		// Never destroyed and falls back to shared pool after thread cache is destroyed, so buffers of static objects can be returned after main
+		static PageRegionPool* instance = new PageRegionPool();
+
+		return *instance;
+	}
+
+	size_t PageRegionPool::getRegionSize(size_t size) const noexcept
+	{
+		if (size_t threshold = hugePageThreshold.load(std::memory_order_relaxed); hugePageSize && threshold && size >= threshold)
+		{
+			return (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+		}
+
+		size_t pages = std::max<size_t>((size + pageSize - 1) / pageSize, 1);
+
+		if (pages <= (static_cast<size_t>(1) << (sizeClassesCount - 1)))
+		{
+			pages = std::bit_ceil(pages);
+		}
+
+		return pages * pageSize;
+	}
+
+	void* PageRegionPool::allocate(size_t size)
+	{
+		if (!reserve(usedBytes, size, maxUsedBytes.load(std::memory_order_relaxed)))
+		{
+			throw web::exceptions::WebException(ENOBUFS, "Receive buffers memory budget exceeded", __LINE__, __FILE__);
+		}
+
+		if (size_t sizeClass = this->getSizeClass(size); sizeClass != sizeClassesCount)
+		{
+			ThreadCache* cache = PageRegionPool::getThreadCache();
+			void* region = nullptr;
+
+			if (cache && cache->regions[sizeClass].size())
+			{
+				region = cache->regions[sizeClass].back();
+
+				cache->regions[sizeClass].pop_back();
+			}
+			else
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+
+				if (regions[sizeClass].size())
+				{
+					region = regions[sizeClass].back();
+
+					regions[sizeClass].pop_back();
+				}
+			}
+
+			if (region)
+			{
+				retainedBytes.fetch_sub(size, std::memory_order_relaxed);
+				hits.fetch_add(1, std::memory_order_relaxed);
+
+				return region;
+			}
+		}
+
+		void* region = nullptr;
+
+		try
+		{
+			region = this->map(size);
+		}
+		catch (const web::exceptions::WebException&)
+		{
+			usedBytes.fetch_sub(size, std::memory_order_relaxed);
+
+			throw;
+		}
+
+		misses.fetch_add(1, std::memory_order_relaxed);
+
+		return region;
+	}
+
+	void PageRegionPool::deallocate(void* region, size_t size) noexcept
+	{
+		size_t sizeClass = this->getSizeClass(size);
+
+		usedBytes.fetch_sub(size, std::memory_order_relaxed);
+
+		if (sizeClass == sizeClassesCount || !reserve(retainedBytes, size, maxRetainedBytes.load(std::memory_order_relaxed)))
+		{
+			PageRegionPool::unmap(region, size);
+
+			return;
+		}
+
+		// Without thread cache(thread is exiting) region goes to shared pool
+		if (ThreadCache* cache = PageRegionPool::getThreadCache(); cache && cache->regions[sizeClass].size() < threadCacheRegions)
+		{
+			cache->regions[sizeClass].push_back(region);
+
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		try
+		{
+			regions[sizeClass].push_back(region);
+		}
+		catch (const std::bad_alloc&)
+		{
+			retainedBytes.fetch_sub(size, std::memory_order_relaxed);
+
+			PageRegionPool::unmap(region, size);
+		}
+	}
+
+	void PageRegionPool::setMaxRetainedBytes(size_t maxRetainedBytes) noexcept
+	{
+		this->maxRetainedBytes.store(maxRetainedBytes, std::memory_order_relaxed);
+
+		if (retainedBytes.load(std::memory_order_relaxed) > maxRetainedBytes)
+		{
+			this->trim();
+		}
+	}
+
+	void PageRegionPool::setMaxUsedBytes(size_t maxUsedBytes) noexcept
+	{
+		this->maxUsedBytes.store(maxUsedBytes, std::memory_order_relaxed);
+	}
+
+	void PageRegionPool::setHugePageThreshold(size_t hugePageThreshold) noexcept
+	{
+		this->hugePageThreshold.store(hugePageThreshold, std::memory_order_relaxed);
+	}
+
+	void PageRegionPool::setPrefault(bool prefault) noexcept
+	{
+		this->prefault.store(prefault, std::memory_order_relaxed);
+	}
+
+	void PageRegionPool::trim() noexcept
+	{
+		if (ThreadCache* cache = PageRegionPool::getThreadCache())
+		{
+			this->flush(*cache);
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		for (size_t sizeClass = 0; sizeClass < sizeClassesCount; sizeClass++)
+		{
+			size_t size = pageSize << sizeClass;
+
+			for (void* region : regions[sizeClass])
+			{
+				PageRegionPool::unmap(region, size);
+			}
+
+			retainedBytes.fetch_sub(regions[sizeClass].size() * size, std::memory_order_relaxed);
+
+			regions[sizeClass].clear();
+		}
+	}
+
+	size_t PageRegionPool::getPageSize() const noexcept
+	{
+		return pageSize;
+	}
+
+	size_t PageRegionPool::getHugePageSize() const noexcept
+	{
+		return hugePageSize;
+	}
+
+	size_t PageRegionPool::getMaxRetainedBytes() const noexcept
+	{
+		return maxRetainedBytes.load(std::memory_order_relaxed);
+	}
+
+	size_t PageRegionPool::getMaxUsedBytes() const noexcept
+	{
+		return maxUsedBytes.load(std::memory_order_relaxed);
+	}
+
+	size_t PageRegionPool::getHugePageThreshold() const noexcept
+	{
+		return hugePageThreshold.load(std::memory_order_relaxed);
+	}
+
+	bool PageRegionPool::getPrefault() const noexcept
+	{
+		return prefault.load(std::memory_order_relaxed);
+	}
+
+	PageRegionPool::Statistics PageRegionPool::getStatistics() const noexcept
+	{
+		Statistics result;
+
+		result.hits = hits.load(std::memory_order_relaxed);
+		result.misses = misses.load(std::memory_order_relaxed);
+		result.retainedBytes = retainedBytes.load(std::memory_order_relaxed);
+		result.hugePageRegions = hugePageRegions.load(std::memory_order_relaxed);
+		result.usedBytes = usedBytes.load(std::memory_order_relaxed);
+
+		return result;
+	}
+}
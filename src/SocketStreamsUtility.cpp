@@ -4,7 +4,7 @@ namespace web::utility
 {
 	std::string getSocketStreamsVersion()
 	{
-		std::string version = "1.12.2";
+		std::string version = "2.0.0";
 
 		return version;
 	}
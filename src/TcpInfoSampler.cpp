@@ -0,0 +1,149 @@
+#include "TcpInfoSampler.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace web::utility
+{
+	void TcpInfoSampler::run()
+	{
+		std::unique_lock<std::mutex> lock(stopMutex);
+
+		while (!stopCondition.wait_for(lock, period, [this]() { return stopped; }))
+		{
+			lock.unlock();
+
+			std::vector<TcpInfo> connections;
+			TcpInfoAggregate aggregate = this->sample(&connections);
+
+			if (callback)
+			{
+				callback(aggregate, connections);
+			}
+
+			lock.lock();
+		}
+	}
+
+	TcpInfoSampler::TcpInfoSampler(std::chrono::milliseconds period, const Callback& callback) :
+		callback(callback),
+		period(period),
+		stopped(false)
+	{
+		if (period.count() > 0)
+		{
+			worker = std::thread(&TcpInfoSampler::run, this);
+		}
+	}
+
+	void TcpInfoSampler::add(const Network& network)
+	{
+		std::lock_guard<std::mutex> lock(handlesMutex);
+
+		handles.push_back(network.handle);
+	}
+
+	size_t TcpInfoSampler::size()
+	{
+		std::lock_guard<std::mutex> lock(handlesMutex);
+
+		std::erase_if(handles, [](const std::weak_ptr<SOCKET>& handle) { return handle.expired(); });
+
+		return handles.size();
+	}
+
+	TcpInfoAggregate TcpInfoSampler::sample(std::vector<TcpInfo>* connections)
+	{
+		std::vector<TcpInfo> samples;
+		TcpInfoAggregate result = {};
+
+		{
+			std::lock_guard<std::mutex> lock(handlesMutex);
+
+			std::erase_if(handles, [](const std::weak_ptr<SOCKET>& handle) { return handle.expired(); });
+
+			samples.reserve(handles.size());
+
+			for (const std::weak_ptr<SOCKET>& weakHandle : handles)
+			{
+				// Locked handle keeps socket open until getsockopt returns
+				if (std::shared_ptr<SOCKET> handle = weakHandle.lock())
+				{
+					try
+					{
+						samples.push_back(Network::getTcpInfo(*handle));
+					}
+					catch (const exceptions::WebException&)
+					{
+						// Not TCP socket or connection already reset
+					}
+				}
+			}
+		}
+
+		result.connections = samples.size();
+
+		if (samples.size())
+		{
+			std::vector<std::chrono::microseconds> rtts;
+
+			rtts.reserve(samples.size());
+
+			result.congestionWindowMin = (std::numeric_limits<uint32_t>::max)();
+			result.deliveryRateMin = (std::numeric_limits<uint64_t>::max)();
+
+			for (const TcpInfo& info : samples)
+			{
+				rtts.push_back(info.rtt);
+
+				result.rttVarianceMax = (std::max)(result.rttVarianceMax, info.rttVariance);
+				result.congestionWindowMin = (std::min)(result.congestionWindowMin, info.congestionWindow);
+				result.congestionWindowMean += info.congestionWindow;
+				result.unacked += info.unacked;
+				result.lost += info.lost;
+				result.totalRetransmits += info.totalRetransmits;
+				result.deliveryRateMin = (std::min)(result.deliveryRateMin, info.deliveryRate);
+				result.deliveryRateMean += static_cast<double>(info.deliveryRate);
+				result.busyTime += info.busyTime;
+				result.receiveWindowLimited += info.receiveWindowLimited;
+				result.sendBufferLimited += info.sendBufferLimited;
+			}
+
+			std::sort(rtts.begin(), rtts.end());
+
+			result.rttP50 = rtts[(rtts.size() - 1) * 50 / 100];
+			result.rttP99 = rtts[(rtts.size() - 1) * 99 / 100];
+			result.rttMax = rtts.back();
+			result.congestionWindowMean /= samples.size();
+			result.deliveryRateMean /= samples.size();
+		}
+
+		if (connections)
+		{
+			*connections = std::move(samples);
+		}
+
+		return result;
+	}
+
+	void TcpInfoSampler::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(stopMutex);
+
+			stopped = true;
+		}
+
+		stopCondition.notify_all();
+
+		if (worker.joinable())
+		{
+			worker.join();
+		}
+	}
+
+	TcpInfoSampler::~TcpInfoSampler()
+	{
+		this->stop();
+	}
+}
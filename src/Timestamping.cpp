@@ -0,0 +1,14 @@
+#include "Timestamping.h"
+
+namespace web::utility
+{
+	std::chrono::nanoseconds ReceiveTimestamps::getQueueingDelay() const
+	{
+		if (!kernel)
+		{
+			return std::chrono::nanoseconds(0);
+		}
+
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(user - *kernel);
+	}
+}
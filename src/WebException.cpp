@@ -297,6 +297,15 @@ namespace web::exceptions
 		data = format("Error code '{}' with description '{}' in file '{}' on line '{}'", errorCode, data, file, line);
 	}
 
+	WebException::WebException(int errorCode, std::string_view description, int line, std::string_view file) :
+		runtime_error(""),
+		file(file),
+		errorCode(errorCode),
+		line(line)
+	{
+		data = format("Error code '{}' with description '{}' in file '{}' on line '{}'", errorCode, description, file, line);
+	}
+
 	const char* WebException::what() const noexcept
 	{
 		return data.data();